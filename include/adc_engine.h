@@ -0,0 +1,40 @@
+#ifndef ADC_ENGINE_H
+#define ADC_ENGINE_H
+
+#include "hal.h"
+
+// Interrupt-driven ADC engine.
+// The conversion-complete ISR cycles through the analog channels used by the
+// power monitor and soil sensor, accumulating ADC_OVERSAMPLE conversions per
+// channel before moving on. Readers only pick up finished sums, so no
+// foreground code waits on the ADC.
+//
+// Once initAdcEngine() has run, analogRead() must not be used: it would
+// change the multiplexer under the ISR.
+//
+// The engine can be stopped between sample windows (see power_manager.h);
+// adcReadSum() then keeps returning the blocks finished before the stop.
+
+#define ADC_OVERSAMPLE_SHIFT 6
+#define ADC_OVERSAMPLE (1 << ADC_OVERSAMPLE_SHIFT)  // 64 x 10-bit sums still fit in a uint16_t
+
+// Channels sampled in the background (A0, A1, A2, A6, A7)
+#define ADC_ENGINE_CHANNELS 5
+
+// One pass over every channel: (ADC_OVERSAMPLE + 1) conversions of 13 ADC
+// clocks at 125 kHz per channel, ~33.8 ms, rounded up
+#define ADC_ENGINE_CYCLE_MS 35
+
+void initAdcEngine();
+
+// Stop converting (no more ADC interrupts), or start again from the first
+// channel. A full set of fresh sums is ready ADC_ENGINE_CYCLE_MS after a start.
+void stopAdcEngine();
+void startAdcEngine();
+bool isAdcEngineRunning();
+
+// Sum of the last completed block of ADC_OVERSAMPLE conversions for an
+// analog pin (0..65472). Returns 0 until the first block is done.
+uint16_t adcReadSum(uint8_t pin);
+
+#endif // ADC_ENGINE_H
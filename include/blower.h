@@ -1,10 +1,26 @@
 #ifndef BLOWER_H
 #define BLOWER_H
 
-#include "Arduino.h"
+#include "hal.h"
 // กำหนดขา PWM สำหรับควบคุมทิศทางของ Blower
-#define RPWM 5 // ขา PWM สำหรับหมุนปกติ
-#define LPWM 6 // ขา PWM สำหรับหมุนย้อนกลับ
+#define RPWM 5 // ขา PWM สำหรับหมุนปกติ (OC3A, Timer3)
+#define LPWM 6 // ขา PWM สำหรับหมุนย้อนกลับ (OC4A, Timer4)
+
+// Ramp engine: a Timer5 compare interrupt moves the output towards the
+// target speed by the ramp rate every tick. Direction changes ramp down
+// through zero and hold off for BLOWER_REVERSE_DWELL_MS before ramping up
+// the other way. Timer5 runs in CTC mode without driving its pins, so DHT
+// pin 46 (OC5A) is unaffected.
+#define BLOWER_RAMP_TICK_HZ 100
+#define BLOWER_RAMP_DEFAULT_RATE 100    // Speed units (0-255) per second; 0 = no ramp
+#define BLOWER_REVERSE_DWELL_MS 150
+
+// PWM frequency of Timer3/Timer4 (fast PWM, TOP = ICRn). Timer4 also drives
+// pin 8 (feeder motor RPWM); the feeder motor only switches fully on/off,
+// so it is not affected by the frequency.
+#define BLOWER_PWM_DEFAULT_HZ 20000UL
+#define BLOWER_PWM_MIN_HZ 100UL
+#define BLOWER_PWM_MAX_HZ 25000UL
 
 void initBlower();
 void startBlower();
@@ -13,4 +29,13 @@ void setBlowerSpeed(int speed);
 void setBlowerDirection(bool reverse);
 void updateBlower();
 
+// Ramp slope in speed units per second (0 jumps straight to the target)
+void setBlowerRampRate(uint16_t unitsPerSecond);
+uint16_t getBlowerRampRate();
+// Returns the frequency actually set, or 0 if hz is out of range
+uint32_t setBlowerPwmFrequency(uint32_t hz);
+uint32_t getBlowerPwmFrequency();
+// Present output: -255 (full reverse) .. 255 (full forward)
+int getBlowerOutput();
+
 #endif
@@ -0,0 +1,62 @@
+#ifndef COMMAND_PARSER_H
+#define COMMAND_PARSER_H
+
+#include "hal.h"
+
+// Zero-allocation command parsing.
+// Lines are assembled into a fixed buffer, tokenized in place on ':' and
+// dispatched through a PROGMEM table keyed by device and verb:
+//   [control]:<device>:<verb>[:<args>]
+
+#define COMMAND_PREFIX "[control]:"
+#define COMMAND_PREFIX_LEN 10
+#define COMMAND_LINE_SIZE 64
+
+// Handler receives the text after "<device>:<verb>:" ("" when absent).
+// The buffer is writable so handlers can tokenize it further.
+typedef void (*CommandHandler)(char* args);
+
+// Table entry; device and verb point to PROGMEM strings
+struct CommandEntry {
+    const char* device;
+    const char* verb;
+    CommandHandler handler;
+    bool urgent;       // Stop/emergency commands, queued ahead of the rest
+};
+
+enum CommandResult {
+    COMMAND_OK,
+    COMMAND_IGNORED,          // Not a [control]: line
+    COMMAND_UNKNOWN_DEVICE,
+    COMMAND_UNKNOWN_VERB
+};
+
+struct CommandLineBuffer {
+    char data[COMMAND_LINE_SIZE];
+    uint8_t length;
+    bool overflow;
+};
+
+void commandLineReset(CommandLineBuffer& line);
+// Feed one received byte. Returns true when a complete, trimmed line is in
+// line.data; the caller must reset the buffer after handling it.
+bool commandLineFeed(CommandLineBuffer& line, char c);
+
+// Split off the next ':'-separated token in place; advances cursor.
+// Returns NULL when no tokens are left.
+char* commandNextToken(char*& cursor);
+
+// Strict integer parsing (whole token must be a number)
+bool commandParseLong(const char* text, long& value);
+// Parse up to maxValues comma-separated integers; returns how many were read,
+// or -1 if any of them is malformed
+int8_t commandParseLongList(char* text, long* values, uint8_t maxValues);
+
+CommandResult dispatchCommand(char* line, const CommandEntry* table, uint8_t tableSize,
+                              char*& device);
+
+// Index of the table entry a line would dispatch to, without modifying the
+// line; -1 if it is not a known command
+int8_t findCommand(const char* line, const CommandEntry* table, uint8_t tableSize);
+
+#endif // COMMAND_PARSER_H
@@ -0,0 +1,47 @@
+#ifndef COMMAND_QUEUE_H
+#define COMMAND_QUEUE_H
+
+#include "hal.h"
+#include "ring_buffer.h"
+#include "command_parser.h"
+
+// Queue of complete command lines between the serial RX stage and the
+// command task. Urgent lines (stop commands) have their own ring and are
+// always taken first. A full ring rejects the line; nothing is dropped
+// without being counted.
+
+#define COMMAND_QUEUE_URGENT_DEPTH 2
+#define COMMAND_QUEUE_NORMAL_DEPTH 4
+
+enum CommandPriority {
+    COMMAND_PRIORITY_NORMAL,
+    COMMAND_PRIORITY_URGENT
+};
+
+struct QueuedCommand {
+    char line[COMMAND_LINE_SIZE];
+};
+
+struct CommandQueueStats {
+    uint32_t queued;
+    uint32_t executed;
+    uint32_t rejected;      // Queue full
+    uint8_t maxDepth;       // High-water mark of both rings together
+};
+
+struct CommandQueue {
+    RingBuffer<QueuedCommand, COMMAND_QUEUE_URGENT_DEPTH> urgent;
+    RingBuffer<QueuedCommand, COMMAND_QUEUE_NORMAL_DEPTH> normal;
+    CommandQueueStats stats;
+};
+
+void commandQueueReset(CommandQueue& queue);
+// Copy a line into the queue; returns false (and counts it) when its ring is full
+bool commandQueuePush(CommandQueue& queue, const char* line, CommandPriority priority);
+// Take the next line, urgent first; returns false when empty. With
+// urgentOnly normal lines stay queued.
+bool commandQueuePop(CommandQueue& queue, QueuedCommand& command, bool urgentOnly = false);
+uint8_t commandQueueDepth(const CommandQueue& queue);
+uint8_t commandQueueCapacity();
+
+#endif // COMMAND_QUEUE_H
@@ -0,0 +1,73 @@
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include "hal.h"
+
+// Persistent configuration as an append-only journal in EEPROM.
+// Every change is written as a new 12-byte record at the head of a ring that
+// spans the whole EEPROM, so writes are spread over all cells instead of
+// hitting one address:
+//   version(1) | key(1) | seq(4) | value(4) | crc16(2)
+// seq increases with every record written; at boot one pass over the ring
+// finds the newest valid record of each key and the head. A record whose CRC
+// does not match (power lost mid-write) is ignored, so the previous value of
+// that key survives. The newest record of a key is never overwritten: the
+// head skips over it, which keeps every live key in the ring without a
+// separate compaction step.
+
+#define CONFIG_RECORD_VERSION 0xA1   // Never 0x00/0xFF, so erased cells never match
+#define CONFIG_RECORD_SIZE    12
+#define CONFIG_EEPROM_SIZE    ((uint16_t)E2END + 1)
+#define CONFIG_SLOT_COUNT     (CONFIG_EEPROM_SIZE / CONFIG_RECORD_SIZE)
+#define CONFIG_SLOT_NONE      0xFFFF
+
+// Stored keys; values are 32 bits (floats are stored by bit pattern).
+// Keys are part of the on-EEPROM format: append new ones, never renumber.
+enum ConfigKey {
+    CONFIG_KEY_TARE_OFFSET = 0,    // HX711 offset in raw counts
+    CONFIG_KEY_SCALE_FACTOR,       // HX711 counts per kg (float)
+    CONFIG_KEY_SENSOR_INTERVAL,    // Telemetry interval in ms
+    CONFIG_KEY_WEIGHT_TOLERANCE,   // Feeder tolerance in g (float)
+    CONFIG_KEY_BLOWER_SPEED,       // PWM duty 0-255
+    CONFIG_KEY_BLOWER_RAMP_RATE,   // Speed units per second
+    CONFIG_KEY_BLOWER_PWM_HZ,      // Blower PWM frequency
+    CONFIG_KEY_DOSING_A,           // Dosing model (float each, see dosing_model.h)
+    CONFIG_KEY_DOSING_B,
+    CONFIG_KEY_DOSING_P00,
+    CONFIG_KEY_DOSING_P01,
+    CONFIG_KEY_DOSING_P11,
+    CONFIG_KEY_DOSING_FEEDS,
+    CONFIG_KEY_TIME_ZONE,          // Minutes east of UTC for the feeding schedule
+    CONFIG_KEY_SCHEDULE_FIRST,     // Two words per schedule entry (feed_schedule.h)
+    CONFIG_KEY_SCHEDULE_LAST = CONFIG_KEY_SCHEDULE_FIRST + 15,
+    CONFIG_KEY_POWER_FLAGS,        // Bit 0 idle sleep, bit 1 sensor power gating
+    CONFIG_KEY_BATTERY_THRESHOLDS, // Low % | critical % << 8
+    CONFIG_KEY_FEED_CUTOFF_LEAD,   // Predictive cut-off lead time in ms (float)
+    CONFIG_KEY_COUNT
+};
+
+struct ConfigStoreStats {
+    uint16_t validRecords;   // Valid records found by the boot scan
+    uint16_t badRecords;     // Records with a version byte but a bad CRC
+    uint16_t head;           // Slot the next record goes to
+    uint32_t seq;            // seq of the newest record
+    uint32_t writes;         // Records written since boot
+};
+
+// Scan the EEPROM and load the newest value of every key. On a blank
+// journal the legacy tare offset (a long at address 0) is migrated.
+void initConfigStore();
+
+// Return false when the key has never been stored
+bool configGet(uint8_t key, uint32_t& value);
+bool configGetLong(uint8_t key, long& value);
+bool configGetFloat(uint8_t key, float& value);
+
+// Append a record; nothing is written if the stored value is unchanged
+bool configSet(uint8_t key, uint32_t value);
+bool configSetLong(uint8_t key, long value);
+bool configSetFloat(uint8_t key, float value);
+
+const ConfigStoreStats& getConfigStoreStats();
+
+#endif // CONFIG_STORE_H
@@ -1,9 +1,10 @@
 #ifndef DHT_SENSOR_H
 #define DHT_SENSOR_H
 
-#include <Arduino.h>
+#include "hal.h"
+#ifndef NATIVE_BUILD
 #include <DHT.h>
-#include <ArduinoJson.h>
+#endif
 
 // Pin definitions
 #define DHTPIN1 48  // System DHT22
@@ -14,9 +15,83 @@
 #define DHT22_SYSTEM "DHT22_SYSTEM"
 #define DHT22_FEEDER "DHT22_FEEDER"
 
+// Indices into the DHT driver
+#define DHT_INDEX_SYSTEM 0
+#define DHT_INDEX_FEEDER 1
+#define DHT_SENSOR_COUNT 2
+
+// A DHT22 must not be read more often than every 2 seconds
+#define DHT_MIN_READ_INTERVAL 2000
+// Cached values older than this are not reported: five failed conversions
+// in a row, or a sensor that has stopped answering
+#define DHT_STALE_MS 10000
+
+struct DhtCachedReading {
+  float temperature;
+  float humidity;
+  unsigned long timestamp;  // millis() of the last good conversion
+  bool valid;               // false until the first good conversion
+};
+
+// Driver for N DHT sensors. update() performs at most one conversion per
+// call and spaces conversions DHT_MIN_READ_INTERVAL / N apart, so the
+// ~5 ms interrupt-masked bit-bang never happens for two sensors back to back.
+// Readers get the cached last good value instantly.
+template <uint8_t N>
+class DhtDriver {
+public:
+  explicit DhtDriver(DHT* sensors) : sensors(sensors), nextSensor(0), lastConversion(0) {
+    for (uint8_t i = 0; i < N; i++) {
+      cache[i].temperature = 0;
+      cache[i].humidity = 0;
+      cache[i].timestamp = 0;
+      cache[i].valid = false;
+    }
+  }
+
+  void begin() {
+    for (uint8_t i = 0; i < N; i++) {
+      sensors[i].begin();
+    }
+    lastConversion = millis();
+  }
+
+  void update() {
+    unsigned long now = millis();
+    if (now - lastConversion < DHT_MIN_READ_INTERVAL / N) return;
+    lastConversion = now;
+
+    uint8_t index = nextSensor;
+    nextSensor = (nextSensor + 1) % N;
+
+    // One forced conversion; the getters below return the library's cached data
+    if (!sensors[index].read(true)) return;
+    float temp = sensors[index].readTemperature();
+    float hum = sensors[index].readHumidity();
+    if (isnan(temp) || isnan(hum)) return;
+
+    cache[index].temperature = temp;
+    cache[index].humidity = hum;
+    cache[index].timestamp = now;
+    cache[index].valid = true;
+  }
+
+  const DhtCachedReading& reading(uint8_t index) const { return cache[index]; }
+
+  // Milliseconds since the last good conversion
+  unsigned long age(uint8_t index) const { return millis() - cache[index].timestamp; }
+
+private:
+  DHT* sensors;
+  DhtCachedReading cache[N];
+  uint8_t nextSensor;
+  unsigned long lastConversion;
+};
+
 // Function declarations
 void initDHT();
-StaticJsonDocument<256> readDHTSystem();
-StaticJsonDocument<256> readDHTFeeder();
+void updateDHT();
+const DhtCachedReading& getDHTReading(uint8_t index);
+unsigned long getDHTReadingAge(uint8_t index);
 
-#endif // DHT_SENSOR_H 
\ No newline at end of file
+#endif // DHT_SENSOR_H
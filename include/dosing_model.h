@@ -0,0 +1,33 @@
+#ifndef DOSING_MODEL_H
+#define DOSING_MODEL_H
+
+#include "hal.h"
+
+// Learned dosing characteristic of the feeder gate: average flow while the
+// gate is open, as a linear function of the hopper fill level
+//   flow [g/s] = a + b * hopperKg
+// fitted by recursive least squares over past feeds. The forgetting factor
+// lets the model follow slow changes (feed type, humidity, wear).
+
+#define DOSING_FORGETTING 0.95f     // Weight of older feeds per new feed
+#define DOSING_INITIAL_P 1000.0f    // Initial covariance (uninformed model)
+#define DOSING_MIN_FEEDS 3          // Feeds before the model is used to plan
+#define DOSING_MIN_FLOW 0.5f        // g/s; lower predictions are not trusted
+
+struct DosingModel {
+    float a;               // g/s at an empty hopper
+    float b;               // g/s per kg in the hopper
+    float p00, p01, p11;   // Symmetric RLS covariance
+    uint16_t feeds;        // Feeds learned from
+};
+
+void dosingReset(DosingModel& model);
+// Learn from one completed feed
+void dosingUpdate(DosingModel& model, float hopperKg, float gramsPerSecond);
+// Predicted flow; false until the model is trained or if it is implausible
+bool dosingPredictFlow(const DosingModel& model, float hopperKg, float& gramsPerSecond);
+// Gate-open time to dispense grams at this hopper level, at most maxMs;
+// 0 while there is no usable prediction
+unsigned long dosingPlanOpenMs(const DosingModel& model, float hopperKg, float grams, unsigned long maxMs);
+
+#endif // DOSING_MODEL_H
@@ -0,0 +1,65 @@
+#ifndef FEED_SCHEDULE_H
+#define FEED_SCHEDULE_H
+
+#include "hal.h"
+#include "config_store.h"
+
+// On-device feeding schedule.
+// A fixed table of entries, each either a daily time of day (local time,
+// needs a host clock sync) or an interval counted from millis() (runs
+// without a sync). Entries are stored in the config store as two 32-bit
+// words each:
+//   word 0: kind(8) | enabled(8) | minutes(16)
+//   word 1: amount g(16) | blower s(8) | tolerance g(8)
+// Wall time is millis() plus the epoch offset set by the last sync.
+
+#define SCHEDULE_MAX_ENTRIES 8
+#define SCHEDULE_CATCHUP_MIN 10        // A daily feed delayed longer than this is skipped
+#define SCHEDULE_MINUTES_PER_DAY 1440
+
+static_assert(CONFIG_KEY_SCHEDULE_LAST - CONFIG_KEY_SCHEDULE_FIRST + 1 == 2 * SCHEDULE_MAX_ENTRIES,
+              "Config store must reserve two words per schedule entry");
+
+enum ScheduleKind {
+    SCHEDULE_UNUSED = 0,
+    SCHEDULE_DAILY,       // minutes = minute of the day (0-1439)
+    SCHEDULE_INTERVAL     // minutes = period
+};
+
+struct ScheduleEntry {
+    uint8_t kind;
+    bool enabled;
+    uint16_t minutes;
+    uint16_t amountG;
+    uint8_t blowerS;
+    uint8_t toleranceG;
+};
+
+struct ScheduleStats {
+    uint16_t fired;
+    uint16_t missed;      // Daily feeds skipped after SCHEDULE_CATCHUP_MIN
+};
+
+// Load the table and time zone from the config store
+void initSchedule();
+
+// Validate, store and persist an entry; false if the entry is invalid
+bool scheduleSet(uint8_t index, const ScheduleEntry& entry);
+bool scheduleGet(uint8_t index, ScheduleEntry& entry);
+bool scheduleSetEnabled(uint8_t index, bool enabled);
+bool scheduleClear(uint8_t index);
+
+// Host clock sync: UTC seconds and the local offset in minutes (persisted).
+// Daily entries already past today are not run again after a sync.
+void scheduleSyncClock(uint32_t epochSeconds, int16_t tzMinutes);
+bool scheduleClockValid();
+uint32_t scheduleEpochNow();
+int16_t scheduleTzMinutes();
+
+// Index of an entry that is due now, -1 if none. The caller starts the feed
+// and then calls scheduleMarkFired(); a due entry stays due until then.
+int8_t scheduleDueEntry();
+void scheduleMarkFired(uint8_t index);
+const ScheduleStats& getScheduleStats();
+
+#endif // FEED_SCHEDULE_H
@@ -1,17 +1,36 @@
 #ifndef FEEDER_MOTOR_H
 #define FEEDER_MOTOR_H
 
-#include <Arduino.h>
+#include "hal.h"
 
 // Pin definitions for Feeder Motor
 // Dual-PWM pins similar to blower control
 #define FM_RPWM 8  // PWM pin for CW direction
 #define FM_LPWM 9  // PWM pin for CCW direction
 
+// Gate moves are timed pulses run by updateFeederMotor(); requests return
+// immediately. Reversing waits for the dead time after the last pulse in
+// the other direction. A request replaces any pulse in progress or pending.
+#define FEEDER_MOTOR_PULSE_MS 300           // Default pulse length
+#define FEEDER_MOTOR_MAX_PULSE_MS 5000
+#define FEEDER_MOTOR_REVERSE_DELAY_MS 150   // Dead time before reversing
+
+enum FeederMotorState {
+    FEEDER_MOTOR_IDLE,
+    FEEDER_MOTOR_DEAD_TIME,   // Reversal requested, waiting for the dead time
+    FEEDER_MOTOR_PULSE        // Driving until the pulse deadline
+};
+
 void initFeederMotor();
-void feederMotorOpen();
-void feederMotorClose();
+// Open: CW pulse, close: CCW pulse. Each pulse end is reported as
+// "[EVENT] - feedermotor:<open|close>:done:<ms>".
+void feederMotorOpen(uint16_t pulseMs = FEEDER_MOTOR_PULSE_MS);
+void feederMotorClose(uint16_t pulseMs = FEEDER_MOTOR_PULSE_MS);
+// Stop at once and drop any pending pulse
 void feederMotorStop();
+// Advance the pulse state machine (scheduler task)
+void updateFeederMotor();
+FeederMotorState getFeederMotorState();
+bool isFeederMotorBusy();
 
 #endif // FEEDER_MOTOR_H
-
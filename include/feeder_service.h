@@ -1,10 +1,24 @@
 #ifndef FEEDER_SERVICE_H
 #define FEEDER_SERVICE_H
 
+// Feeder sequence states (see updateFeederService in feeder_service.cpp)
+enum FeederState {
+    FEEDER_IDLE,
+    FEEDER_SPINUP,      // Blower running before the gate opens
+    FEEDER_DISPENSING,  // Gate open, waiting for the weight reduction
+    FEEDER_POST_BLOW    // Gate closed, blower finishing its duration
+};
+
 // Feeder service control functions
 void initFeederService();
 void startFeederSequence(int feedAmount, int blowerDuration);
 void startFeederSequence(int feedAmount, int blowerDuration, int weightTolerance);
 void stopFeederSequence();
+bool isFeederSequenceActive();
+FeederState getFeederState();
+
+// Learned gate flow model (dosing_model.h)
+void printDosingModel();
+void resetDosingModel();
 
-#endif // FEEDER_SERVICE_H 
\ No newline at end of file
+#endif // FEEDER_SERVICE_H
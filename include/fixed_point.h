@@ -0,0 +1,27 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <stdint.h>
+
+// Integer helpers for sensor conversions. The ATmega2560 has no FPU, so
+// conversions run on integers in mV, mA and mg, with scale constants folded
+// to integers at compile time (or once when a calibration changes). Floats
+// only appear when a reading is handed to the serializers.
+
+// value * factorQ16 / 65536 without a 64-bit multiply. factorQ16 is a signed
+// Q16.16 factor (whole part up to +/-32767); the product is split so that no
+// intermediate overflows for any 24-bit ADC value.
+static inline int32_t fixedMulQ16(int32_t value, int32_t factorQ16) {
+    int32_t whole = factorQ16 >> 16;
+    uint32_t frac = (uint32_t)factorQ16 & 0xFFFF;
+    int32_t high = value >> 16;
+    uint32_t low = (uint32_t)value & 0xFFFF;
+    return value * whole + high * (int32_t)frac + (int32_t)((low * frac) >> 16);
+}
+
+// Round a non-negative sum to the nearest multiple of 1 / (1 << shift)
+static inline uint16_t fixedRoundShift(uint32_t value, uint8_t shift) {
+    return (uint16_t)((value + (1UL << (shift - 1))) >> shift);
+}
+
+#endif // FIXED_POINT_H
@@ -0,0 +1,27 @@
+#ifndef FLOW_ESTIMATOR_H
+#define FLOW_ESTIMATOR_H
+
+#include "hal.h"
+#include "ring_buffer.h"
+
+// Online mass-flow estimate for the feeder: least-squares slope of the
+// dispensed mass over the most recent weight samples.
+
+#define FLOW_WINDOW 16       // Samples kept for the regression (1.6 s at 10 SPS)
+#define FLOW_MIN_SAMPLES 4   // Samples needed before a rate is reported
+
+struct FlowSample {
+    unsigned long timeMs;
+    float grams;             // Mass dispensed so far
+};
+
+struct FlowEstimator {
+    RingBuffer<FlowSample, FLOW_WINDOW> samples;
+};
+
+void flowReset(FlowEstimator& estimator);
+void flowAddSample(FlowEstimator& estimator, unsigned long timeMs, float grams);
+// Current flow in grams per second; false while there is not enough data
+bool flowRate(const FlowEstimator& estimator, float& gramsPerSecond);
+
+#endif // FLOW_ESTIMATOR_H
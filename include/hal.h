@@ -0,0 +1,261 @@
+#ifndef HAL_H
+#define HAL_H
+
+// Thin hardware abstraction so the firmware also builds on a PC
+// (platformio env:native). On the board this is just Arduino.h. On the host
+// it supplies the Arduino/AVR names the firmware uses, backed by fakes in
+// src/hal/: a virtual clock that the caller advances explicitly, pins and
+// analog inputs the test sets, a Serial port that captures output and
+// paces it at the baud rate, a RAM-backed EEPROM and HX711/DHT sensors.
+
+#ifdef NATIVE_BUILD
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+
+#define PROGMEM
+#define memcpy_P memcpy
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define strlen_P strlen
+static inline uint8_t halReadByte(const void* p) { return *(const uint8_t*)p; }
+static inline uint16_t halReadWord(const void* p) { uint16_t v; memcpy(&v, p, sizeof(v)); return v; }
+static inline uint32_t halReadDword(const void* p) { uint32_t v; memcpy(&v, p, sizeof(v)); return v; }
+#define pgm_read_byte(p) halReadByte(p)
+#define pgm_read_word(p) halReadWord(p)
+#define pgm_read_dword(p) halReadDword(p)
+
+#define F_CPU 16000000UL
+
+// Virtual clock (src/hal/native_clock.cpp)
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void halSetMicros(unsigned long us);
+void halAdvanceMicros(unsigned long us);
+
+// EEPROM held in RAM, same size as the ATmega2560's (src/hal/native_eeprom.cpp).
+// Each changed byte costs HAL_EEPROM_WRITE_US of virtual time, the
+// erase-and-write that eeprom_update_block() waits for on the board.
+#define E2END 0x0FFF
+#define HAL_EEPROM_WRITE_US 3300
+void eeprom_read_block(void* dst, const void* src, size_t n);
+void eeprom_update_block(const void* src, void* dst, size_t n);
+// Back to the erased state of a new chip
+void halEraseEeprom();
+
+// Interrupts, atomic blocks and sleep do nothing on the host
+#define noInterrupts()
+#define interrupts()
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_BLOCK(type) for (bool atomicOnce_ = true; atomicOnce_; atomicOnce_ = false)
+#define SLEEP_MODE_IDLE 0
+#define set_sleep_mode(mode)
+#define sleep_enable()
+#define sleep_disable()
+#define sleep_cpu()
+
+template <typename T> static inline T max(T a, T b) { return a > b ? a : b; }
+template <typename T> static inline T min(T a, T b) { return a < b ? a : b; }
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+
+// Pins (src/hal/native_io.cpp). Outputs are recorded; analog inputs return
+// what the test set, 0 otherwise.
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+#define A0 54
+#define A1 55
+#define A2 56
+#define A3 57
+#define A4 58
+#define A5 59
+#define A6 60
+#define A7 61
+#define HAL_PIN_COUNT 70
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+
+void halSetAnalogInput(uint8_t pin, int value);
+// Last level or PWM duty written to the pin
+int halPinValue(uint8_t pin);
+
+// Arduino String, heap-backed like the original so allocations can be
+// counted (src/hal/native_serial.cpp)
+class String {
+public:
+    String(const char* text = "");
+    String(const String& other);
+    explicit String(char c);
+    explicit String(int value);
+    explicit String(unsigned int value);
+    explicit String(long value);
+    explicit String(unsigned long value);
+    explicit String(float value, unsigned char digits = 2);
+    explicit String(double value, unsigned char digits = 2);
+    ~String();
+
+    String& operator=(const String& other);
+    String& operator+=(const String& other);
+    String& operator+=(const char* text);
+    String& operator+=(char c);
+
+    const char* c_str() const { return buffer; }
+    unsigned int length() const { return len; }
+    String substring(unsigned int from, unsigned int to) const;
+    String substring(unsigned int from) const { return substring(from, len); }
+    bool startsWith(const char* prefix) const { return strncmp(buffer, prefix, strlen(prefix)) == 0; }
+    int indexOf(char c, unsigned int from = 0) const;
+    void trim();
+    long toInt() const;
+    bool operator==(const char* text) const { return strcmp(buffer, text) == 0; }
+    bool operator==(const String& other) const { return strcmp(buffer, other.buffer) == 0; }
+
+private:
+    void append(const char* text, unsigned int count);
+    char* buffer;
+    unsigned int len;
+};
+
+String operator+(const String& a, const String& b);
+String operator+(const String& a, const char* b);
+String operator+(const char* a, const String& b);
+
+// Heap use by String since the last reset
+struct HalHeapStats {
+    uint32_t allocations;
+    uint32_t bytes;
+};
+const HalHeapStats& halHeapStats();
+void halResetHeapStats();
+
+// Arduino Print: number and text formatting on top of write()
+#define DEC 10
+#define HEX 16
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* data, size_t length);
+    size_t write(const char* text) { return write((const uint8_t*)text, strlen(text)); }
+
+    size_t print(const __FlashStringHelper* text);
+    size_t print(const char* text);
+    size_t print(const String& text);
+    size_t print(char c);
+    size_t print(unsigned char value, int base = DEC);
+    size_t print(int value, int base = DEC);
+    size_t print(unsigned int value, int base = DEC);
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int digits = 2);
+
+    size_t println();
+    template <typename T> size_t println(const T& value) { return print(value) + println(); }
+    template <typename T> size_t println(const T& value, int format) { return print(value, format) + println(); }
+};
+
+// Serial port (src/hal/native_serial.cpp). Received bytes are injected by
+// the test into a 64-byte RX buffer; bytes that do not fit are lost, as on
+// the board. Written bytes are captured and leave the 64-byte TX buffer at
+// the baud rate of the virtual clock; a write to a full buffer advances the
+// clock until there is room, which is what blocking costs on the board.
+#define SERIAL_RX_BUFFER_SIZE 64
+#define SERIAL_TX_BUFFER_SIZE 64
+
+class HalSerial : public Print {
+public:
+    void begin(unsigned long baud);
+    void end() {}
+    void flush();
+    void setTimeout(unsigned long) {}
+    int available();
+    int read();
+    int availableForWrite();
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* data, size_t length) override;
+    using Print::write;
+};
+
+extern HalSerial Serial;
+
+// Queue bytes as if the host had sent them; returns how many fit
+size_t halSerialInject(const char* text);
+// Everything written since the last clear
+const char* halSerialOutput();
+size_t halSerialOutputLength();
+void halSerialClearOutput();
+unsigned long halSerialBaud();
+uint32_t halSerialRxOverflows();
+// Total virtual time writers spent waiting for TX buffer room
+unsigned long halSerialBlockedMicros();
+
+// HX711 load cell (src/hal/native_sensors.cpp). A conversion is ready every
+// 100 ms of virtual time (10 SPS) while powered up.
+class HX711 {
+public:
+    HX711() : offset(0), scale(1.0f) {}
+    void begin(uint8_t dout, uint8_t sck, uint8_t gain = 128);
+    bool is_ready();
+    long read();
+    long read_average(uint8_t times = 10);
+    double get_value(uint8_t times = 1);
+    float get_units(uint8_t times = 1);
+    void tare(uint8_t times = 10);
+    void set_scale(float value) { scale = value; }
+    float get_scale() { return scale; }
+    void set_offset(long value) { offset = value; }
+    long get_offset() { return offset; }
+    void power_down();
+    void power_up();
+
+private:
+    long offset;
+    float scale;
+};
+
+void halSetLoadCellRaw(long raw);
+bool halIsLoadCellPoweredDown();
+
+// DHT22 (src/hal/native_sensors.cpp). A forced read takes
+// HAL_DHT_CONVERSION_US of virtual time, the interrupt-masked bit-bang on
+// the board; a failing sensor returns false and NaN.
+#define DHT22 22
+#define HAL_DHT_CONVERSION_US 5000
+
+class DHT {
+public:
+    DHT(uint8_t pin, uint8_t type) : pin(pin) { (void)type; }
+    void begin() {}
+    bool read(bool force = false);
+    float readTemperature();
+    float readHumidity();
+
+private:
+    uint8_t pin;
+};
+
+void halSetDhtReading(uint8_t pin, float temperature, float humidity);
+void halSetDhtFailing(uint8_t pin, bool failing);
+
+#else
+
+#include <Arduino.h>
+
+#endif // NATIVE_BUILD
+
+#endif // HAL_H
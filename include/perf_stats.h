@@ -0,0 +1,48 @@
+#ifndef PERF_STATS_H
+#define PERF_STATS_H
+
+#include "hal.h"
+
+// Lightweight micros()-based timing statistics kept in fixed RAM.
+// Each PerfStat keeps min/max/mean and a log2 histogram:
+//   bin 0: < 16us, bin k: [2^(k+3), 2^(k+4)) us, last bin: >= 16384us
+
+#define PERF_HISTOGRAM_BINS 12
+
+struct PerfStat {
+    uint32_t count;
+    uint64_t sumUs;
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint16_t histogram[PERF_HISTOGRAM_BINS];  // saturates at 65535
+};
+
+// Global measurement points (per-task timings live in the scheduler)
+enum PerfSlot {
+    PERF_LOOP,              // One loop() iteration
+    PERF_COMMAND_DISPATCH,  // Parsing and executing one command line
+    PERF_SERIALIZE,         // Encoding and printing one telemetry record
+    PERF_SENSOR_READ,       // Reading and converting one sensor sample
+    PERF_SLOT_COUNT
+};
+
+void perfReset(PerfStat& stat);
+void perfRecord(PerfStat& stat, uint32_t elapsedUs);
+uint32_t perfMean(const PerfStat& stat);
+
+PerfStat& perfSlot(PerfSlot slot);
+const __FlashStringHelper* perfSlotName(PerfSlot slot);
+void perfResetSlots();
+
+// Times the enclosing scope into a global slot
+class PerfScope {
+public:
+    explicit PerfScope(PerfSlot slot) : slot(slot), startUs(micros()) {}
+    ~PerfScope() { perfRecord(perfSlot(slot), micros() - startUs); }
+
+private:
+    PerfSlot slot;
+    unsigned long startUs;
+};
+
+#endif // PERF_STATS_H
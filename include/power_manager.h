@@ -0,0 +1,66 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include "hal.h"
+
+// Power saving for solar/battery operation.
+// - Idle sleep: after each scheduler pass the CPU sleeps in SLEEP_MODE_IDLE.
+//   Timers, the ADC and the USART keep running, so the millis() tick (1 ms),
+//   the ADC engine, the blower ramp and received bytes all wake it; no task
+//   is delayed by more than one tick.
+// - Gating: the HX711 and (if wired) the soil probe are powered only while
+//   their telemetry samples are taken. The HX711 stays on while feeding.
+//   The ADC engine, whose conversion interrupt would otherwise wake the idle
+//   sleep about ten times per millisecond, is stopped too and restarted
+//   ADC_ENGINE_CYCLE_MS before the next task that reads it is due.
+// - Throttling: below the battery thresholds the telemetry periods are
+//   multiplied by POWER_LOW_PERIOD_SCALE or POWER_CRITICAL_PERIOD_SCALE.
+
+#define POWER_BATTERY_LOW_PCT 30        // Default thresholds, 0 disables a level
+#define POWER_BATTERY_CRITICAL_PCT 15
+#define POWER_BATTERY_HYSTERESIS_PCT 3  // Recovery needed to leave a level
+#define POWER_LOW_PERIOD_SCALE 3
+#define POWER_CRITICAL_PERIOD_SCALE 12
+#define POWER_ADC_READERS 4             // Tasks that can hold the ADC engine on
+
+enum PowerLevel {
+    POWER_LEVEL_NORMAL,
+    POWER_LEVEL_LOW,
+    POWER_LEVEL_CRITICAL
+};
+
+struct PowerStats {
+    uint32_t sleeps;
+    uint32_t idleMs;           // Time spent asleep
+    unsigned long sinceMs;     // millis() when the counters were reset
+};
+
+// Load the settings from the config store
+void initPowerManager();
+
+// Sleep until the next interrupt; called from loop() after each pass
+void powerIdle();
+
+void setPowerIdleEnabled(bool enabled);
+bool isPowerIdleEnabled();
+void setPowerGatingEnabled(bool enabled);
+bool isPowerGatingEnabled();
+// Keep the ADC engine running ahead of this task's runs while gating is on
+void addPowerAdcReader(int8_t taskId);
+
+// Thresholds in %; false if critical is above low
+bool setBatteryThresholds(uint8_t lowPct, uint8_t criticalPct);
+uint8_t getBatteryLowPct();
+uint8_t getBatteryCriticalPct();
+
+// Feed a battery reading; returns true when the power level changed
+bool updateBatteryLevel(float percent);
+PowerLevel getPowerLevel();
+const char* powerLevelName(PowerLevel level);
+// Multiplier for telemetry periods at the current level
+uint8_t getPowerPeriodScale();
+
+const PowerStats& getPowerStats();
+void resetPowerStats();
+
+#endif // POWER_MANAGER_H
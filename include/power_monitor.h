@@ -1,8 +1,8 @@
 #ifndef POWER_MONITOR_H
 #define POWER_MONITOR_H
 
-#include <Arduino.h>
-#include <ArduinoJson.h>
+#include "hal.h"
+#include "adc_engine.h"
 
 // Pin definitions
 #define SOLAR_VOLTAGE_PIN A6
@@ -19,11 +19,34 @@
 #define SENSITIVITY 0.066
 #define ZERO_CURRENT_VOLTAGE 2.500
 
+// Conversions from a completed ADC_OVERSAMPLE sum, folded to integers at
+// compile time: millivolts/milliamps = (sum * factor) >> shift
+#define ADC_SUM_FULL_SCALE (1023.0 * ADC_OVERSAMPLE)
+#define POWER_MV_PER_SUM_Q16 ((uint32_t)(V_REF * V_FACTOR * 1000.0 * 65536.0 / ADC_SUM_FULL_SCALE + 0.5))
+#define POWER_MA_PER_SUM_Q15 ((int32_t)(V_REF / SENSITIVITY * 1000.0 * 32768.0 / ADC_SUM_FULL_SCALE + 0.5))
+#define POWER_ZERO_CURRENT_SUM ((int32_t)(ZERO_CURRENT_VOLTAGE / V_REF * ADC_SUM_FULL_SCALE + 0.5))
+
+// Readings below these are treated as noise
+#define SOLAR_MIN_MV 1000
+#define SOLAR_MIN_MA 500
+
 // Function declarations
 void initPowerMonitor();
-StaticJsonDocument<1024> readPowerMonitor();
-float estimateBatteryPercentage(float voltage);
-void readSensors(float& solarV, float& solarI, float& loadV, float& loadI);
-bool isCharging(float solarV, float solarI);
+struct PowerReading {
+  uint16_t solarMillivolts;
+  int32_t solarMilliamps;
+  uint16_t loadMillivolts;
+  int32_t loadMilliamps;
+  uint16_t batteryMillivolts;   // Same as load voltage
+  uint16_t batteryPercentX10;   // State of charge in 0.1 %
+  bool charging;
+  unsigned long timestamp;      // millis() when read
+};
+
+PowerReading readPowerMonitor();
+// Li-ion state of charge from the pack voltage (PROGMEM curve, interpolated)
+uint16_t estimateBatteryPercentX10(uint16_t millivolts);
+void readSensors(uint16_t& solarMv, int32_t& solarMa, uint16_t& loadMv, int32_t& loadMa);
+bool isCharging(uint16_t solarMv, int32_t solarMa);
 
-#endif 
\ No newline at end of file
+#endif
@@ -1,7 +1,7 @@
 #ifndef RELAY_CONTROL_H
 #define RELAY_CONTROL_H
 
-#include <Arduino.h>
+#include "hal.h"
 
 // Pin definitions for Relay Control
 #define RELAY_IN1 50  // Relay channel 1 (pond LED light)
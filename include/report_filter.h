@@ -0,0 +1,33 @@
+#ifndef REPORT_FILTER_H
+#define REPORT_FILTER_H
+
+#include "hal.h"
+
+// Report-by-exception for telemetry records.
+// A record is sent when any of its fields leaves its deadband around the
+// value last sent, or when the record has been silent for maxSilenceMs
+// (heartbeat). Otherwise it is suppressed and counted.
+
+#define REPORT_MAX_FIELDS 8
+
+struct Deadband {
+    bool relative;   // band is a fraction of the last sent value
+    float band;      // absolute units, or fraction when relative
+};
+
+struct ReportState {
+    float lastSent[REPORT_MAX_FIELDS];
+    unsigned long lastSentMs;
+    bool primed;     // false until the first record has been sent
+    uint32_t sent;
+    uint32_t suppressed;
+};
+
+void reportReset(ReportState& state);
+bool reportOutsideDeadband(const Deadband& deadband, float last, float value);
+
+// Decide whether a record goes out; updates the state and counters.
+bool reportShouldSend(ReportState& state, const float* values, const Deadband* deadbands,
+                      uint8_t count, unsigned long now, unsigned long maxSilenceMs);
+
+#endif // REPORT_FILTER_H
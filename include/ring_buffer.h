@@ -0,0 +1,58 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <stdint.h>
+
+// Fixed-size ring buffer with static storage.
+// N must be a power of two and at most 128 so indices fit in a uint8_t.
+template <typename T, uint8_t N>
+class RingBuffer {
+    static_assert(N > 0 && N <= 128 && (N & (N - 1)) == 0, "RingBuffer size must be a power of two <= 128");
+
+public:
+    RingBuffer() : head(0), count(0) {}
+
+    // Append, refusing when full
+    bool push(const T& item) {
+        if (count >= N) return false;
+        items[(uint8_t)(head + count) & (N - 1)] = item;
+        count++;
+        return true;
+    }
+
+    // Append, dropping the oldest entry when full
+    void pushOverwrite(const T& item) {
+        if (count >= N) {
+            head = (head + 1) & (N - 1);
+            count--;
+        }
+        push(item);
+    }
+
+    // Remove the oldest entry
+    bool pop(T& item) {
+        if (count == 0) return false;
+        item = items[head];
+        head = (head + 1) & (N - 1);
+        count--;
+        return true;
+    }
+
+    // 0 = oldest entry
+    const T& at(uint8_t index) const { return items[(uint8_t)(head + index) & (N - 1)]; }
+    // 0 = newest entry
+    const T& recent(uint8_t index) const { return at(count - 1 - index); }
+
+    uint8_t size() const { return count; }
+    bool isEmpty() const { return count == 0; }
+    bool isFull() const { return count >= N; }
+    static uint8_t capacity() { return N; }
+    void clear() { head = 0; count = 0; }
+
+private:
+    T items[N];
+    uint8_t head;
+    uint8_t count;
+};
+
+#endif // RING_BUFFER_H
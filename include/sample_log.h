@@ -0,0 +1,55 @@
+#ifndef SAMPLE_LOG_H
+#define SAMPLE_LOG_H
+
+#include "hal.h"
+#include "telemetry_codec.h"
+
+// Offline sample log: binary-packed telemetry records kept while the host is
+// not listening, dumped in bulk when it comes back.
+// Records are stored back to back in a byte ring on a LogStorage backend:
+//   length(1) | sensorId(1) | timestampMs(4) | payload(length)
+// When the ring is full the oldest records are dropped to make room.
+
+#define SAMPLE_LOG_HEADER_SIZE 6
+#define SAMPLE_LOG_MAX_PAYLOAD TELEMETRY_MAX_PAYLOAD
+#define SAMPLE_LOG_RAM_SIZE    768   // Bytes of SRAM for the built-in backend
+
+// Byte-addressed storage for the ring. The RAM backend below is always
+// available; an external SPI FRAM/EEPROM driver plugs in by providing the
+// same three members. Accesses never cross the end of the storage.
+struct LogStorage {
+    uint16_t capacity;
+    void (*read)(uint16_t addr, uint8_t* data, uint16_t len);
+    void (*write)(uint16_t addr, const uint8_t* data, uint16_t len);
+};
+
+struct SampleLogRecord {
+    uint8_t sensorId;
+    uint32_t timestampMs;
+    uint8_t payload[SAMPLE_LOG_MAX_PAYLOAD];
+    uint8_t length;
+};
+
+struct SampleLog {
+    const LogStorage* storage;
+    uint16_t tail;      // Address of the oldest record
+    uint16_t used;      // Bytes in use
+    uint16_t records;
+    uint32_t logged;    // Records appended since reset
+    uint32_t dropped;   // Records overwritten before they were dumped
+};
+
+// Built-in backend: SAMPLE_LOG_RAM_SIZE bytes of static SRAM
+const LogStorage* sampleLogRamStorage();
+
+void sampleLogReset(SampleLog& log, const LogStorage* storage);
+// Append a record, dropping the oldest ones if needed. Returns false only if
+// the payload is larger than SAMPLE_LOG_MAX_PAYLOAD.
+bool sampleLogAppend(SampleLog& log, uint8_t sensorId, uint32_t timestampMs,
+                     const uint8_t* payload, uint8_t length);
+// Read the oldest record without removing it
+bool sampleLogPeek(const SampleLog& log, SampleLogRecord& record);
+// Remove the oldest record
+void sampleLogDrop(SampleLog& log);
+
+#endif // SAMPLE_LOG_H
@@ -0,0 +1,103 @@
+#ifndef SENSOR_REGISTRY_H
+#define SENSOR_REGISTRY_H
+
+#include "hal.h"
+#include "report_filter.h"
+
+// Compile-time sensor registry.
+// Every telemetry sensor is one entry in kSensors (sensor_registry.cpp):
+// its names, init and read functions, field list and default period. The
+// scheduler tasks, JSON and binary serializers, report-on-change filter and
+// sensors:status output are all driven from that table, so adding hardware
+// means writing its read function and adding one table entry.
+
+// Registry order; also the order of the binary snapshot record
+enum SensorSlot {
+    SENSOR_DHT_SYSTEM,
+    SENSOR_DHT_FEEDER,
+    SENSOR_SOIL,
+    SENSOR_WEIGHT,
+    SENSOR_POWER_MONITOR,
+    SENSOR_COUNT
+};
+
+// Every field reported by any sensor
+enum SensorFieldId {
+    FIELD_TEMPERATURE,
+    FIELD_HUMIDITY,
+    FIELD_SOIL_MOISTURE,
+    FIELD_WEIGHT,
+    FIELD_SOLAR_VOLTAGE,
+    FIELD_SOLAR_CURRENT,
+    FIELD_LOAD_VOLTAGE,
+    FIELD_LOAD_CURRENT,
+    FIELD_BATTERY_VOLTAGE,
+    FIELD_BATTERY_PERCENTAGE,
+    FIELD_BATTERY_STATUS,
+    FIELD_COUNT
+};
+
+#define SENSOR_MAX_FIELDS 8
+#define SENSOR_TOTAL_FIELDS 13  // Fields of all sensors together (checked in the registry)
+#define SENSOR_INVALID_FIELD -1
+
+// Binary payload encoding of a field, little-endian
+enum WireFormat {
+    WIRE_NONE,  // Not sent in binary records
+    WIRE_U8,
+    WIRE_U16,
+    WIRE_I16,
+    WIRE_I32
+};
+
+// Field metadata; strings live in PROGMEM
+struct SensorFieldInfo {
+    const char* type;
+    const char* unit;
+    uint8_t wire;        // WireFormat
+    float wireScale;     // value * wireScale is sent
+    Deadband deadband;   // Default report-on-change band
+    // Status fields hold 0/1 and are reported as one of these labels in
+    // JSON; NULL for numeric fields
+    const char* offLabel;
+    const char* onLabel;
+};
+
+// One reading, values in the order of the sensor's field list
+struct SensorSample {
+    float values[SENSOR_MAX_FIELDS];
+    unsigned long timestamp;  // millis() when the value was sampled
+    bool valid;               // false when the sensor has no current reading
+};
+
+typedef void (*SensorInitFn)();
+// Fills values and timestamp; clears valid when there is nothing current to report
+typedef void (*SensorReadFn)(SensorSample& sample);
+
+struct SensorDescriptor {
+    const char* name;         // PROGMEM, "name" in JSON records
+    const char* taskName;     // PROGMEM, scheduler and status name
+    uint8_t telemetryId;      // Binary record ID
+    SensorInitFn init;        // NULL when another entry initialises the hardware
+    SensorReadFn read;
+    const uint8_t* fields;    // PROGMEM list of SensorFieldId
+    uint8_t fieldCount;
+    unsigned long periodMs;   // Default telemetry period
+};
+
+// Copy a registry entry or field description out of flash
+void getSensor(uint8_t slot, SensorDescriptor& sensor);
+void getSensorField(uint8_t fieldId, SensorFieldInfo& field);
+uint8_t getSensorFieldId(const SensorDescriptor& sensor, uint8_t index);
+// Look up a field by its type string (RAM); SENSOR_INVALID_FIELD if unknown
+int8_t findSensorField(const char* type);
+
+// Call every registered init function once
+void initRegisteredSensors();
+
+// Pack a sample as the sensor's binary payload; returns its length, 0 if
+// it does not fit in outCap
+size_t packSensorSample(const SensorDescriptor& sensor, const SensorSample& sample,
+                        uint8_t* out, size_t outCap);
+
+#endif // SENSOR_REGISTRY_H
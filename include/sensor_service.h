@@ -5,9 +5,8 @@ void initAllSensors();
 void readAndPrintAllSensors();
 void controlSensor();
 
-// New timer-based sensor service functions
+// Timer-based sensor service functions (telemetry runs as scheduler tasks)
 void initSensorService();
-void updateSensorService();
 void setSensorPrintInterval(unsigned long intervalMs);
 
 // Sensor service control functions
@@ -15,4 +14,7 @@ void startSensorService();
 void stopSensorService();
 bool isSensorServiceActive();
 
+// Telemetry output format (JSON lines or COBS-framed binary records)
+void setTelemetryBinaryMode(bool enabled);
+
 #endif 
\ No newline at end of file
@@ -0,0 +1,49 @@
+#ifndef SERIAL_LINK_H
+#define SERIAL_LINK_H
+
+#include "hal.h"
+
+// Host serial link and runtime baud switching.
+// The board always boots at LINK_DEFAULT_BAUD and announces what it supports
+// with a capability line:
+//   [EVENT] - link:caps:default=115200,rates=115200|250000|500000|1000000,formats=json|binary,rx=64,tx=64
+// Switch handshake (link:baud:<rate>):
+//   1. board: [EVENT] - link:baud:switch:<rate>   (old rate; switches once
+//      everything queued before it has been sent)
+//   2. host switches and sends "\n[control]:link:ack\n" within LINK_ACK_TIMEOUT_MS
+//   3. board: [EVENT] - link:baud:ok:<rate>
+// Without the ack the board returns to the previous rate and reports
+// [EVENT] - link:baud:fallback:<rate>. Optionally (link:idle:<ms>, off by
+// default) it also returns to LINK_DEFAULT_BAUD when the host has sent no
+// line for that long at a raised rate; a host that enables this keeps the
+// link up with an empty line.
+//
+// The DHT and HX711 libraries read with interrupts masked (DHT about 5 ms,
+// HX711 a few hundred us). The USART holds only about 3 received bytes
+// meanwhile, so host bytes arriving then are lost: up to ~55 bytes per DHT
+// read at 115200 and ~500 at 1M. Hosts send one line at a time and resend
+// if the reply does not arrive.
+
+#define LINK_DEFAULT_BAUD 115200UL
+#define LINK_ACK_TIMEOUT_MS 2000
+#define LINK_IDLE_FALLBACK_MS 0UL   // Default idle fallback, 0 = off
+
+// Open the port at the default rate and send the capability report
+void initSerialLink();
+
+// Start the switch handshake; false if the rate is not supported or a
+// switch is already pending
+bool linkRequestBaud(unsigned long baud);
+// Host ack at the new rate; false if no switch was pending
+bool linkAcknowledge();
+// Called for every complete line received from the host
+void linkHostActivity();
+// Return to the default rate after this long without a host line; 0 = never
+void setLinkIdleFallback(unsigned long ms);
+unsigned long getLinkIdleFallback();
+
+unsigned long getLinkBaud();
+bool isLinkSwitchPending();
+void printLinkCapabilities();
+
+#endif // SERIAL_LINK_H
@@ -0,0 +1,45 @@
+#ifndef SERIAL_TX_H
+#define SERIAL_TX_H
+
+#include "hal.h"
+#include "tx_queue.h"
+
+// Print front end of the transmit queue (tx_queue.h). All firmware output
+// goes through SerialTx instead of Serial:
+// - text written outside an explicit record becomes one control record per
+//   line, so log lines and events are never cut by telemetry
+// - telemetry and bulk output is wrapped in serialTxBegin()/serialTxEnd()
+// Telemetry never waits for the line. The pump task moves queued bytes
+// into the core's 64-byte TX buffer whenever it has room; the core's UDRE
+// interrupt sends them from there. A control line that finds the control
+// ring full waits until the UART has sent enough, instead of being dropped;
+// long reports avoid that by printing a line only when there is room.
+class SerialTxPrint : public Print {
+public:
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* data, size_t length) override;
+    using Print::write;
+};
+
+extern SerialTxPrint SerialTx;
+
+// Reset the queue and register the pump task
+void initSerialTx();
+
+void serialTxBegin(TxClass cls, uint8_t key);
+void serialTxEnd();
+// Fill the UART buffer from the queue (scheduler task, also run after each record)
+void serialTxPump();
+
+// While paused no new telemetry record is started; control records still
+// go. Used to empty the line before the baud rate changes.
+void serialTxPause(bool paused);
+// Paused, no record partly sent and the UART buffer empty
+bool isSerialTxDrained();
+
+// Direct mode writes straight to Serial and may block. It is on until the
+// end of setup() and used by commands that block anyway (calibration);
+// switching it on sends everything still queued first.
+void serialTxSetDirect(bool direct);
+
+#endif // SERIAL_TX_H
@@ -1,17 +1,37 @@
 #ifndef SOIL_SENSOR_H
 #define SOIL_SENSOR_H
 
-#include <Arduino.h>
-#include <ArduinoJson.h>
+#include "hal.h"
 
 // Pin definitions
 #define SOIL_PIN A2
+// Digital pin that feeds the probe, or -1 if the probe is powered
+// permanently. Switching it off between samples saves the probe current and
+// slows electrode corrosion.
+#define SOIL_POWER_PIN -1
+// Probe settling plus two ADC engine cycles (~34 ms each), so the block read
+// afterwards was converted entirely with the probe powered
+#define SOIL_SETTLE_MS 120
 
 // Sensor name
 #define SOIL_SENSOR "SOIL_MOISTURE"
 
 // Function declarations
 void initSoil();
-StaticJsonDocument<256> readSoil();
+struct SoilReading {
+  int moisture;             // %
+  unsigned long timestamp;  // millis() when read
+};
+
+SoilReading readSoil();
+
+// Power gating (only with SOIL_POWER_PIN): with power save on, the probe is
+// switched on every cycleMs, sampled after SOIL_SETTLE_MS and switched off
+// again; readSoil() then returns that sample.
+void setSoilPowerSave(bool enabled, unsigned long cycleMs);
+// Periodic task driving the gating; does nothing without SOIL_POWER_PIN
+void updateSoilPower();
+// True while a gated probe is powered for its sample and needs the ADC engine
+bool isSoilProbeSampling();
 
 #endif // SOIL_SENSOR_H
\ No newline at end of file
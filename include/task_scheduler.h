@@ -0,0 +1,55 @@
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include "hal.h"
+#include "perf_stats.h"
+
+// Cooperative scheduler with a static task table.
+// loop() calls runScheduler(), which runs every due task once per pass in
+// priority order. Tasks must return quickly; nothing is preempted.
+
+#define MAX_TASKS 17
+
+// Lower value runs first within a pass
+#define TASK_PRIORITY_CRITICAL 0  // Command intake
+#define TASK_PRIORITY_HIGH     1  // Sampling and actuators
+#define TASK_PRIORITY_NORMAL   2  // Feeder logic
+#define TASK_PRIORITY_LOW      3  // Telemetry output
+
+#define TASK_INVALID -1
+
+typedef void (*TaskCallback)();
+
+// periodMs:   0 = run on every pass
+// deadlineMs: allowed lateness before a deadline miss is counted
+// budgetUs:   expected run time; longer runs are counted as overruns
+int8_t registerTask(const __FlashStringHelper* name, TaskCallback callback,
+                    unsigned long periodMs, unsigned long deadlineMs,
+                    uint8_t priority, unsigned long budgetUs);
+
+void setTaskPeriod(int8_t taskId, unsigned long periodMs);
+void setTaskEnabled(int8_t taskId, bool enabled);
+// Schedule the next run delayMs from now (used to stagger tasks)
+void delayTask(int8_t taskId, unsigned long delayMs);
+// Time until the task's next run, 0 if it is due; false if it is disabled
+bool getTaskDueInMs(int8_t taskId, unsigned long& dueInMs);
+
+void runScheduler();
+
+// Read-only view of a task for status reports
+struct TaskInfo {
+    const __FlashStringHelper* name;
+    unsigned long periodMs;
+    uint8_t priority;
+    bool enabled;
+    const PerfStat* timing;
+    uint16_t deadlineMisses;
+    uint16_t budgetOverruns;
+};
+
+uint8_t getTaskCount();
+// position is in priority order; returns false when out of range
+bool getTaskInfo(uint8_t position, TaskInfo& info);
+void resetTaskStats();
+
+#endif // TASK_SCHEDULER_H
@@ -0,0 +1,92 @@
+#ifndef TELEMETRY_CODEC_H
+#define TELEMETRY_CODEC_H
+
+// Binary telemetry framing shared by the firmware and host-side tools.
+// Only depends on the C standard headers so it also builds on a PC.
+//
+// Record layout (little-endian):
+//   [sensorId:u8][seq:u16][timestampMs:u32][payload...]
+//
+// Frame on the wire:
+//   0x00 | COBS(record | crc16) | 0x00
+//
+// The leading and trailing 0x00 delimiters let a host pick binary frames out
+// of a stream that still carries plain-text "[INFO]" lines, since neither the
+// text nor the COBS body can contain a zero byte.
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Sensor IDs used in the record header
+#define TELEMETRY_ID_DHT_SYSTEM    1
+#define TELEMETRY_ID_DHT_FEEDER    2
+#define TELEMETRY_ID_SOIL          3
+#define TELEMETRY_ID_WEIGHT        4
+#define TELEMETRY_ID_POWER_MONITOR 5
+#define TELEMETRY_ID_SNAPSHOT      6
+
+// Payload layouts per sensor ID
+//   DHT:   temperature C x10 (i16), humidity % x10 (u16)
+//   SOIL:  moisture % (u8)
+//   WEIGHT: weight g (i32)
+//   POWER: solar mV (u16), solar mA (i16), load mV (u16), load mA (i16),
+//          battery % x10 (u16), charging flag (u8)
+//   SNAPSHOT: every sensor of one cycle in ID order 1..5, each as
+//          age ms before the header timestamp (u16, saturating at 0xFFFE) +
+//          its payload; age 0xFFFF means the sensor has no current reading
+#define TELEMETRY_DHT_PAYLOAD_SIZE    4
+#define TELEMETRY_SOIL_PAYLOAD_SIZE   1
+#define TELEMETRY_WEIGHT_PAYLOAD_SIZE 4
+#define TELEMETRY_POWER_PAYLOAD_SIZE  11
+#define TELEMETRY_SNAPSHOT_AGE_SIZE   2
+#define TELEMETRY_SNAPSHOT_NO_READING 0xFFFF
+#define TELEMETRY_SNAPSHOT_MAX_AGE    0xFFFE
+#define TELEMETRY_SNAPSHOT_PAYLOAD_SIZE (5 * TELEMETRY_SNAPSHOT_AGE_SIZE + \
+    2 * TELEMETRY_DHT_PAYLOAD_SIZE + TELEMETRY_SOIL_PAYLOAD_SIZE + \
+    TELEMETRY_WEIGHT_PAYLOAD_SIZE + TELEMETRY_POWER_PAYLOAD_SIZE)
+
+#define TELEMETRY_HEADER_SIZE 7
+#define TELEMETRY_CRC_SIZE    2
+#define TELEMETRY_MAX_PAYLOAD 40
+#define TELEMETRY_MAX_RECORD  (TELEMETRY_HEADER_SIZE + TELEMETRY_MAX_PAYLOAD)
+// COBS adds one byte per 254 input bytes (plus one), then two delimiters
+#define TELEMETRY_MAX_FRAME   (TELEMETRY_MAX_RECORD + TELEMETRY_CRC_SIZE + 2 + 2)
+
+struct TelemetryRecordHeader {
+    uint8_t sensorId;
+    uint16_t seq;
+    uint32_t timestampMs;
+};
+
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
+uint16_t telemetryCrc16(const uint8_t* data, size_t len);
+
+// COBS encode/decode. Return the number of bytes written, 0 on error.
+size_t cobsEncode(const uint8_t* in, size_t len, uint8_t* out, size_t outCap);
+size_t cobsDecode(const uint8_t* in, size_t len, uint8_t* out, size_t outCap);
+
+// Little-endian helpers for building and reading payloads
+void telemetryPutU16(uint8_t* p, uint16_t v);
+void telemetryPutU32(uint8_t* p, uint32_t v);
+uint16_t telemetryGetU16(const uint8_t* p);
+uint32_t telemetryGetU32(const uint8_t* p);
+
+// Build a complete delimited frame from header + payload.
+// Returns frame length, or 0 if it does not fit.
+size_t telemetryEncodeFrame(const TelemetryRecordHeader& header,
+                            const uint8_t* payload, size_t payloadLen,
+                            uint8_t* out, size_t outCap);
+
+// Decode the bytes between two 0x00 delimiters (delimiters excluded).
+// Verifies the CRC and fills header/payload. Returns false on a bad frame.
+bool telemetryDecodeFrame(const uint8_t* frame, size_t frameLen,
+                          TelemetryRecordHeader& header,
+                          uint8_t* payload, size_t payloadCap, size_t& payloadLen);
+
+// Find a sensor's block in a SNAPSHOT payload. Returns false for an unknown
+// ID or a sensor without a current reading; otherwise sets its age and the
+// start of its payload.
+bool telemetrySnapshotBlock(const uint8_t* snapshot, uint8_t sensorId,
+                            uint16_t& ageMs, const uint8_t*& sensorPayload);
+
+#endif // TELEMETRY_CODEC_H
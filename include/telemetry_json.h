@@ -0,0 +1,18 @@
+#ifndef TELEMETRY_JSON_H
+#define TELEMETRY_JSON_H
+
+#include "hal.h"
+#include "sensor_registry.h"
+
+// JSON serialization of sensor samples, used only at the output edge.
+// Records are generated from the sensor registry's field metadata:
+//   {"name":"<sensor>","value":[{"type":"<field>","unit":"<unit>","value":<v>},...]}
+
+size_t writeSensorJson(Print& out, const SensorDescriptor& sensor, const SensorSample& sample);
+
+// {"name":"SNAPSHOT","seq":n,"t":ms,"sensors":{"<sensor>":{"t":ms,"<type>":value,...},...}}
+// samples holds one entry per registry slot; sensors without a valid sample
+// are left out. Returns the number of bytes written.
+size_t writeSnapshotJson(Print& out, uint16_t seq, unsigned long now, const SensorSample* samples);
+
+#endif // TELEMETRY_JSON_H
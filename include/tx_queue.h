@@ -0,0 +1,66 @@
+#ifndef TX_QUEUE_H
+#define TX_QUEUE_H
+
+#include "hal.h"
+
+// Transmit queue in front of the serial port.
+// Output is queued as whole records in two byte rings and handed to the
+// UART as fast as it can take it, so a print normally never waits for the line:
+//   control:   acks, events and log lines; always sent first, never dropped
+//              (SerialTx waits for the UART when this ring is full)
+//   telemetry: sensor records; when the ring is full the oldest droppable
+//              records are dropped, and a new record replaces any queued
+//              record with the same key that has not started sending yet.
+//              A record that has started sending stays; records behind it
+//              are dropped instead.
+// Records are interleaved only at record boundaries. Each record is stored
+// as length(2) | key(1) | flags(1) | bytes; a record is written while open
+// and only becomes visible to txQueueRead() once txQueueEnd() commits it.
+
+#define TX_CONTROL_SIZE   256
+#define TX_TELEMETRY_SIZE 640
+#define TX_RECORD_HEADER  4
+#define TX_KEY_NONE       0       // Never coalesced
+// Bulk records (log dump) may only use the telemetry ring down to this much
+// free space, so a full JSON record still fits during a dump
+#define TX_BULK_RESERVE   512
+
+enum TxClass {
+    TX_CONTROL,
+    TX_TELEMETRY,
+    TX_BULK       // Telemetry ring, not dropped; check txQueueFree() first
+};
+
+struct TxQueueStats {
+    uint32_t records;        // Records committed
+    uint16_t dropped;        // Telemetry records dropped for space
+    uint16_t coalesced;      // Telemetry records replaced by a newer one
+    uint16_t lost;           // Records that could not be queued at all
+    uint16_t maxControl;     // Peak bytes used per ring
+    uint16_t maxTelemetry;
+};
+
+void txQueueReset();
+
+// Open a record; an open record is committed first. key groups telemetry
+// records for coalescing (TX_KEY_NONE for none).
+void txQueueBegin(TxClass cls, uint8_t key);
+// Append to the open record; bytes that do not fit make the whole record lost
+void txQueueWrite(const uint8_t* data, size_t length);
+// Commit the open record
+void txQueueEnd();
+bool txQueueRecordOpen();
+
+// Copy up to max bytes for the UART: control records first, but a record
+// that has started is always finished. With controlOnly no telemetry record
+// is started.
+size_t txQueueRead(uint8_t* out, size_t max, bool controlOnly);
+// True while a record is partly sent
+bool txQueueSending();
+bool txQueueEmpty(TxClass cls);
+// Bytes a new record of this class can use without dropping anything
+uint16_t txQueueFree(TxClass cls);
+
+const TxQueueStats& getTxQueueStats();
+
+#endif // TX_QUEUE_H
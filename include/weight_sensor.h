@@ -1,17 +1,26 @@
 #ifndef WEIGHT_SENSOR_H
 #define WEIGHT_SENSOR_H
 
-#include <Arduino.h>
+#include "hal.h"
+#ifndef NATIVE_BUILD
 #include <HX711.h>
-#include <ArduinoJson.h>
-#include <EEPROM.h>
+#endif
 
 const int LOADCELL_DOUT_PIN = 28;
 const int LOADCELL_SCK_PIN = 26;
-const float FIXED_SCALE_FACTOR = 35445.f;
-
-// EEPROM addresses
-const int EEPROM_OFFSET_ADDR = 0;  // Address for storing offset value
+const float FIXED_SCALE_FACTOR = 35445.f;  // Default until one is stored
+// Accepted magnitude of a scale factor (negative for a reversed load cell).
+// Reads multiply by 1e6 / factor in Q16.16, whose whole part must stay
+// within +/-32767 (fixed_point.h): 1e6 / 31 = 32258.
+#define WEIGHT_SCALE_FACTOR_MIN 31.0f
+#define WEIGHT_SCALE_FACTOR_MAX 1.0e7f
+
+// Background sampler: one HX711 conversion is taken whenever DOUT goes low
+// (10 SPS), so reads never wait on the ADC
+#define WEIGHT_RING_SIZE 32
+#define WEIGHT_AVERAGE_SAMPLES 20   // Samples averaged for telemetry
+#define WEIGHT_FAST_SAMPLES 4       // Samples averaged while feeding
+#define WEIGHT_SETTLE_SAMPLES 4     // Discarded after power-up (400 ms settling at 10 SPS)
 
 // Sensor name
 #define WEIGHT_SENSOR "HX711_FEEDER"
@@ -19,9 +28,34 @@ const int EEPROM_OFFSET_ADDR = 0;  // Address for storing offset value
 extern HX711 scale;
 
 void initWeight();
-StaticJsonDocument<256> readWeight();
-
-// Weight calibration function
+struct WeightReading {
+  long weightMg;            // Average of WEIGHT_AVERAGE_SAMPLES samples
+  unsigned long timestamp;  // millis() when read
+};
+
+WeightReading readWeight();
+
+// Poll the HX711 and store a sample if a conversion is ready (non-blocking)
+void updateWeightSampler();
+// Average of the newest samples in mg; returns instantly from the ring buffer
+long readWeightMg(uint8_t samples);
+// Total number of samples taken since boot (lets callers detect new data)
+unsigned long getWeightSampleCount();
+
+// Power gating: with power save on, the HX711 is powered down after each
+// burst of WEIGHT_AVERAGE_SAMPLES and woken again cycleMs after the burst
+// started, so the telemetry average always comes from the latest burst.
+// A hold keeps it running (feeding needs continuous samples).
+void setWeightPowerSave(bool enabled, unsigned long cycleMs);
+void setWeightPowerHold(bool hold);
+bool isWeightPoweredDown();
+
+// Counts per kg; the new factor is stored in the config store. Returns false
+// (and keeps the current factor) when it is out of range.
+bool setWeightScaleFactor(float factor);
+float getWeightScaleFactor();
+
+// Weight calibration function (tares and stores the offset)
 void calibrateWeight();
 
 #endif
\ No newline at end of file
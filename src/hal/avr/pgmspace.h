@@ -0,0 +1,8 @@
+// Host stand-in for avr-libc's pgmspace.h, found through -Isrc/hal in the
+// native envs only. ArduinoJson includes it for PROGMEM keys outside Arduino.
+#ifndef HAL_AVR_PGMSPACE_H
+#define HAL_AVR_PGMSPACE_H
+
+#include "hal.h"
+
+#endif // HAL_AVR_PGMSPACE_H
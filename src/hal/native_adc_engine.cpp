@@ -0,0 +1,35 @@
+// Fake ADC engine for the host build; empty on the board.
+// Every block holds ADC_OVERSAMPLE copies of the pin's analog input. While
+// the engine is stopped the sums stay at the inputs seen when it stopped.
+#ifdef NATIVE_BUILD
+
+#include "adc_engine.h"
+
+static bool running = false;
+static uint16_t heldSums[8];   // A0..A7
+
+void initAdcEngine() {
+  startAdcEngine();
+}
+
+void startAdcEngine() {
+  running = true;
+}
+
+void stopAdcEngine() {
+  for (uint8_t i = 0; i < 8; i++) {
+    heldSums[i] = (uint16_t)(analogRead(A0 + i) * ADC_OVERSAMPLE);
+  }
+  running = false;
+}
+
+bool isAdcEngineRunning() {
+  return running;
+}
+
+uint16_t adcReadSum(uint8_t pin) {
+  if (!running && pin >= A0 && pin <= A7) return heldSums[pin - A0];
+  return (uint16_t)(analogRead(pin) * ADC_OVERSAMPLE);
+}
+
+#endif // NATIVE_BUILD
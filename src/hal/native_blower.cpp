@@ -0,0 +1,70 @@
+// Fake blower for the host build; empty on the board.
+// The output follows the target at once instead of ramping from the Timer5
+// interrupt, and is written to the fake pins with analogWrite().
+#ifdef NATIVE_BUILD
+
+#include "blower.h"
+
+static int currentSpeed = 230;
+static bool isRunning = false;
+static bool isReverse = false;
+static int output = 0;
+static uint16_t rampRate = BLOWER_RAMP_DEFAULT_RATE;
+static uint32_t pwmFrequency = 0;
+
+void initBlower() {
+  pinMode(RPWM, OUTPUT);
+  pinMode(LPWM, OUTPUT);
+  setBlowerPwmFrequency(BLOWER_PWM_DEFAULT_HZ);
+  updateBlower();
+}
+
+void startBlower() {
+  isRunning = true;
+  updateBlower();
+}
+
+void stopBlower() {
+  isRunning = false;
+  updateBlower();
+}
+
+void setBlowerSpeed(int speed) {
+  currentSpeed = constrain(speed, 0, 255);
+  updateBlower();
+}
+
+void setBlowerDirection(bool reverse) {
+  isReverse = reverse;
+  updateBlower();
+}
+
+void updateBlower() {
+  output = isRunning ? (isReverse ? -currentSpeed : currentSpeed) : 0;
+  analogWrite(RPWM, output > 0 ? output : 0);
+  analogWrite(LPWM, output < 0 ? -output : 0);
+}
+
+void setBlowerRampRate(uint16_t unitsPerSecond) {
+  rampRate = unitsPerSecond;
+}
+
+uint16_t getBlowerRampRate() {
+  return rampRate;
+}
+
+uint32_t setBlowerPwmFrequency(uint32_t hz) {
+  if (hz < BLOWER_PWM_MIN_HZ || hz > BLOWER_PWM_MAX_HZ) return 0;
+  pwmFrequency = hz;
+  return pwmFrequency;
+}
+
+uint32_t getBlowerPwmFrequency() {
+  return pwmFrequency;
+}
+
+int getBlowerOutput() {
+  return output;
+}
+
+#endif // NATIVE_BUILD
@@ -0,0 +1,33 @@
+// Virtual clock for the host build; empty on the board.
+#ifdef NATIVE_BUILD
+
+#include "hal.h"
+
+static unsigned long virtualMicros = 0;
+
+unsigned long millis() {
+    return virtualMicros / 1000UL;
+}
+
+unsigned long micros() {
+    return virtualMicros;
+}
+
+// Busy waits only move the clock
+void delay(unsigned long ms) {
+    virtualMicros += ms * 1000UL;
+}
+
+void delayMicroseconds(unsigned int us) {
+    virtualMicros += us;
+}
+
+void halSetMicros(unsigned long us) {
+    virtualMicros = us;
+}
+
+void halAdvanceMicros(unsigned long us) {
+    virtualMicros += us;
+}
+
+#endif // NATIVE_BUILD
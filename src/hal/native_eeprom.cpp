@@ -0,0 +1,39 @@
+// RAM-backed EEPROM for the host build; empty on the board.
+#ifdef NATIVE_BUILD
+
+#include "hal.h"
+
+// Starts erased, like a new chip
+static uint8_t eepromCells[E2END + 1];
+static bool eepromErased = false;
+
+static void eraseOnce() {
+    if (!eepromErased) halEraseEeprom();
+}
+
+void halEraseEeprom() {
+    memset(eepromCells, 0xFF, sizeof(eepromCells));
+    eepromErased = true;
+}
+
+void eeprom_read_block(void* dst, const void* src, size_t n) {
+    eraseOnce();
+    size_t addr = (size_t)src;
+    if (addr + n > sizeof(eepromCells)) return;
+    memcpy(dst, &eepromCells[addr], n);
+}
+
+void eeprom_update_block(const void* src, void* dst, size_t n) {
+    eraseOnce();
+    size_t addr = (size_t)dst;
+    if (addr + n > sizeof(eepromCells)) return;
+    // Like avr-libc, only cells that change are written, each one busy-waited
+    const uint8_t* bytes = (const uint8_t*)src;
+    for (size_t i = 0; i < n; i++) {
+        if (eepromCells[addr + i] == bytes[i]) continue;
+        eepromCells[addr + i] = bytes[i];
+        halAdvanceMicros(HAL_EEPROM_WRITE_US);
+    }
+}
+
+#endif // NATIVE_BUILD
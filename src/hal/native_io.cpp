@@ -0,0 +1,43 @@
+// Fake pins for the host build; empty on the board.
+#ifdef NATIVE_BUILD
+
+#include "hal.h"
+
+static int pinValues[HAL_PIN_COUNT];
+static int analogInputs[HAL_PIN_COUNT];
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    (void)pin;
+    (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    if (pin < HAL_PIN_COUNT) pinValues[pin] = value ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin) {
+    return pin < HAL_PIN_COUNT ? pinValues[pin] : LOW;
+}
+
+int analogRead(uint8_t pin) {
+    return pin < HAL_PIN_COUNT ? analogInputs[pin] : 0;
+}
+
+// Like the core: 0 and 255 are plain digital levels
+void analogWrite(uint8_t pin, int value) {
+    if (pin < HAL_PIN_COUNT) pinValues[pin] = value;
+}
+
+void halSetAnalogInput(uint8_t pin, int value) {
+    if (pin < HAL_PIN_COUNT) analogInputs[pin] = value;
+}
+
+int halPinValue(uint8_t pin) {
+    return pin < HAL_PIN_COUNT ? pinValues[pin] : 0;
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+#endif // NATIVE_BUILD
@@ -0,0 +1,129 @@
+// Fake HX711 and DHT22 for the host build; empty on the board.
+#ifdef NATIVE_BUILD
+
+#include "hal.h"
+
+// === HX711 ===
+
+#define HAL_HX711_PERIOD_US 100000UL   // 10 SPS
+
+static long loadCellRaw = 0;
+static bool loadCellDown = false;
+static unsigned long loadCellUpAt = 0;
+static unsigned long conversionsRead = 0;
+
+// Conversions completed since power-up
+static unsigned long conversionsDone() {
+    return (micros() - loadCellUpAt) / HAL_HX711_PERIOD_US;
+}
+
+void HX711::begin(uint8_t dout, uint8_t sck, uint8_t gain) {
+    (void)dout;
+    (void)sck;
+    (void)gain;
+    power_up();
+}
+
+bool HX711::is_ready() {
+    return !loadCellDown && conversionsDone() > conversionsRead;
+}
+
+// Waits for the next conversion, like the library
+long HX711::read() {
+    if (loadCellDown) return 0;
+    if (!is_ready()) {
+        unsigned long next = loadCellUpAt + (conversionsRead + 1) * HAL_HX711_PERIOD_US;
+        halAdvanceMicros(next - micros());
+    }
+    conversionsRead = conversionsDone();
+    return loadCellRaw;
+}
+
+long HX711::read_average(uint8_t times) {
+    long sum = 0;
+    for (uint8_t i = 0; i < times; i++) {
+        sum += read();
+    }
+    return times > 0 ? sum / times : 0;
+}
+
+double HX711::get_value(uint8_t times) {
+    return read_average(times) - offset;
+}
+
+float HX711::get_units(uint8_t times) {
+    return (float)(get_value(times) / scale);
+}
+
+void HX711::tare(uint8_t times) {
+    set_offset(read_average(times));
+}
+
+void HX711::power_down() {
+    loadCellDown = true;
+}
+
+void HX711::power_up() {
+    if (!loadCellDown && loadCellUpAt != 0) return;
+    loadCellDown = false;
+    loadCellUpAt = micros();
+    conversionsRead = 0;
+}
+
+void halSetLoadCellRaw(long raw) {
+    loadCellRaw = raw;
+}
+
+bool halIsLoadCellPoweredDown() {
+    return loadCellDown;
+}
+
+// === DHT22 ===
+
+struct FakeDht {
+    float temperature;
+    float humidity;
+    bool failing;
+    bool configured;
+};
+
+static FakeDht dhts[HAL_PIN_COUNT];
+
+static FakeDht& dhtAt(uint8_t pin) {
+    FakeDht& dht = dhts[pin < HAL_PIN_COUNT ? pin : 0];
+    if (!dht.configured) {
+        dht.temperature = 25.0f;
+        dht.humidity = 60.0f;
+        dht.failing = false;
+        dht.configured = true;
+    }
+    return dht;
+}
+
+bool DHT::read(bool force) {
+    (void)force;
+    halAdvanceMicros(HAL_DHT_CONVERSION_US);
+    return !dhtAt(pin).failing;
+}
+
+float DHT::readTemperature() {
+    const FakeDht& dht = dhtAt(pin);
+    return dht.failing ? NAN : dht.temperature;
+}
+
+float DHT::readHumidity() {
+    const FakeDht& dht = dhtAt(pin);
+    return dht.failing ? NAN : dht.humidity;
+}
+
+void halSetDhtReading(uint8_t pin, float temperature, float humidity) {
+    FakeDht& dht = dhtAt(pin);
+    dht.temperature = temperature;
+    dht.humidity = humidity;
+}
+
+void halSetDhtFailing(uint8_t pin, bool failing) {
+    dhtAt(pin).failing = failing;
+}
+
+#endif // NATIVE_BUILD
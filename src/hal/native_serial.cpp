@@ -0,0 +1,358 @@
+// String, Print and a paced Serial port for the host build; empty on the board.
+#ifdef NATIVE_BUILD
+
+#include "hal.h"
+#include <stdio.h>
+#include <string>
+
+// === String ===
+
+static HalHeapStats heapStats;
+
+static char* heapResize(char* buffer, unsigned int size) {
+    heapStats.allocations++;
+    heapStats.bytes += size;
+    return (char*)realloc(buffer, size);
+}
+
+String::String(const char* text) : buffer(NULL), len(0) {
+    append(text, strlen(text));
+}
+
+String::String(const String& other) : buffer(NULL), len(0) {
+    append(other.buffer, other.len);
+}
+
+String::String(char c) : buffer(NULL), len(0) {
+    append(&c, 1);
+}
+
+String::String(int value) : buffer(NULL), len(0) {
+    char text[12];
+    snprintf(text, sizeof(text), "%d", value);
+    append(text, strlen(text));
+}
+
+String::String(unsigned int value) : buffer(NULL), len(0) {
+    char text[12];
+    snprintf(text, sizeof(text), "%u", value);
+    append(text, strlen(text));
+}
+
+String::String(long value) : buffer(NULL), len(0) {
+    char text[24];
+    snprintf(text, sizeof(text), "%ld", value);
+    append(text, strlen(text));
+}
+
+String::String(unsigned long value) : buffer(NULL), len(0) {
+    char text[24];
+    snprintf(text, sizeof(text), "%lu", value);
+    append(text, strlen(text));
+}
+
+String::String(float value, unsigned char digits) : buffer(NULL), len(0) {
+    char text[48];
+    snprintf(text, sizeof(text), "%.*f", digits, (double)value);
+    append(text, strlen(text));
+}
+
+String::String(double value, unsigned char digits) : buffer(NULL), len(0) {
+    char text[48];
+    snprintf(text, sizeof(text), "%.*f", digits, value);
+    append(text, strlen(text));
+}
+
+String::~String() {
+    free(buffer);
+}
+
+String& String::operator=(const String& other) {
+    if (this != &other) {
+        len = 0;
+        append(other.buffer, other.len);
+    }
+    return *this;
+}
+
+String& String::operator+=(const String& other) {
+    append(other.buffer, other.len);
+    return *this;
+}
+
+String& String::operator+=(const char* text) {
+    append(text, strlen(text));
+    return *this;
+}
+
+String& String::operator+=(char c) {
+    append(&c, 1);
+    return *this;
+}
+
+// Like the core, every change of length reallocates
+void String::append(const char* text, unsigned int count) {
+    char* grown = heapResize(buffer, len + count + 1);
+    if (grown == NULL) return;
+    buffer = grown;
+    memmove(buffer + len, text, count);
+    len += count;
+    buffer[len] = '\0';
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (to > len) to = len;
+    String result;
+    if (from < to) result.append(buffer + from, to - from);
+    return result;
+}
+
+int String::indexOf(char c, unsigned int from) const {
+    for (unsigned int i = from; i < len; i++) {
+        if (buffer[i] == c) return (int)i;
+    }
+    return -1;
+}
+
+void String::trim() {
+    unsigned int start = 0;
+    while (start < len && (buffer[start] == ' ' || buffer[start] == '\t' || buffer[start] == '\r' || buffer[start] == '\n')) {
+        start++;
+    }
+    unsigned int end = len;
+    while (end > start && (buffer[end - 1] == ' ' || buffer[end - 1] == '\t' || buffer[end - 1] == '\r' || buffer[end - 1] == '\n')) {
+        end--;
+    }
+    memmove(buffer, buffer + start, end - start);
+    len = end - start;
+    buffer[len] = '\0';
+}
+
+long String::toInt() const {
+    return atol(buffer);
+}
+
+String operator+(const String& a, const String& b) {
+    String result(a);
+    result += b;
+    return result;
+}
+
+String operator+(const String& a, const char* b) {
+    String result(a);
+    result += b;
+    return result;
+}
+
+String operator+(const char* a, const String& b) {
+    String result(a);
+    result += b;
+    return result;
+}
+
+const HalHeapStats& halHeapStats() {
+    return heapStats;
+}
+
+void halResetHeapStats() {
+    heapStats.allocations = 0;
+    heapStats.bytes = 0;
+}
+
+// === Print ===
+
+size_t Print::write(const uint8_t* data, size_t length) {
+    size_t written = 0;
+    while (length--) {
+        written += write(*data++);
+    }
+    return written;
+}
+
+size_t Print::print(const __FlashStringHelper* text) {
+    return write(reinterpret_cast<const char*>(text));
+}
+
+size_t Print::print(const char* text) {
+    return write(text);
+}
+
+size_t Print::print(const String& text) {
+    return write((const uint8_t*)text.c_str(), text.length());
+}
+
+size_t Print::print(char c) {
+    return write((uint8_t)c);
+}
+
+size_t Print::print(unsigned char value, int base) {
+    return print((unsigned long)value, base);
+}
+
+size_t Print::print(int value, int base) {
+    return print((long)value, base);
+}
+
+size_t Print::print(unsigned int value, int base) {
+    return print((unsigned long)value, base);
+}
+
+size_t Print::print(long value, int base) {
+    if (base == DEC && value < 0) {
+        return print('-') + print((unsigned long)-value, base);
+    }
+    return print((unsigned long)value, base);
+}
+
+size_t Print::print(unsigned long value, int base) {
+    char text[24];
+    snprintf(text, sizeof(text), base == HEX ? "%lX" : "%lu", value);
+    return write(text);
+}
+
+// Same output as the core's printFloat
+size_t Print::print(double value, int digits) {
+    if (isnan(value)) return print("nan");
+    if (isinf(value)) return print("inf");
+    if (value > 4294967040.0 || value < -4294967040.0) return print("ovf");
+    char text[48];
+    snprintf(text, sizeof(text), "%.*f", digits, value);
+    return write(text);
+}
+
+size_t Print::println() {
+    return write("\r\n");
+}
+
+// === Serial ===
+
+HalSerial Serial;
+
+static unsigned long baudRate = 0;
+static uint8_t rxBytes[SERIAL_RX_BUFFER_SIZE];
+static uint8_t rxHead = 0;
+static uint8_t rxCount = 0;
+static uint32_t rxOverflows = 0;
+static uint16_t txPending = 0;            // Bytes in the TX buffer
+static unsigned long txUpdatedUs = 0;     // When txPending was last brought up to date
+static unsigned long blockedUs = 0;
+static std::string output;
+
+// The core's rings keep one slot free
+static const uint16_t kRxCapacity = SERIAL_RX_BUFFER_SIZE - 1;
+static const uint16_t kTxCapacity = SERIAL_TX_BUFFER_SIZE - 1;
+
+static unsigned long byteMicros() {
+    return baudRate > 0 ? 10000000UL / baudRate : 0;   // 10 bits per byte
+}
+
+// Remove what the UART has sent since the last update
+static void drainTx() {
+    unsigned long now = micros();
+    unsigned long perByte = byteMicros();
+    if (perByte == 0) {
+        txPending = 0;
+        txUpdatedUs = now;
+        return;
+    }
+    unsigned long sent = (now - txUpdatedUs) / perByte;
+    if (sent >= txPending) {
+        txPending = 0;
+        txUpdatedUs = now;
+    } else {
+        txPending -= (uint16_t)sent;
+        txUpdatedUs += sent * perByte;
+    }
+}
+
+void HalSerial::begin(unsigned long baud) {
+    baudRate = baud;
+    txPending = 0;
+    txUpdatedUs = micros();
+}
+
+void HalSerial::flush() {
+    drainTx();
+    if (txPending == 0) return;
+    unsigned long wait = txPending * byteMicros() - (micros() - txUpdatedUs);
+    halAdvanceMicros(wait);
+    drainTx();
+}
+
+int HalSerial::available() {
+    return rxCount;
+}
+
+int HalSerial::read() {
+    if (rxCount == 0) return -1;
+    uint8_t c = rxBytes[rxHead];
+    rxHead = (uint8_t)((rxHead + 1) % SERIAL_RX_BUFFER_SIZE);
+    rxCount--;
+    return c;
+}
+
+int HalSerial::availableForWrite() {
+    drainTx();
+    return kTxCapacity - txPending;
+}
+
+size_t HalSerial::write(uint8_t c) {
+    drainTx();
+    if (txPending >= kTxCapacity) {
+        // Full: the core spins until the UART has sent a byte
+        unsigned long wait = byteMicros() - (micros() - txUpdatedUs);
+        halAdvanceMicros(wait);
+        blockedUs += wait;
+        drainTx();
+    }
+    txPending++;
+    output.push_back((char)c);
+    return 1;
+}
+
+size_t HalSerial::write(const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        write(data[i]);
+    }
+    return length;
+}
+
+size_t halSerialInject(const char* text) {
+    size_t accepted = 0;
+    for (; *text != '\0'; text++) {
+        if (rxCount >= kRxCapacity) {
+            rxOverflows++;
+            continue;
+        }
+        rxBytes[(rxHead + rxCount) % SERIAL_RX_BUFFER_SIZE] = (uint8_t)*text;
+        rxCount++;
+        accepted++;
+    }
+    return accepted;
+}
+
+const char* halSerialOutput() {
+    return output.c_str();
+}
+
+size_t halSerialOutputLength() {
+    return output.size();
+}
+
+void halSerialClearOutput() {
+    output.clear();
+}
+
+unsigned long halSerialBaud() {
+    return baudRate;
+}
+
+uint32_t halSerialRxOverflows() {
+    return rxOverflows;
+}
+
+unsigned long halSerialBlockedMicros() {
+    return blockedUs;
+}
+
+#endif // NATIVE_BUILD
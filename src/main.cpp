@@ -1,11 +1,21 @@
 #include <Arduino.h>
 #include "sensor_service.h"
 #include "feeder_service.h"
+#include "task_scheduler.h"
+#include "perf_stats.h"
+#include "config_store.h"
+#include "power_manager.h"
+#include "serial_link.h"
+#include "serial_tx.h"
 
 void setup() {
-  Serial.begin(115200);
-  Serial.setTimeout(10);
+  // Host link at the default rate, announced with a capability report
+  initSerialLink();
   
+  // Load the stored configuration before anything that uses it
+  initConfigStore();
+  initPowerManager();
+
   // Initialize all sensors and devices
   initAllSensors();
   
@@ -15,15 +25,19 @@ void setup() {
   // Initialize feeder service (independent from sensor service)
   initFeederService();
   
-  Serial.println("[INFO] - System ready. Sensor service running in background, Feeder service ready for commands.");
+  SerialTx.println("[INFO] - System ready. Sensor service running in background, Feeder service ready for commands.");
+
+  // Boot messages were written directly; from here on output is queued
+  serialTxSetDirect(false);
 }
 
 void loop() {
-  // Handle control commands first for immediate responsiveness
-  if (Serial.available()) {
-    controlSensor();
-  } else {
-    // Update sensor service (non-blocking, time-sliced). Skips if commands are waiting
-    updateSensorService();
+  // Every piece of periodic work (command intake, HX711 sampling, telemetry)
+  // is a scheduler task registered by its service
+  {
+    PerfScope scope(PERF_LOOP);
+    runScheduler();
   }
+  // Sleep until the next interrupt; kept outside the loop timing
+  powerIdle();
 }
@@ -0,0 +1,111 @@
+#include "../../../include/adc_engine.h"
+#include "../../../include/power_monitor.h"
+#include "../../../include/soil_sensor.h"
+#include "../../../include/serial_tx.h"
+#include <util/atomic.h>
+
+static const uint8_t kAdcPins[ADC_ENGINE_CHANNELS] = {
+  LOAD_CURRENT_PIN,   // A0
+  LOAD_VOLTAGE_PIN,   // A1
+  SOIL_PIN,           // A2
+  SOLAR_VOLTAGE_PIN,  // A6
+  SOLAR_CURRENT_PIN   // A7
+};
+
+// Written by the ISR only
+static volatile uint8_t adcChannel = 0;
+static volatile uint8_t adcCount = 0;
+static volatile uint16_t adcAccum = 0;
+static volatile bool adcDiscardNext = true;
+static bool adcRunning = false;
+
+// Completed 64-sample sums, read by the foreground
+static volatile uint16_t adcSums[ADC_ENGINE_CHANNELS];
+
+static inline void adcSelect(uint8_t index) {
+  // AVcc reference; all channels are below A8 so MUX5 stays clear
+  ADMUX = (1 << REFS0) | ((kAdcPins[index] - A0) & 0x07);
+}
+
+ISR(ADC_vect) {
+  uint16_t value = ADC;
+
+  if (adcDiscardNext) {
+    // First conversion after a mux switch is not settled
+    adcDiscardNext = false;
+  } else {
+    adcAccum += value;
+    if (++adcCount >= ADC_OVERSAMPLE) {
+      uint8_t channel = adcChannel;
+      adcSums[channel] = adcAccum;
+      adcAccum = 0;
+      adcCount = 0;
+
+      channel = (channel + 1) % ADC_ENGINE_CHANNELS;
+      adcChannel = channel;
+      adcSelect(channel);
+      adcDiscardNext = true;
+    }
+  }
+
+  // Single-conversion mode restarted from here so a mux change takes effect
+  // cleanly on the next conversion
+  ADCSRA |= (1 << ADSC);
+}
+
+static int8_t adcIndexForPin(uint8_t pin) {
+  for (uint8_t i = 0; i < ADC_ENGINE_CHANNELS; i++) {
+    if (kAdcPins[i] == pin) return i;
+  }
+  return -1;
+}
+
+void initAdcEngine() {
+  // Digital input buffers are not needed on analog-only pins
+  for (uint8_t i = 0; i < ADC_ENGINE_CHANNELS; i++) {
+    DIDR0 |= (1 << (kAdcPins[i] - A0));
+  }
+
+  startAdcEngine();
+  SerialTx.println("[ADC] Background ADC engine started");
+}
+
+void startAdcEngine() {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    adcChannel = 0;
+    adcCount = 0;
+    adcAccum = 0;
+    adcDiscardNext = true;
+    adcSelect(0);
+    ADCSRB &= ~(1 << MUX5);
+    // Enable, interrupt on completion, prescaler 128 (125 kHz ADC clock)
+    ADCSRA = (1 << ADEN) | (1 << ADIE) | (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0);
+    ADCSRA |= (1 << ADSC);
+  }
+  adcRunning = true;
+}
+
+void stopAdcEngine() {
+  // Clearing ADEN abandons a conversion in progress, so no interrupt follows;
+  // the sums of the finished blocks stay readable
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    ADCSRA &= ~((1 << ADIE) | (1 << ADEN));
+    ADCSRA |= (1 << ADIF);  // Drop a completion flag raised just before
+  }
+  adcRunning = false;
+}
+
+bool isAdcEngineRunning() {
+  return adcRunning;
+}
+
+uint16_t adcReadSum(uint8_t pin) {
+  int8_t index = adcIndexForPin(pin);
+  if (index < 0) return 0;
+
+  uint16_t sum;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    sum = adcSums[index];
+  }
+  return sum;
+}
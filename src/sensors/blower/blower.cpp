@@ -1,4 +1,5 @@
 #include "../../../include/blower.h"
+#include <util/atomic.h>
 
 // กำหนดความเร็วเริ่มต้นของ Blower (0-255)
 int currentSpeed = 230;
@@ -7,10 +8,92 @@ bool isRunning = false;
 // กำหนดทิศทางการหมุนของ Blower (true = หมุนย้อนกลับ, false = หมุนปกติ)
 bool isReverse = false;
 
+// Ramp state, shared with the Timer5 ISR. Speeds are signed (negative =
+// reverse) and kept in Q8 so slow ramps still advance every tick.
+static volatile int32_t rampTargetQ8 = 0;
+static volatile int32_t rampOutputQ8 = 0;
+static volatile int32_t rampStepQ8 = 0;          // Per tick; 0 = jump
+static volatile uint8_t reverseDwellTicks = 0;
+static volatile int8_t lastDirection = 0;        // Sign of the last non-zero output
+static uint16_t rampRate = BLOWER_RAMP_DEFAULT_RATE;
+
+// PWM timers
+static volatile uint16_t pwmTop = 0;
+static uint32_t pwmFrequency = 0;
+
+static const uint8_t kReverseDwellTicks = BLOWER_REVERSE_DWELL_MS * BLOWER_RAMP_TICK_HZ / 1000;
+
+// Duty on one timer channel; at zero the compare output is disconnected so
+// the pin sits at its PORT level (low) instead of emitting a 1-tick spike
+static inline void writeChannel(volatile uint8_t& tccrA, uint8_t comBit, volatile uint16_t& ocr,
+                                uint8_t speed) {
+  if (speed == 0) {
+    tccrA &= ~(1 << comBit);
+    ocr = 0;
+  } else {
+    ocr = (uint16_t)(((uint32_t)speed * pwmTop) / 255);
+    tccrA |= (1 << comBit);
+  }
+}
+
+static inline void writeOutput(int16_t output) {
+  uint8_t forward = output > 0 ? (uint8_t)output : 0;
+  uint8_t reverse = output < 0 ? (uint8_t)(-output) : 0;
+  writeChannel(TCCR3A, COM3A1, OCR3A, forward);   // RPWM, pin 5
+  writeChannel(TCCR4A, COM4A1, OCR4A, reverse);   // LPWM, pin 6
+}
+
+ISR(TIMER5_COMPA_vect) {
+  int32_t output = rampOutputQ8;
+  int32_t target = rampTargetQ8;
+  if (output == target) return;
+
+  if (output == 0 && target != 0) {
+    int8_t direction = target > 0 ? 1 : -1;
+    if (direction != lastDirection && reverseDwellTicks > 0) {
+      // Let the motor spin down before driving it the other way
+      reverseDwellTicks--;
+      return;
+    }
+    lastDirection = direction;
+  }
+
+  // Never move across zero in one tick, so the dwell check always runs
+  int32_t limit = ((output < 0 && target > 0) || (output > 0 && target < 0)) ? 0 : target;
+  int32_t step = rampStepQ8;
+  if (step == 0) {
+    output = limit;
+  } else if (output < limit) {
+    output = (limit - output > step) ? output + step : limit;
+  } else {
+    output = (output - limit > step) ? output - step : limit;
+  }
+  if (output == 0) reverseDwellTicks = kReverseDwellTicks;
+
+  rampOutputQ8 = output;
+  writeOutput((int16_t)(output >> 8));
+}
+
+static void startRampTimer() {
+  // CTC on OCR5A, prescaler 64: 250 kHz / BLOWER_RAMP_TICK_HZ
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    TCCR5A = 0;
+    TCCR5B = (1 << WGM52) | (1 << CS51) | (1 << CS50);
+    OCR5A = (uint16_t)(F_CPU / 64 / BLOWER_RAMP_TICK_HZ - 1);
+    TCNT5 = 0;
+    TIMSK5 |= (1 << OCIE5A);
+  }
+}
+
 // ฟังก์ชันเริ่มต้น กำหนดโหมดขา PWM สำหรับควบคุม Blower
 void initBlower() {
+  digitalWrite(RPWM, LOW);
+  digitalWrite(LPWM, LOW);
   pinMode(RPWM, OUTPUT);
   pinMode(LPWM, OUTPUT);
+  setBlowerPwmFrequency(BLOWER_PWM_DEFAULT_HZ);
+  setBlowerRampRate(rampRate);
+  startRampTimer();
 }
 
 // ฟังก์ชันเริ่มการทำงานของ Blower
@@ -40,21 +123,68 @@ void setBlowerDirection(bool reverse) {
 }
 
 // ฟังก์ชันอัปเดตสถานะของ Blower ตามค่าปัจจุบัน
+// Only sets the target; the ramp ISR moves the outputs
 void updateBlower() {
-  Serial.println("updateBlower");
-  Serial.println(isRunning);
-  Serial.println(isReverse);
-  Serial.println(currentSpeed);
+  int32_t target = 0;
   if (isRunning) {
-    if (isReverse) {
-      analogWrite(LPWM, currentSpeed); // หมุนย้อนกลับ
-      analogWrite(RPWM, 0);
-    } else {
-      analogWrite(RPWM, currentSpeed); // หมุนปกติ
-      analogWrite(LPWM, 0);
-    }
-  } else {
-    analogWrite(RPWM, 0); // หยุดการทำงาน
-    analogWrite(LPWM, 0);
+    target = (int32_t)currentSpeed << 8;
+    if (isReverse) target = -target;   // หมุนย้อนกลับ
+  }
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    rampTargetQ8 = target;
+  }
+}
+
+void setBlowerRampRate(uint16_t unitsPerSecond) {
+  rampRate = unitsPerSecond;
+  int32_t step = ((int32_t)unitsPerSecond << 8) / BLOWER_RAMP_TICK_HZ;
+  if (unitsPerSecond > 0 && step == 0) step = 1;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    rampStepQ8 = step;
+  }
+}
+
+uint16_t getBlowerRampRate() {
+  return rampRate;
+}
+
+uint32_t setBlowerPwmFrequency(uint32_t hz) {
+  if (hz < BLOWER_PWM_MIN_HZ || hz > BLOWER_PWM_MAX_HZ) return 0;
+
+  // Prescaler 1 down to 245 Hz, 8 below that
+  uint8_t clockSelect = (1 << CS30);
+  uint32_t clock = F_CPU;
+  if (F_CPU / hz > 65536UL) {
+    clockSelect = (1 << CS31);
+    clock = F_CPU / 8;
+  }
+  uint16_t top = (uint16_t)(clock / hz - 1);
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    pwmTop = top;
+    // Fast PWM, TOP = ICRn (mode 14); compare outputs are set per channel
+    TCCR3A = (TCCR3A & (1 << COM3A1)) | (1 << WGM31);
+    TCCR3B = (1 << WGM33) | (1 << WGM32) | clockSelect;
+    ICR3 = top;
+    TCNT3 = 0;
+    TCCR4A = (TCCR4A & (1 << COM4A1)) | (1 << WGM41);
+    TCCR4B = (1 << WGM43) | (1 << WGM42) | clockSelect;
+    ICR4 = top;
+    TCNT4 = 0;
+    writeOutput((int16_t)(rampOutputQ8 >> 8));
+  }
+  pwmFrequency = clock / ((uint32_t)top + 1);
+  return pwmFrequency;
+}
+
+uint32_t getBlowerPwmFrequency() {
+  return pwmFrequency;
+}
+
+int getBlowerOutput() {
+  int32_t output;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    output = rampOutputQ8;
   }
+  return (int)(output >> 8);
 }
@@ -1,69 +1,144 @@
 #include "../../../include/feeder_motor.h"
+#include "../../../include/serial_tx.h"
+#ifndef NATIVE_BUILD
+#include <util/atomic.h>
+#endif
 
 // Fixed full speed for feeder motor driving
 static const int FEEDER_MOTOR_SPEED = 255;
 
-// Safe reverse delay to protect driver
-static const uint16_t FEEDER_MOTOR_REVERSE_DELAY_MS = 150;
-
 // Track last direction
 enum FeederMotorDir { FM_STOP_DIR = 0, FM_CW_DIR, FM_CCW_DIR };
-static FeederMotorDir feederMotorLastDir = FM_STOP_DIR;
+static FeederMotorDir feederMotorLastDir = FM_STOP_DIR;   // Last direction driven
+static unsigned long lastDriveEndedAt = 0;
 
-static void feederMotorStopInternal() {
-    analogWrite(FM_RPWM, 0);
-    analogWrite(FM_LPWM, 0);
-    feederMotorLastDir = FM_STOP_DIR;
+// Pulse in progress or waiting for the dead time
+static FeederMotorState motorState = FEEDER_MOTOR_IDLE;
+static FeederMotorDir pulseDir = FM_STOP_DIR;
+static uint16_t pulseMs = 0;
+static unsigned long deadlineAt = 0;   // End of the dead time or of the pulse
+static unsigned long pulseStartedAt = 0;
+
+// Pin 8 is OC4C. analogWrite() and turnOffPWM() update TCCR4A with a
+// read-modify-write, and so does the blower's Timer5 ramp ISR (OC4A, pin 6);
+// an ISR landing in between would have its change undone. Mask interrupts
+// around the pin writes.
+static void feederMotorOutputsOff() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        analogWrite(FM_RPWM, 0);
+        analogWrite(FM_LPWM, 0);
+    }
 }
 
 static void feederMotorCW() {
-    analogWrite(FM_RPWM, FEEDER_MOTOR_SPEED);
-    analogWrite(FM_LPWM, 0);
-    feederMotorLastDir = FM_CW_DIR;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        analogWrite(FM_RPWM, FEEDER_MOTOR_SPEED);
+        analogWrite(FM_LPWM, 0);
+    }
 }
 
 static void feederMotorCCW() {
-    analogWrite(FM_RPWM, 0);
-    analogWrite(FM_LPWM, FEEDER_MOTOR_SPEED);
-    feederMotorLastDir = FM_CCW_DIR;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        analogWrite(FM_RPWM, 0);
+        analogWrite(FM_LPWM, FEEDER_MOTOR_SPEED);
+    }
 }
 
-static void feederMotorSafeSet(FeederMotorDir target) {
-    if ((feederMotorLastDir == FM_CW_DIR && target == FM_CCW_DIR) ||
-        (feederMotorLastDir == FM_CCW_DIR && target == FM_CW_DIR)) {
-        feederMotorStopInternal();
-        delay(FEEDER_MOTOR_REVERSE_DELAY_MS);
+static const char* dirName(FeederMotorDir dir) {
+    return dir == FM_CW_DIR ? "open" : "close";
+}
+
+static void startPulse() {
+    if (pulseDir == FM_CW_DIR) {
+        feederMotorCW();
+    } else {
+        feederMotorCCW();
     }
-    switch (target) {
-        case FM_CW_DIR: feederMotorCW(); break;
-        case FM_CCW_DIR: feederMotorCCW(); break;
-        default: feederMotorStopInternal(); break;
+    feederMotorLastDir = pulseDir;
+    pulseStartedAt = millis();
+    deadlineAt = pulseStartedAt + pulseMs;
+    motorState = FEEDER_MOTOR_PULSE;
+}
+
+// Outputs off; the dead time for a reversal counts from here
+static void endDrive() {
+    feederMotorOutputsOff();
+    if (motorState == FEEDER_MOTOR_PULSE) {
+        lastDriveEndedAt = millis();
+    }
+    motorState = FEEDER_MOTOR_IDLE;
+}
+
+static void requestPulse(FeederMotorDir dir, uint16_t lengthMs) {
+    if (lengthMs > FEEDER_MOTOR_MAX_PULSE_MS) lengthMs = FEEDER_MOTOR_MAX_PULSE_MS;
+
+    bool reversing = feederMotorLastDir != FM_STOP_DIR && feederMotorLastDir != dir;
+    if (reversing) {
+        endDrive();
+    }
+    pulseDir = dir;
+    pulseMs = lengthMs;
+
+    unsigned long sinceDrive = millis() - lastDriveEndedAt;
+    if (reversing && sinceDrive < FEEDER_MOTOR_REVERSE_DELAY_MS) {
+        // Protect the driver: wait out the dead time in updateFeederMotor()
+        deadlineAt = lastDriveEndedAt + FEEDER_MOTOR_REVERSE_DELAY_MS;
+        motorState = FEEDER_MOTOR_DEAD_TIME;
+    } else {
+        // Same direction restarts the pulse from now
+        startPulse();
     }
 }
 
 void initFeederMotor() {
     pinMode(FM_RPWM, OUTPUT);
     pinMode(FM_LPWM, OUTPUT);
-    feederMotorStopInternal();
+    feederMotorOutputsOff();
+    motorState = FEEDER_MOTOR_IDLE;
+    feederMotorLastDir = FM_STOP_DIR;
+}
+
+void updateFeederMotor() {
+    if (motorState == FEEDER_MOTOR_IDLE) return;
+    if ((long)(millis() - deadlineAt) < 0) return;
+
+    if (motorState == FEEDER_MOTOR_DEAD_TIME) {
+        startPulse();
+        return;
+    }
+
+    endDrive();
+    SerialTx.print(F("[EVENT] - feedermotor:"));
+    SerialTx.print(dirName(pulseDir));
+    SerialTx.print(F(":done:"));
+    SerialTx.println(millis() - pulseStartedAt);
 }
 
 // Open: rotate CW at full speed
-void feederMotorOpen() {
-    feederMotorSafeSet(FM_CW_DIR);
-    delay(300);
-    feederMotorStop();
+void feederMotorOpen(uint16_t lengthMs) {
+    requestPulse(FM_CW_DIR, lengthMs);
 }
 
 // Close: rotate CCW at full speed
-void feederMotorClose() {
-    feederMotorSafeSet(FM_CCW_DIR);
-    delay(300);
-    feederMotorStop();
+void feederMotorClose(uint16_t lengthMs) {
+    requestPulse(FM_CCW_DIR, lengthMs);
 }
 
 // Public stop function (exposed via header)
 void feederMotorStop() {
-    feederMotorStopInternal();
+    bool wasBusy = motorState != FEEDER_MOTOR_IDLE;
+    endDrive();
+    if (wasBusy) {
+        SerialTx.print(F("[EVENT] - feedermotor:"));
+        SerialTx.print(dirName(pulseDir));
+        SerialTx.println(F(":stopped"));
+    }
 }
 
+FeederMotorState getFeederMotorState() {
+    return motorState;
+}
 
+bool isFeederMotorBusy() {
+    return motorState != FEEDER_MOTOR_IDLE;
+}
@@ -1,5 +1,6 @@
-#include <Arduino.h>
+#include "hal.h"
 #include "relay_control.h"
+#include "serial_tx.h"
 
 // Global variables for relay state
 static bool relayUsedLoad = false;
@@ -13,13 +14,13 @@ void initRelayControl() {
     digitalWrite(RELAY_IN2, HIGH); // Turn off initially (relay is active LOW)
     relayUsedLoad = false;
     freezeBattery = false;
-    Serial.println("[RELAY] Relay control initialized");
+    SerialTx.println("[RELAY] Relay control initialized");
 }
 
 void relayLedOn() {
     digitalWrite(RELAY_IN1, LOW);  // Turn ON pond LED light (relay active LOW)
     freezeBattery = true;
-    Serial.println("[RELAY] LED light ON (pond lighting)");
+    SerialTx.println("[RELAY] LED light ON (pond lighting)");
 }
 
 void relayLedOff() {
@@ -30,7 +31,7 @@ void relayLedOff() {
         freezeBattery = false;
     }
     relayStopTime = millis();
-    Serial.println("[RELAY] LED light OFF");
+    SerialTx.println("[RELAY] LED light OFF");
 }
 
 void relayFanOn() {
@@ -38,7 +39,7 @@ void relayFanOn() {
     relayUsedLoad = true;
     relayStopTime = millis();
     freezeBattery = true;
-    Serial.println("[RELAY] Control box fan ON");
+    SerialTx.println("[RELAY] Control box fan ON");
 }
 
 void relayFanOff() {
@@ -49,7 +50,7 @@ void relayFanOff() {
         freezeBattery = false;
     }
     relayStopTime = millis();
-    Serial.println("[RELAY] Control box fan OFF");
+    SerialTx.println("[RELAY] Control box fan OFF");
 }
 
 void relayAllOff() {
@@ -58,5 +59,5 @@ void relayAllOff() {
     relayUsedLoad = false;
     relayStopTime = millis();
     freezeBattery = false;
-    Serial.println("[RELAY] All relays OFF");
+    SerialTx.println("[RELAY] All relays OFF");
 } 
\ No newline at end of file
@@ -1,29 +1,87 @@
-#include "../../../include/soil_sensor.h"
-
-void initSoil() {
-  // ไม่ต้องตั้งค่า pinMode สำหรับ analogRead
-  Serial.println("🌱 เริ่มระบบอ่านค่าความชื้นในดิน...");
-}
-
-StaticJsonDocument<256> readSoil() {
-  StaticJsonDocument<256> doc;
-  doc["name"] = SOIL_SENSOR;
-  JsonArray values = doc.createNestedArray("value");
-
-  int soilRaw = analogRead(SOIL_PIN);
-  
-  // ใช้ค่าที่วัดจริง
-  int DRY_ADC = 1023;  // แห้งสนิท
-  int WET_ADC = 950;   // จุ่มน้ำเต็มที่
-
-  int soilMoisture = map(soilRaw, DRY_ADC, WET_ADC, 0, 100);
-  if (soilMoisture < 0) soilMoisture = 0;
-  if (soilMoisture > 100) soilMoisture = 100;
-
-  JsonObject moistureValue = values.createNestedObject();
-  moistureValue["type"] = "soil_moisture";
-  moistureValue["unit"] = "%";
-  moistureValue["value"] = soilMoisture;
-
-  return doc;
-}
+#include "../../../include/soil_sensor.h"
+#include "../../../include/adc_engine.h"
+#include "../../../include/fixed_point.h"
+#include "../../../include/serial_tx.h"
+
+#if SOIL_POWER_PIN >= 0
+static bool powerSave = false;
+static bool probePowered = true;
+static unsigned long powerCycleMs = 0;
+static unsigned long poweredAt = 0;
+static SoilReading lastReading = {0, 0};
+
+static void setProbePower(bool on) {
+  digitalWrite(SOIL_POWER_PIN, on ? HIGH : LOW);
+  probePowered = on;
+  if (on) poweredAt = millis();
+}
+#endif
+
+void initSoil() {
+  // ไม่ต้องตั้งค่า pinMode สำหรับ analogRead
+#if SOIL_POWER_PIN >= 0
+  pinMode(SOIL_POWER_PIN, OUTPUT);
+  setProbePower(true);
+#endif
+  SerialTx.println("🌱 เริ่มระบบอ่านค่าความชื้นในดิน...");
+}
+
+static SoilReading sampleSoil() {
+  // Oversampled average from the background ADC engine
+  int soilRaw = fixedRoundShift(adcReadSum(SOIL_PIN), ADC_OVERSAMPLE_SHIFT);
+  
+  // ใช้ค่าที่วัดจริง
+  int DRY_ADC = 1023;  // แห้งสนิท
+  int WET_ADC = 950;   // จุ่มน้ำเต็มที่
+
+  int soilMoisture = map(soilRaw, DRY_ADC, WET_ADC, 0, 100);
+  if (soilMoisture < 0) soilMoisture = 0;
+  if (soilMoisture > 100) soilMoisture = 100;
+
+  SoilReading reading;
+  reading.moisture = soilMoisture;
+  reading.timestamp = millis();
+  return reading;
+}
+
+SoilReading readSoil() {
+#if SOIL_POWER_PIN >= 0
+  if (powerSave) return lastReading;
+#endif
+  return sampleSoil();
+}
+
+void setSoilPowerSave(bool enabled, unsigned long cycleMs) {
+#if SOIL_POWER_PIN >= 0
+  powerSave = enabled;
+  powerCycleMs = cycleMs;
+#else
+  (void)enabled;
+  (void)cycleMs;
+#endif
+}
+
+void updateSoilPower() {
+#if SOIL_POWER_PIN >= 0
+  if (!powerSave) {
+    if (!probePowered) setProbePower(true);
+    return;
+  }
+
+  unsigned long now = millis();
+  if (!probePowered) {
+    if (now - lastReading.timestamp >= powerCycleMs - SOIL_SETTLE_MS) setProbePower(true);
+  } else if (now - poweredAt >= SOIL_SETTLE_MS) {
+    lastReading = sampleSoil();
+    setProbePower(false);
+  }
+#endif
+}
+
+bool isSoilProbeSampling() {
+#if SOIL_POWER_PIN >= 0
+  return powerSave && probePowered;
+#else
+  return false;
+#endif
+}
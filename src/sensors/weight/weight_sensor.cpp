@@ -1,95 +1,206 @@
 #include "../../../include/weight_sensor.h"
+#include "../../../include/ring_buffer.h"
+#include "../../../include/config_store.h"
+#include "../../../include/fixed_point.h"
+#include "../../../include/serial_tx.h"
 
 HX711 scale;
+static float scaleFactor = FIXED_SCALE_FACTOR;
+// 1e6 / scaleFactor in Q16.16, recomputed only when the factor changes so
+// reads stay in integer math
+static int32_t mgPerCountQ16 = 0;
+
+static bool isScaleFactorInRange(float factor) {
+  float magnitude = fabsf(factor);
+  return magnitude >= WEIGHT_SCALE_FACTOR_MIN && magnitude <= WEIGHT_SCALE_FACTOR_MAX;
+}
+
+static void applyScaleFactor(float factor) {
+  scaleFactor = factor;
+  scale.set_scale(scaleFactor);
+  mgPerCountQ16 = (int32_t)(1.0e6f / scaleFactor * 65536.0f);
+}
+
+// Raw HX711 counts; offset and scale are applied on read so a tare does not
+// invalidate samples already in the buffer
+static RingBuffer<long, WEIGHT_RING_SIZE> weightSamples;
+static unsigned long weightSampleCount = 0;
+
+// Power gating state (see setWeightPowerSave)
+static bool powerSave = false;
+static bool powerHold = false;
+static bool poweredDown = false;
+static unsigned long powerCycleMs = 0;
+static unsigned long burstStartedAt = 0;
+static uint8_t settleSamples = 0;    // Conversions still to discard
+static uint8_t burstSamples = 0;     // Samples kept in this burst
+
+static void wakeHx711() {
+  scale.power_up();
+  poweredDown = false;
+  settleSamples = WEIGHT_SETTLE_SAMPLES;
+  burstSamples = 0;
+  burstStartedAt = millis();
+}
 
 void initWeight() {
-  Serial.println("📦 เริ่มต้นระบบชั่งน้ำหนัก...");
+  SerialTx.println("📦 เริ่มต้นระบบชั่งน้ำหนัก...");
   
   scale.begin(LOADCELL_DOUT_PIN, LOADCELL_SCK_PIN);
-  scale.set_scale(FIXED_SCALE_FACTOR);
-  
-  // Read offset from EEPROM
+  // Scale factor and offset from the config store (see config_store.h)
+  float storedScale;
+  if (configGetFloat(CONFIG_KEY_SCALE_FACTOR, storedScale) && isScaleFactorInRange(storedScale)) {
+    scaleFactor = storedScale;
+  }
+  applyScaleFactor(scaleFactor);
+
   long storedOffset;
-  EEPROM.get(EEPROM_OFFSET_ADDR, storedOffset);
-  
-  // Check if valid offset exists (not default EEPROM value)
-  if (storedOffset != -1 && storedOffset != 0xFFFFFFFF) {
+  if (configGetLong(CONFIG_KEY_TARE_OFFSET, storedOffset)) {
     scale.set_offset(storedOffset);
-    Serial.print("📏 โหลดค่า offset จาก EEPROM: ");
-    Serial.println(storedOffset);
+    SerialTx.print("📏 โหลดค่า offset จาก EEPROM: ");
+    SerialTx.println(storedOffset);
   } else {
-    Serial.println("⚠️  ไม่พบค่า offset ใน EEPROM - ใช้ค่าเริ่มต้น");
+    SerialTx.println("⚠️  ไม่พบค่า offset ใน EEPROM - ใช้ค่าเริ่มต้น");
   }
   
-  Serial.println("✅ ระบบชั่งน้ำหนักพร้อมใช้งาน");
+  SerialTx.println("✅ ระบบชั่งน้ำหนักพร้อมใช้งาน");
+}
+
+WeightReading readWeight() {
+  WeightReading reading;
+  reading.weightMg = readWeightMg(WEIGHT_AVERAGE_SAMPLES);
+  reading.timestamp = millis();
+  return reading;
+}
+
+void updateWeightSampler() {
+  if (poweredDown) {
+    if (!powerSave || powerHold || millis() - burstStartedAt >= powerCycleMs) {
+      wakeHx711();
+    }
+    return;
+  }
+
+  // DOUT low means a conversion is waiting, so read() will not block
+  if (!scale.is_ready()) return;
+  long raw = scale.read();
+  if (settleSamples > 0) {
+    settleSamples--;
+    return;
+  }
+  weightSamples.pushOverwrite(raw);
+  weightSampleCount++;
+
+  if (!powerSave || powerHold) return;
+  if (++burstSamples >= WEIGHT_AVERAGE_SAMPLES) {
+    scale.power_down();
+    poweredDown = true;
+  }
+}
+
+void setWeightPowerSave(bool enabled, unsigned long cycleMs) {
+  powerSave = enabled;
+  powerCycleMs = cycleMs;
 }
 
-StaticJsonDocument<256> readWeight() {
-  StaticJsonDocument<256> doc;
-  doc["name"] = WEIGHT_SENSOR;
-  JsonArray values = doc.createNestedArray("value");
+void setWeightPowerHold(bool hold) {
+  powerHold = hold;
+}
 
-  float weight = scale.get_units(20);
+bool isWeightPoweredDown() {
+  return poweredDown;
+}
 
-  JsonObject weightValue = values.createNestedObject();
-  weightValue["type"] = "weight";
-  weightValue["unit"] = "kg";
-  weightValue["value"] = round(weight * 1000.0) / 1000.0;
+long readWeightMg(uint8_t samples) {
+  uint8_t available = weightSamples.size();
+  if (samples > available) samples = available;
+  if (samples == 0) return 0;
 
-  return doc;
+  long sum = 0;
+  for (uint8_t i = 0; i < samples; i++) {
+    sum += weightSamples.recent(i);
+  }
+  long average = sum / samples;
+  return fixedMulQ16(average - scale.get_offset(), mgPerCountQ16);
+}
+
+unsigned long getWeightSampleCount() {
+  return weightSampleCount;
+}
+
+bool setWeightScaleFactor(float factor) {
+  if (!isScaleFactorInRange(factor)) return false;
+  applyScaleFactor(factor);
+  configSetFloat(CONFIG_KEY_SCALE_FACTOR, scaleFactor);
+  return true;
+}
+
+float getWeightScaleFactor() {
+  return scaleFactor;
 }
 
 void calibrateWeight() {
-  Serial.println("🔧 HX711 Weight Calibration");
-  Serial.println("📏 กำลังเริ่มต้นระบบ scale...");
+  // Calibration blocks on the HX711 anyway; print without the queue so the
+  // long report is not cut short
+  serialTxSetDirect(true);
+  SerialTx.println("🔧 HX711 Weight Calibration");
+  if (poweredDown) {
+    wakeHx711();
+    for (uint8_t i = 0; i < WEIGHT_SETTLE_SAMPLES; i++) {
+      scale.read();                               // let the ADC settle before taring
+    }
+  }
+  SerialTx.println("📏 กำลังเริ่มต้นระบบ scale...");
 
-  Serial.println("📊 ข้อมูลก่อนการตั้งค่า scale:");
-  Serial.print("   ↪ read: \t\t");
-  Serial.println(scale.read());			// print a raw reading from the ADC
+  SerialTx.println("📊 ข้อมูลก่อนการตั้งค่า scale:");
+  SerialTx.print("   ↪ read: \t\t");
+  SerialTx.println(scale.read());			// print a raw reading from the ADC
 
-  Serial.print("   ↪ read average: \t");
-  Serial.println(scale.read_average(20));  	// print the average of 20 readings from the ADC
+  SerialTx.print("   ↪ read average: \t");
+  SerialTx.println(scale.read_average(20));  	// print the average of 20 readings from the ADC
 
-  Serial.print("   ↪ get value: \t\t");
-  Serial.println(scale.get_value(5));		// print the average of 5 readings from the ADC minus the tare weight (not set yet)
+  SerialTx.print("   ↪ get value: \t\t");
+  SerialTx.println(scale.get_value(5));		// print the average of 5 readings from the ADC minus the tare weight (not set yet)
 
-  Serial.print("   ↪ get units: \t\t");
-  Serial.println(scale.get_units(5), 1);	// print the average of 5 readings from the ADC minus tare weight (not set) divided
+  SerialTx.print("   ↪ get units: \t\t");
+  SerialTx.println(scale.get_units(5), 1);	// print the average of 5 readings from the ADC minus tare weight (not set) divided
 						// by the SCALE parameter (not set yet)
 
   // Set scale factor and tare
-  scale.set_scale(FIXED_SCALE_FACTOR);          // set scale factor to fixed value
+  scale.set_scale(scaleFactor);                 // set scale factor to the stored value
   scale.tare();				        // reset the scale to 0
   
-  // Get and save offset to EEPROM
+  // Get and save offset and scale factor to EEPROM
   long currentOffset = scale.get_offset();
-  EEPROM.put(EEPROM_OFFSET_ADDR, currentOffset);
+  configSetLong(CONFIG_KEY_TARE_OFFSET, currentOffset);
+  configSetFloat(CONFIG_KEY_SCALE_FACTOR, scaleFactor);
   
-  Serial.print("💾 บันทึกค่า offset ลง EEPROM: ");
-  Serial.println(currentOffset);
+  SerialTx.print("💾 บันทึกค่า offset ลง EEPROM: ");
+  SerialTx.println(currentOffset);
 
-  Serial.println("✅ หลังจากตั้งค่า scale:");
-  Serial.print("   ↪ read: \t\t");
-  Serial.println(scale.read());                 // print a raw reading from the ADC
+  SerialTx.println("✅ หลังจากตั้งค่า scale:");
+  SerialTx.print("   ↪ read: \t\t");
+  SerialTx.println(scale.read());                 // print a raw reading from the ADC
 
-  Serial.print("   ↪ read average: \t");
-  Serial.println(scale.read_average(20));       // print the average of 20 readings from the ADC
+  SerialTx.print("   ↪ read average: \t");
+  SerialTx.println(scale.read_average(20));       // print the average of 20 readings from the ADC
 
-  Serial.print("   ↪ get value: \t\t");
-  Serial.println(scale.get_value(5));		// print the average of 5 readings from the ADC minus the tare weight, set with tare()
+  SerialTx.print("   ↪ get value: \t\t");
+  SerialTx.println(scale.get_value(5));		// print the average of 5 readings from the ADC minus the tare weight, set with tare()
 
-  Serial.print("   ↪ get units: \t\t");
-  Serial.println(scale.get_units(5), 1);        // print the average of 5 readings from the ADC minus tare weight, divided
+  SerialTx.print("   ↪ get units: \t\t");
+  SerialTx.println(scale.get_units(5), 1);        // print the average of 5 readings from the ADC minus tare weight, divided
 						// by the SCALE parameter set with set_scale
 
-  Serial.println("🎯 การตั้งค่า scale เสร็จสิ้น!");
-  Serial.print("📏 Scale Factor: ");
-  Serial.println(FIXED_SCALE_FACTOR, 1);
+  SerialTx.println("🎯 การตั้งค่า scale เสร็จสิ้น!");
+  SerialTx.print("📏 Scale Factor: ");
+  SerialTx.println(scaleFactor, 1);
   
   // Test readings
-  Serial.println("🧪 ทดสอบการอ่านค่า:");
-  Serial.print("   ↪ one reading:\t");
-  Serial.print(scale.get_units(), 1);
-  Serial.print("\t| average:\t");
-  Serial.println(scale.get_units(10), 1);
+  SerialTx.println("🧪 ทดสอบการอ่านค่า:");
+  SerialTx.print("   ↪ one reading:\t");
+  SerialTx.print(scale.get_units(), 1);
+  SerialTx.print("\t| average:\t");
+  SerialTx.println(scale.get_units(10), 1);
+  serialTxSetDirect(false);
 }
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include "command_parser.h"
+
+void commandLineReset(CommandLineBuffer& line) {
+    line.length = 0;
+    line.overflow = false;
+    line.data[0] = '\0';
+}
+
+bool commandLineFeed(CommandLineBuffer& line, char c) {
+    if (c == '\r') return false;
+
+    if (c != '\n') {
+        if (line.length >= COMMAND_LINE_SIZE - 1) {
+            // Too long: keep discarding until the end of the line
+            line.overflow = true;
+            return false;
+        }
+        // Skip leading whitespace
+        if (line.length == 0 && (c == ' ' || c == '\t')) return false;
+        line.data[line.length++] = c;
+        return false;
+    }
+
+    // End of line: trim trailing whitespace
+    while (line.length > 0 && (line.data[line.length - 1] == ' ' || line.data[line.length - 1] == '\t')) {
+        line.length--;
+    }
+    line.data[line.length] = '\0';
+    return true;
+}
+
+char* commandNextToken(char*& cursor) {
+    if (cursor == NULL || *cursor == '\0') return NULL;
+
+    char* token = cursor;
+    char* sep = strchr(cursor, ':');
+    if (sep != NULL) {
+        *sep = '\0';
+        cursor = sep + 1;
+    } else {
+        cursor += strlen(cursor);
+    }
+    return token;
+}
+
+bool commandParseLong(const char* text, long& value) {
+    if (text == NULL || *text == '\0') return false;
+    char* end;
+    value = strtol(text, &end, 10);
+    return *end == '\0';
+}
+
+int8_t commandParseLongList(char* text, long* values, uint8_t maxValues) {
+    uint8_t count = 0;
+    char* cursor = text;
+    while (cursor != NULL && *cursor != '\0' && count < maxValues) {
+        char* comma = strchr(cursor, ',');
+        if (comma != NULL) *comma = '\0';
+        if (!commandParseLong(cursor, values[count])) return -1;
+        count++;
+        cursor = (comma != NULL) ? comma + 1 : NULL;
+    }
+    return (int8_t)count;
+}
+
+CommandResult dispatchCommand(char* line, const CommandEntry* table, uint8_t tableSize,
+                              char*& device) {
+    device = NULL;
+    if (strncmp(line, COMMAND_PREFIX, COMMAND_PREFIX_LEN) != 0) return COMMAND_IGNORED;
+
+    char* cursor = line + COMMAND_PREFIX_LEN;
+    device = commandNextToken(cursor);
+    char* verb = commandNextToken(cursor);
+    if (device == NULL || verb == NULL) return COMMAND_IGNORED;
+
+    bool deviceKnown = false;
+    for (uint8_t i = 0; i < tableSize; i++) {
+        CommandEntry entry;
+        memcpy_P(&entry, &table[i], sizeof(entry));
+        if (strcmp_P(device, entry.device) != 0) continue;
+        deviceKnown = true;
+        if (strcmp_P(verb, entry.verb) != 0) continue;
+
+        entry.handler(cursor);
+        return COMMAND_OK;
+    }
+    return deviceKnown ? COMMAND_UNKNOWN_VERB : COMMAND_UNKNOWN_DEVICE;
+}
+
+// Length of the ':'-terminated token at text
+static uint8_t tokenLength(const char* text) {
+    const char* sep = strchr(text, ':');
+    return (uint8_t)(sep != NULL ? sep - text : strlen(text));
+}
+
+static bool tokenMatches(const char* token, uint8_t length, const char* name) {
+    return strlen_P(name) == length && strncmp_P(token, name, length) == 0;
+}
+
+int8_t findCommand(const char* line, const CommandEntry* table, uint8_t tableSize) {
+    if (strncmp(line, COMMAND_PREFIX, COMMAND_PREFIX_LEN) != 0) return -1;
+
+    const char* device = line + COMMAND_PREFIX_LEN;
+    uint8_t deviceLength = tokenLength(device);
+    if (device[deviceLength] != ':') return -1;
+    const char* verb = device + deviceLength + 1;
+    uint8_t verbLength = tokenLength(verb);
+
+    for (uint8_t i = 0; i < tableSize; i++) {
+        CommandEntry entry;
+        memcpy_P(&entry, &table[i], sizeof(entry));
+        if (tokenMatches(device, deviceLength, entry.device) &&
+            tokenMatches(verb, verbLength, entry.verb)) {
+            return (int8_t)i;
+        }
+    }
+    return -1;
+}
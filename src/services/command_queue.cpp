@@ -0,0 +1,44 @@
+#include "command_queue.h"
+
+void commandQueueReset(CommandQueue& queue) {
+    queue.urgent.clear();
+    queue.normal.clear();
+    queue.stats.queued = 0;
+    queue.stats.executed = 0;
+    queue.stats.rejected = 0;
+    queue.stats.maxDepth = 0;
+}
+
+bool commandQueuePush(CommandQueue& queue, const char* line, CommandPriority priority) {
+    QueuedCommand command;
+    strncpy(command.line, line, COMMAND_LINE_SIZE - 1);
+    command.line[COMMAND_LINE_SIZE - 1] = '\0';
+
+    bool pushed = (priority == COMMAND_PRIORITY_URGENT) ? queue.urgent.push(command)
+                                                         : queue.normal.push(command);
+    if (!pushed) {
+        queue.stats.rejected++;
+        return false;
+    }
+
+    queue.stats.queued++;
+    uint8_t depth = commandQueueDepth(queue);
+    if (depth > queue.stats.maxDepth) queue.stats.maxDepth = depth;
+    return true;
+}
+
+bool commandQueuePop(CommandQueue& queue, QueuedCommand& command, bool urgentOnly) {
+    if (queue.urgent.pop(command) || (!urgentOnly && queue.normal.pop(command))) {
+        queue.stats.executed++;
+        return true;
+    }
+    return false;
+}
+
+uint8_t commandQueueDepth(const CommandQueue& queue) {
+    return queue.urgent.size() + queue.normal.size();
+}
+
+uint8_t commandQueueCapacity() {
+    return COMMAND_QUEUE_URGENT_DEPTH + COMMAND_QUEUE_NORMAL_DEPTH;
+}
@@ -0,0 +1,156 @@
+#include "config_store.h"
+#include "telemetry_codec.h"
+
+#ifndef NATIVE_BUILD
+#include <avr/eeprom.h>
+#endif
+
+// Legacy layout: the tare offset as a long at address 0
+#define CONFIG_LEGACY_OFFSET_ADDR 0
+
+struct ConfigRecord {
+    uint8_t version;
+    uint8_t key;
+    uint32_t seq;
+    uint32_t value;
+};
+
+static uint32_t values[CONFIG_KEY_COUNT];
+// Slot holding the newest record of each key, CONFIG_SLOT_NONE if never stored
+static uint16_t liveSlots[CONFIG_KEY_COUNT];
+static ConfigStoreStats stats;
+
+static void readSlot(uint16_t slot, uint8_t* raw) {
+    eeprom_read_block(raw, (const void*)(uintptr_t)(slot * CONFIG_RECORD_SIZE), CONFIG_RECORD_SIZE);
+}
+
+// Returns false for an erased, foreign or corrupted slot
+static bool decodeRecord(const uint8_t* raw, ConfigRecord& record) {
+    if (raw[0] != CONFIG_RECORD_VERSION) return false;
+    if (telemetryCrc16(raw, CONFIG_RECORD_SIZE - 2) != telemetryGetU16(&raw[CONFIG_RECORD_SIZE - 2])) {
+        stats.badRecords++;
+        return false;
+    }
+    record.version = raw[0];
+    record.key = raw[1];
+    record.seq = telemetryGetU32(&raw[2]);
+    record.value = telemetryGetU32(&raw[6]);
+    return record.key < CONFIG_KEY_COUNT;
+}
+
+static bool isLiveSlot(uint16_t slot) {
+    for (uint8_t key = 0; key < CONFIG_KEY_COUNT; key++) {
+        if (liveSlots[key] == slot) return true;
+    }
+    return false;
+}
+
+// First slot at or after start that does not hold a key's newest record
+static uint16_t nextFreeSlot(uint16_t start) {
+    uint16_t slot = start % CONFIG_SLOT_COUNT;
+    while (isLiveSlot(slot)) {
+        slot = (slot + 1) % CONFIG_SLOT_COUNT;
+    }
+    return slot;
+}
+
+void initConfigStore() {
+    memset(&stats, 0, sizeof(stats));
+    for (uint8_t key = 0; key < CONFIG_KEY_COUNT; key++) {
+        values[key] = 0;
+        liveSlots[key] = CONFIG_SLOT_NONE;
+    }
+
+    // One pass: newest record per key, and the newest record overall
+    uint32_t keySeq[CONFIG_KEY_COUNT] = {0};
+    uint16_t newestSlot = CONFIG_SLOT_NONE;
+    for (uint16_t slot = 0; slot < CONFIG_SLOT_COUNT; slot++) {
+        uint8_t raw[CONFIG_RECORD_SIZE];
+        ConfigRecord record;
+        readSlot(slot, raw);
+        if (!decodeRecord(raw, record)) continue;
+        stats.validRecords++;
+
+        if (liveSlots[record.key] == CONFIG_SLOT_NONE || record.seq > keySeq[record.key]) {
+            keySeq[record.key] = record.seq;
+            liveSlots[record.key] = slot;
+            values[record.key] = record.value;
+        }
+        if (newestSlot == CONFIG_SLOT_NONE || record.seq > stats.seq) {
+            stats.seq = record.seq;
+            newestSlot = slot;
+        }
+    }
+    stats.head = nextFreeSlot(newestSlot == CONFIG_SLOT_NONE ? 0 : newestSlot + 1);
+
+    if (stats.validRecords == 0) {
+        // Blank journal: carry over the offset saved by older firmware
+        // (a 4-byte AVR long)
+        int32_t legacyOffset;
+        eeprom_read_block(&legacyOffset, (const void*)CONFIG_LEGACY_OFFSET_ADDR, sizeof(legacyOffset));
+        if (legacyOffset != -1 && legacyOffset != 0) {
+            configSetLong(CONFIG_KEY_TARE_OFFSET, legacyOffset);
+        }
+    }
+}
+
+bool configGet(uint8_t key, uint32_t& value) {
+    if (key >= CONFIG_KEY_COUNT || liveSlots[key] == CONFIG_SLOT_NONE) return false;
+    value = values[key];
+    return true;
+}
+
+bool configGetLong(uint8_t key, long& value) {
+    uint32_t raw;
+    if (!configGet(key, raw)) return false;
+    value = (long)(int32_t)raw;
+    return true;
+}
+
+bool configGetFloat(uint8_t key, float& value) {
+    uint32_t raw;
+    if (!configGet(key, raw)) return false;
+    memcpy(&value, &raw, sizeof(value));
+    return true;
+}
+
+bool configSet(uint8_t key, uint32_t value) {
+    if (key >= CONFIG_KEY_COUNT) return false;
+    if (liveSlots[key] != CONFIG_SLOT_NONE && values[key] == value) return true;
+
+    uint8_t raw[CONFIG_RECORD_SIZE];
+    raw[0] = CONFIG_RECORD_VERSION;
+    raw[1] = key;
+    telemetryPutU32(&raw[2], stats.seq + 1);
+    telemetryPutU32(&raw[6], value);
+    telemetryPutU16(&raw[CONFIG_RECORD_SIZE - 2], telemetryCrc16(raw, CONFIG_RECORD_SIZE - 2));
+
+    uint16_t slot = stats.head;
+    eeprom_update_block(raw, (void*)(uintptr_t)(slot * CONFIG_RECORD_SIZE), CONFIG_RECORD_SIZE);
+
+    // Read back, so a worn cell is reported instead of silently losing the value
+    uint8_t check[CONFIG_RECORD_SIZE];
+    readSlot(slot, check);
+    stats.head = nextFreeSlot(slot + 1);
+    if (memcmp(raw, check, CONFIG_RECORD_SIZE) != 0) return false;
+
+    stats.seq++;
+    stats.writes++;
+    values[key] = value;
+    liveSlots[key] = slot;
+    return true;
+}
+
+bool configSetLong(uint8_t key, long value) {
+    return configSet(key, (uint32_t)(int32_t)value);
+}
+
+bool configSetFloat(uint8_t key, float value) {
+    uint32_t raw;
+    memcpy(&raw, &value, sizeof(raw));
+    return configSet(key, raw);
+}
+
+const ConfigStoreStats& getConfigStoreStats() {
+    return stats;
+}
@@ -0,0 +1,51 @@
+#include "dosing_model.h"
+
+void dosingReset(DosingModel& model) {
+    model.a = 0.0f;
+    model.b = 0.0f;
+    model.p00 = DOSING_INITIAL_P;
+    model.p01 = 0.0f;
+    model.p11 = DOSING_INITIAL_P;
+    model.feeds = 0;
+}
+
+void dosingUpdate(DosingModel& model, float hopperKg, float gramsPerSecond) {
+    // Regressor phi = [1, hopperKg]; Pphi = P * phi
+    float pphi0 = model.p00 + model.p01 * hopperKg;
+    float pphi1 = model.p01 + model.p11 * hopperKg;
+    float denominator = DOSING_FORGETTING + pphi0 + hopperKg * pphi1;
+    if (denominator <= 0.0f) return;
+
+    float k0 = pphi0 / denominator;
+    float k1 = pphi1 / denominator;
+    float error = gramsPerSecond - (model.a + model.b * hopperKg);
+    model.a += k0 * error;
+    model.b += k1 * error;
+
+    // P = (P - K * phi' * P) / lambda, with phi' * P = Pphi' since P is symmetric
+    model.p00 -= k0 * pphi0;
+    model.p01 -= k0 * pphi1;
+    model.p11 -= k1 * pphi1;
+    // Feeds at a similar hopper level excite only one direction; stop
+    // forgetting once P is back at its initial size so it cannot wind up
+    if (model.p00 + model.p11 < 2.0f * DOSING_INITIAL_P) {
+        model.p00 /= DOSING_FORGETTING;
+        model.p01 /= DOSING_FORGETTING;
+        model.p11 /= DOSING_FORGETTING;
+    }
+
+    if (model.feeds < 0xFFFF) model.feeds++;
+}
+
+bool dosingPredictFlow(const DosingModel& model, float hopperKg, float& gramsPerSecond) {
+    if (model.feeds < DOSING_MIN_FEEDS) return false;
+    gramsPerSecond = model.a + model.b * hopperKg;
+    return gramsPerSecond >= DOSING_MIN_FLOW;
+}
+
+unsigned long dosingPlanOpenMs(const DosingModel& model, float hopperKg, float grams, unsigned long maxMs) {
+    float flow;
+    if (!dosingPredictFlow(model, hopperKg, flow) || grams <= 0.0f) return 0;
+    float planned = grams / flow * 1000.0f;
+    return planned >= (float)maxMs ? maxMs : (unsigned long)planned;
+}
@@ -0,0 +1,182 @@
+#include "feed_schedule.h"
+
+#define SECONDS_PER_DAY 86400UL
+
+static ScheduleEntry entries[SCHEDULE_MAX_ENTRIES];
+// Last run: local day number for daily entries, millis() for intervals
+static uint32_t lastFired[SCHEDULE_MAX_ENTRIES];
+static ScheduleStats stats;
+
+// Wall clock: epochSeconds was valid at millis() == syncMillis
+static bool clockValid = false;
+static uint32_t epochSeconds = 0;
+static unsigned long syncMillis = 0;
+static int16_t tzMinutes = 0;
+
+static void encodeEntry(const ScheduleEntry& entry, uint32_t& word0, uint32_t& word1) {
+    word0 = (uint32_t)entry.kind | ((uint32_t)(entry.enabled ? 1 : 0) << 8) | ((uint32_t)entry.minutes << 16);
+    word1 = (uint32_t)entry.amountG | ((uint32_t)entry.blowerS << 16) | ((uint32_t)entry.toleranceG << 24);
+}
+
+static void decodeEntry(uint32_t word0, uint32_t word1, ScheduleEntry& entry) {
+    entry.kind = (uint8_t)word0;
+    entry.enabled = ((word0 >> 8) & 0xFF) != 0;
+    entry.minutes = (uint16_t)(word0 >> 16);
+    entry.amountG = (uint16_t)word1;
+    entry.blowerS = (uint8_t)(word1 >> 16);
+    entry.toleranceG = (uint8_t)(word1 >> 24);
+}
+
+static bool entryValid(const ScheduleEntry& entry) {
+    switch (entry.kind) {
+        case SCHEDULE_UNUSED:   return true;
+        case SCHEDULE_DAILY:    return entry.minutes < SCHEDULE_MINUTES_PER_DAY && entry.amountG > 0;
+        case SCHEDULE_INTERVAL: return entry.minutes > 0 && entry.amountG > 0;
+    }
+    return false;
+}
+
+static void persistEntry(uint8_t index) {
+    uint32_t word0, word1;
+    encodeEntry(entries[index], word0, word1);
+    configSet(CONFIG_KEY_SCHEDULE_FIRST + 2 * index, word0);
+    configSet(CONFIG_KEY_SCHEDULE_FIRST + 2 * index + 1, word1);
+}
+
+// Seconds since the epoch in local time
+static uint32_t localSeconds() {
+    return scheduleEpochNow() + (int32_t)tzMinutes * 60;
+}
+
+// Start counting an entry from now: an interval runs one period from now, a
+// daily entry whose time has already passed today waits for tomorrow
+static void armEntry(uint8_t index) {
+    const ScheduleEntry& entry = entries[index];
+    if (entry.kind == SCHEDULE_INTERVAL) {
+        lastFired[index] = millis();
+    } else if (entry.kind == SCHEDULE_DAILY && clockValid) {
+        uint32_t local = localSeconds();
+        uint32_t day = local / SECONDS_PER_DAY;
+        uint16_t minute = (uint16_t)((local % SECONDS_PER_DAY) / 60);
+        lastFired[index] = (minute >= entry.minutes) ? day : day - 1;
+    }
+}
+
+void initSchedule() {
+    memset(&stats, 0, sizeof(stats));
+    long tz;
+    if (configGetLong(CONFIG_KEY_TIME_ZONE, tz)) {
+        tzMinutes = (int16_t)tz;
+    }
+    for (uint8_t i = 0; i < SCHEDULE_MAX_ENTRIES; i++) {
+        uint32_t word0, word1;
+        if (configGet(CONFIG_KEY_SCHEDULE_FIRST + 2 * i, word0) &&
+            configGet(CONFIG_KEY_SCHEDULE_FIRST + 2 * i + 1, word1)) {
+            decodeEntry(word0, word1, entries[i]);
+            if (!entryValid(entries[i])) entries[i].kind = SCHEDULE_UNUSED;
+        } else {
+            memset(&entries[i], 0, sizeof(entries[i]));
+        }
+        armEntry(i);
+    }
+}
+
+bool scheduleSet(uint8_t index, const ScheduleEntry& entry) {
+    if (index >= SCHEDULE_MAX_ENTRIES || !entryValid(entry)) return false;
+    entries[index] = entry;
+    armEntry(index);
+    persistEntry(index);
+    return true;
+}
+
+bool scheduleGet(uint8_t index, ScheduleEntry& entry) {
+    if (index >= SCHEDULE_MAX_ENTRIES) return false;
+    entry = entries[index];
+    return true;
+}
+
+bool scheduleSetEnabled(uint8_t index, bool enabled) {
+    if (index >= SCHEDULE_MAX_ENTRIES || entries[index].kind == SCHEDULE_UNUSED) return false;
+    if (enabled && !entries[index].enabled) armEntry(index);
+    entries[index].enabled = enabled;
+    persistEntry(index);
+    return true;
+}
+
+bool scheduleClear(uint8_t index) {
+    if (index >= SCHEDULE_MAX_ENTRIES) return false;
+    memset(&entries[index], 0, sizeof(entries[index]));
+    persistEntry(index);
+    return true;
+}
+
+void scheduleSyncClock(uint32_t epoch, int16_t tz) {
+    epochSeconds = epoch;
+    syncMillis = millis();
+    clockValid = true;
+    tzMinutes = tz;
+    configSetLong(CONFIG_KEY_TIME_ZONE, tz);
+    for (uint8_t i = 0; i < SCHEDULE_MAX_ENTRIES; i++) {
+        if (entries[i].kind == SCHEDULE_DAILY) armEntry(i);
+    }
+}
+
+bool scheduleClockValid() {
+    return clockValid;
+}
+
+uint32_t scheduleEpochNow() {
+    // Fold whole seconds into the epoch so millis() wrapping never matters
+    unsigned long elapsed = millis() - syncMillis;
+    uint32_t seconds = elapsed / 1000UL;
+    epochSeconds += seconds;
+    syncMillis += seconds * 1000UL;
+    return epochSeconds;
+}
+
+int16_t scheduleTzMinutes() {
+    return tzMinutes;
+}
+
+int8_t scheduleDueEntry() {
+    uint32_t day = 0;
+    uint16_t minute = 0;
+    if (clockValid) {
+        uint32_t local = localSeconds();
+        day = local / SECONDS_PER_DAY;
+        minute = (uint16_t)((local % SECONDS_PER_DAY) / 60);
+    }
+
+    for (uint8_t i = 0; i < SCHEDULE_MAX_ENTRIES; i++) {
+        const ScheduleEntry& entry = entries[i];
+        if (!entry.enabled) continue;
+
+        if (entry.kind == SCHEDULE_INTERVAL) {
+            if (millis() - lastFired[i] >= (uint32_t)entry.minutes * 60000UL) return (int8_t)i;
+        } else if (entry.kind == SCHEDULE_DAILY && clockValid && lastFired[i] != day &&
+                   minute >= entry.minutes) {
+            if (minute - entry.minutes < SCHEDULE_CATCHUP_MIN) return (int8_t)i;
+            // Too late to be useful (e.g. a long feed was running): skip today
+            lastFired[i] = day;
+            stats.missed++;
+        }
+    }
+    return -1;
+}
+
+void scheduleMarkFired(uint8_t index) {
+    if (index >= SCHEDULE_MAX_ENTRIES) return;
+    if (entries[index].kind == SCHEDULE_INTERVAL) {
+        // Keep the cadence fixed; restart it if a whole period was lost
+        uint32_t period = (uint32_t)entries[index].minutes * 60000UL;
+        lastFired[index] += period;
+        if (millis() - lastFired[index] >= period) lastFired[index] = millis();
+    } else {
+        lastFired[index] = localSeconds() / SECONDS_PER_DAY;
+    }
+    stats.fired++;
+}
+
+const ScheduleStats& getScheduleStats() {
+    return stats;
+}
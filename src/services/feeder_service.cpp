@@ -1,223 +1,454 @@
-#include <Arduino.h>
+#include "hal.h"
 #include "feeder_motor.h"
 #include "blower.h"
 #include "feeder_service.h"
 #include "sensor_service.h"
 #include "weight_sensor.h"
+#include "task_scheduler.h"
+#include "flow_estimator.h"
+#include "config_store.h"
+#include "dosing_model.h"
+#include "feed_schedule.h"
+#include "serial_tx.h"
 
 // Constants for feeder motor timings
 // #define FEEDER_MOTOR_OPEN_DURATION 5
+#define BLOWER_SPINUP_TIME 5000      // Blower runs 5s before the gate opens
 
 // Weight monitoring constants
 #define WEIGHT_CHECK_INTERVAL 100    // Check weight every 100ms
 // Default 5g (can be overridden from host command)
 static float g_weightTolerance = 5.0f;
+// Tolerance of the running sequence: the host default, or a schedule entry's own
+static float sequenceTolerance = 5.0f;
 #define MAX_WEIGHT_WAIT_TIME 30000   // Maximum 30 seconds to wait for weight change
 
-// Feeder sequence status
-static bool feederSequenceActive = false;
-static bool feederStopRequested = false;
+// Predictive cut-off: the gate is closed once the mass already dispensed plus
+// the mass expected to arrive during the close lead time reaches the target.
+// The lead time covers gate travel, sampling delay and feed in flight, and is
+// corrected after every feed from the measured overshoot.
+#define FEED_CUTOFF_LEAD_MS 400
+#define FEED_CUTOFF_LEAD_MIN_MS 0
+#define FEED_CUTOFF_LEAD_MAX_MS 1500
+#define FEED_LEAD_ADAPT_GAIN 0.5f    // Fraction of the observed error corrected per feed
+#define FEED_SETTLE_TIME 1500        // Wait after closing before measuring the result
 
-void initFeederService() {
-    feederSequenceActive = false;
-    feederStopRequested = false;
-    Serial.println("[FEEDER SERVICE] Initialized - ready to handle feeding sequences");
-}
-
-// Function to process serial commands during delays
-// Returns true if should continue, false if should stop
-bool processSerialCommands(bool limitedMode = false) {
-    if (!Serial.available()) {
-        return true; // No commands to process, continue
-    }
-    
-    if (limitedMode) {
-        // Limited mode: only process feeder:stop commands
-        String command = Serial.readStringUntil('\n');
-        command.trim();
-        if (command == "[control]:feeder:stop") {
-            Serial.println("[FEEDER] Stop command received");
-            feederStopRequested = true;
-            return false;
+// Open-loop phase from the learned dosing model: the gate stays open for the
+// time the model needs to dispense this fraction of the target without
+// evaluating the weight; the predictive cut-off then finishes the feed.
+#define DOSING_PLAN_FRACTION 0.8f
+
+// Feeder sequence state, advanced one step per scheduler tick
+static FeederState feederState = FEEDER_IDLE;
+static unsigned long stateEnteredAt = 0;
+
+// Parameters and progress of the current sequence
+static float targetReduction = 0.0f;
+static unsigned long blowerDurationMs = 0;
+static float initialWeight = 0.0f;
+static unsigned long lastWeightSample = 0;
+
+// Flow tracking for the predictive cut-off
+static FlowEstimator flowEstimator;
+static float cutoffLeadMs = FEED_CUTOFF_LEAD_MS;
+static float flowAtCutoff = 0.0f;          // g/s when the gate was closed
+static unsigned long gateOpenedAt = 0;
+static unsigned long dispenseDurationMs = 0;
+static bool resultReported = false;
+static bool blowerFinished = false;
+static bool dispenseTimedOut = false;
+
+// Learned flow vs hopper level, persisted in the config store
+static DosingModel dosingModel;
+static unsigned long plannedOpenMs = 0;    // 0 = closed loop from the start
+static uint16_t weightEvaluations = 0;     // Weight samples evaluated this feed
+
+// Learned values are saved in the background, one config record per feeder
+// tick and never while the gate is open: a record busy-waits up to ~40 ms for
+// the EEPROM, so writing all of them in one tick stalls the scheduler.
+// Changes too small to matter are not written, to spare the EEPROM.
+#define SAVE_DOSING_MIN_CHANGE 0.01f    // Relative change of a dosing value
+#define SAVE_LEAD_MIN_CHANGE_MS 5.0f
+
+enum PendingSave {
+    SAVE_DOSING_A,
+    SAVE_DOSING_B,
+    SAVE_DOSING_P00,
+    SAVE_DOSING_P01,
+    SAVE_DOSING_P11,
+    SAVE_DOSING_FEEDS,    // After the values, so it can follow them
+    SAVE_CUTOFF_LEAD,
+    SAVE_COUNT
+};
+
+#define SAVE_DOSING_ALL ((1 << (SAVE_DOSING_FEEDS + 1)) - 1)
+
+static uint8_t pendingSaves = 0;      // Bit per PendingSave
+static bool dosingValueSaved = false; // A dosing value was written since the last count
+
+static const __FlashStringHelper* feederStateName(FeederState state) {
+    switch (state) {
+        case FEEDER_IDLE:       return F("idle");
+        case FEEDER_SPINUP:     return F("spinup");
+        case FEEDER_DISPENSING: return F("dispensing");
+        case FEEDER_POST_BLOW:  return F("post_blow");
+    }
+    return F("unknown");
+}
+
+// Every transition is reported as "[EVENT] - feeder:<state>[:detail]"; the
+// caller ends the line after the detail
+static void beginStateEvent(FeederState next) {
+    feederState = next;
+    stateEnteredAt = millis();
+    // Feeding needs continuous weight samples even with power gating on
+    setWeightPowerHold(next != FEEDER_IDLE);
+    SerialTx.print(F("[EVENT] - feeder:"));
+    SerialTx.print(feederStateName(next));
+}
+
+static void enterState(FeederState next, const __FlashStringHelper* detail = NULL) {
+    beginStateEvent(next);
+    if (detail != NULL) {
+        SerialTx.print(':');
+        SerialTx.print(detail);
+    }
+    SerialTx.println();
+}
+
+// Detail is a weight in grams
+static void enterState(FeederState next, float grams) {
+    beginStateEvent(next);
+    SerialTx.print(':');
+    SerialTx.print(grams);
+    SerialTx.println(F("g"));
+}
+
+static float currentWeightGrams() {
+    return readWeightMg(WEIGHT_FAST_SAMPLES) * 0.001f; // Convert mg to g
+}
+
+static void finishSequence(const __FlashStringHelper* reason) {
+    feederMotorClose();
+    stopBlower();
+    enterState(FEEDER_IDLE, reason);
+}
+
+template <typename TDetail>
+static void closeGate(TDetail detail) {
+    dispenseDurationMs = millis() - gateOpenedAt;
+    feederMotorClose();
+    enterState(FEEDER_POST_BLOW, detail);
+}
+
+static void loadDosingModel() {
+    dosingReset(dosingModel);
+    long feeds;
+    if (!configGetLong(CONFIG_KEY_DOSING_FEEDS, feeds)) return;
+    configGetFloat(CONFIG_KEY_DOSING_A, dosingModel.a);
+    configGetFloat(CONFIG_KEY_DOSING_B, dosingModel.b);
+    configGetFloat(CONFIG_KEY_DOSING_P00, dosingModel.p00);
+    configGetFloat(CONFIG_KEY_DOSING_P01, dosingModel.p01);
+    configGetFloat(CONFIG_KEY_DOSING_P11, dosingModel.p11);
+    dosingModel.feeds = (uint16_t)feeds;
+}
+
+static bool saveDosingValue(uint8_t key, float value) {
+    float stored;
+    if (configGetFloat(key, stored) && fabsf(value - stored) <= SAVE_DOSING_MIN_CHANGE * fabsf(stored)) {
+        return false;
+    }
+    dosingValueSaved = true;
+    return configSetFloat(key, value);
+}
+
+// Returns true when a record was written
+static bool saveValue(uint8_t item) {
+    switch (item) {
+        case SAVE_DOSING_A:   return saveDosingValue(CONFIG_KEY_DOSING_A, dosingModel.a);
+        case SAVE_DOSING_B:   return saveDosingValue(CONFIG_KEY_DOSING_B, dosingModel.b);
+        case SAVE_DOSING_P00: return saveDosingValue(CONFIG_KEY_DOSING_P00, dosingModel.p00);
+        case SAVE_DOSING_P01: return saveDosingValue(CONFIG_KEY_DOSING_P01, dosingModel.p01);
+        case SAVE_DOSING_P11: return saveDosingValue(CONFIG_KEY_DOSING_P11, dosingModel.p11);
+        case SAVE_DOSING_FEEDS: {
+            // The count matters until the model plans; after that it is only
+            // stored together with a changed value
+            bool needed = dosingValueSaved || dosingModel.feeds <= DOSING_MIN_FEEDS;
+            dosingValueSaved = false;
+            long stored;
+            if (!needed || (configGetLong(CONFIG_KEY_DOSING_FEEDS, stored) && stored == dosingModel.feeds)) {
+                return false;
+            }
+            return configSetLong(CONFIG_KEY_DOSING_FEEDS, dosingModel.feeds);
         }
-        // Ignore other commands in limited mode
-        return true;
-    } else {
-        // Normal mode: process all sensor commands
-        controlSensor();
-        return !feederStopRequested;
+        case SAVE_CUTOFF_LEAD: {
+            float stored;
+            if (configGetFloat(CONFIG_KEY_FEED_CUTOFF_LEAD, stored) &&
+                fabsf(cutoffLeadMs - stored) < SAVE_LEAD_MIN_CHANGE_MS) {
+                return false;
+            }
+            return configSetFloat(CONFIG_KEY_FEED_CUTOFF_LEAD, cutoffLeadMs);
+        }
+    }
+    return false;
+}
+
+// Write at most one pending value
+static void saveNextValue() {
+    for (uint8_t item = 0; item < SAVE_COUNT; item++) {
+        if ((pendingSaves & (1 << item)) == 0) continue;
+        pendingSaves &= ~(1 << item);
+        if (saveValue(item)) return;
+    }
+}
+
+// Gate-open time for the open-loop phase, or 0 while the model is untrained
+static unsigned long planOpenTime() {
+    float hopperKg = initialWeight / 1000.0f;
+    unsigned long planned = dosingPlanOpenMs(dosingModel, hopperKg, DOSING_PLAN_FRACTION * targetReduction,
+                                             MAX_WEIGHT_WAIT_TIME);
+    if (planned == 0) return 0;
+    float flow = 0.0f;
+    dosingPredictFlow(dosingModel, hopperKg, flow);
+    SerialTx.print(F("[FEEDER] Planned open time: "));
+    SerialTx.print(planned);
+    SerialTx.print(F("ms at "));
+    SerialTx.print(flow);
+    SerialTx.println(F("g/s"));
+    return planned;
+}
+
+// Compare the settled result with the target and adapt the lead time
+static void reportFeedResult() {
+    float dispensed = initialWeight - currentWeightGrams();
+    float overshoot = dispensed - targetReduction;
+
+    if (flowAtCutoff > 0.0f) {
+        // Overshoot in grams corresponds to overshoot / flow seconds of lead
+        cutoffLeadMs += FEED_LEAD_ADAPT_GAIN * (overshoot / flowAtCutoff) * 1000.0f;
+        cutoffLeadMs = constrain(cutoffLeadMs, (float)FEED_CUTOFF_LEAD_MIN_MS, (float)FEED_CUTOFF_LEAD_MAX_MS);
+        pendingSaves |= 1 << SAVE_CUTOFF_LEAD;
+    }
+
+    SerialTx.print(F("[EVENT] - feeder:result:dispensed="));
+    SerialTx.print(dispensed);
+    SerialTx.print(F("g,target="));
+    SerialTx.print(targetReduction);
+    SerialTx.print(F("g,overshoot="));
+    SerialTx.print(overshoot);
+    SerialTx.print(F("g,flow="));
+    SerialTx.print(flowAtCutoff);
+    SerialTx.print(F("g/s,open="));
+    SerialTx.print(dispenseDurationMs);
+    SerialTx.print(F("ms,lead="));
+    SerialTx.print((int)cutoffLeadMs);
+    SerialTx.print(F("ms,planned="));
+    SerialTx.print(plannedOpenMs);
+    SerialTx.print(F("ms,reads="));
+    SerialTx.println(weightEvaluations);
+
+    // Average flow over the whole gate-open time, so gate travel and the
+    // start-up transient are part of what the model learns
+    if (!dispenseTimedOut && dispensed > 0.0f && dispenseDurationMs > 0) {
+        dosingUpdate(dosingModel, initialWeight / 1000.0f, dispensed * 1000.0f / dispenseDurationMs);
+        pendingSaves |= SAVE_DOSING_ALL;
     }
 }
 
-// Interruptible delay function
-bool interruptibleDelay(unsigned long delayMs) {
-    unsigned long startTime = millis();
-    while (millis() - startTime < delayMs) {
-        if (feederStopRequested) {
-            return false; // Interrupted
+static void updateDispensing(unsigned long elapsed) {
+    // Only evaluate when the background sampler has produced a new reading,
+    // and not before the planned open-loop time has passed
+    unsigned long sampleCount = getWeightSampleCount();
+    if (elapsed < plannedOpenMs) {
+        lastWeightSample = sampleCount;
+    } else if (sampleCount != lastWeightSample) {
+        lastWeightSample = sampleCount;
+        weightEvaluations++;
+        // Single newest sample: the regression does the smoothing without averaging lag
+        float weightReduction = initialWeight - readWeightMg(1) * 0.001f;
+        flowAddSample(flowEstimator, millis(), weightReduction);
+
+        float flow;
+        bool haveFlow = flowRate(flowEstimator, flow) && flow > 0.0f;
+        float predicted = weightReduction;
+        if (haveFlow) {
+            predicted += flow * cutoffLeadMs / 1000.0f;
         }
-        
-        // Process incoming serial commands during delay
-        if (!processSerialCommands()) {
-            return false; // Stop requested
+
+        // Without a flow estimate fall back to the plain tolerance check
+        bool reached = haveFlow ? (predicted >= targetReduction)
+                                : (weightReduction >= targetReduction - sequenceTolerance);
+        if (reached) {
+            flowAtCutoff = haveFlow ? flow : 0.0f;
+            SerialTx.print(F("[FEEDER] Cut-off at "));
+            SerialTx.print(weightReduction);
+            SerialTx.print(F("g, predicted "));
+            SerialTx.print(predicted);
+            SerialTx.println(F("g"));
+            closeGate(weightReduction);
+            return;
         }
-        
-        delay(10); // Faster responsiveness: check every 10ms
-    }
-    return true; // Completed normally
-}
-
-// Function to wait for weight reduction
-bool waitForWeightReduction(float targetReduction) {
-    Serial.println("[FEEDER] Waiting for weight reduction of " + String(targetReduction) + "g");
-    
-    // Stop sensor service printing to reduce noise
-    bool wasSensorActive = isSensorServiceActive();
-    if (wasSensorActive) {
-        stopSensorService();
-        Serial.println("[FEEDER] Stopped sensor service printing for weight monitoring");
-    }
-    
-    // Get initial weight
-    StaticJsonDocument<256> weightDoc = readWeight();
-    float initialWeight = weightDoc["value"][0]["value"].as<float>() * 1000.0f; // Convert kg to g
-    Serial.println("[FEEDER] Initial weight: " + String(initialWeight) + "g");
-    
-    unsigned long startTime = millis();
-    float currentWeight = initialWeight;
-    float weightReduction = 0.0;
-    
-    while (weightReduction < (targetReduction - g_weightTolerance)) {
-        if (feederStopRequested) {
-            Serial.println("[FEEDER] Weight monitoring stopped by user request");
-            if (wasSensorActive) {
-                startSensorService();
+    }
+
+    if (elapsed > MAX_WEIGHT_WAIT_TIME) {
+        SerialTx.print(F("[FEEDER] Warning: Weight monitoring timeout after "));
+        SerialTx.print(MAX_WEIGHT_WAIT_TIME / 1000);
+        SerialTx.println(F(" seconds"));
+        flowAtCutoff = 0.0f;
+        dispenseTimedOut = true;
+        closeGate(F("timeout"));
+    }
+}
+
+static void updateFeederService() {
+    unsigned long elapsed = millis() - stateEnteredAt;
+
+    switch (feederState) {
+        case FEEDER_IDLE:
+            break;
+
+        case FEEDER_SPINUP:
+            if (elapsed >= BLOWER_SPINUP_TIME) {
+                initialWeight = currentWeightGrams();
+                lastWeightSample = getWeightSampleCount();
+                SerialTx.print(F("[FEEDER] Initial weight: "));
+                SerialTx.print(initialWeight);
+                SerialTx.println(F("g"));
+                flowReset(flowEstimator);
+                resultReported = false;
+                blowerFinished = false;
+                dispenseTimedOut = false;
+                weightEvaluations = 0;
+                plannedOpenMs = planOpenTime();
+                feederMotorOpen();
+                gateOpenedAt = millis();
+                enterState(FEEDER_DISPENSING, targetReduction);
             }
-            return false;
-        }
-        
-        // Check for timeout
-        if (millis() - startTime > MAX_WEIGHT_WAIT_TIME) {
-            Serial.println("[FEEDER] Warning: Weight monitoring timeout after " + String(MAX_WEIGHT_WAIT_TIME/1000) + " seconds");
-            if (wasSensorActive) {
-                startSensorService();
+            break;
+
+        case FEEDER_DISPENSING:
+            updateDispensing(elapsed);
+            break;
+
+        case FEEDER_POST_BLOW:
+            // Let the feed in flight land before measuring the result
+            if (!resultReported && elapsed >= FEED_SETTLE_TIME) {
+                reportFeedResult();
+                resultReported = true;
             }
-            return true; // Continue with sequence even if timeout
-        }
-        
-        // Read current weight
-        weightDoc = readWeight();
-        currentWeight = weightDoc["value"][0]["value"].as<float>() * 1000.0f; // Convert kg to g
-        weightReduction = initialWeight - currentWeight;
-        
-        Serial.println("[FEEDER] Current weight: " + String(currentWeight) + "g, Reduction: " + String(weightReduction) + "g");
-        
-        // Only process feeder stop commands during weight monitoring
-        if (!processSerialCommands(true)) { // Limited mode: only feeder:stop commands
-            if (wasSensorActive) {
-                startSensorService();
+            if (elapsed >= blowerDurationMs && !blowerFinished) {
+                stopBlower();
+                blowerFinished = true;
             }
-            return false;
-        }
-        
-        delay(WEIGHT_CHECK_INTERVAL);
+            if (resultReported && blowerFinished) {
+                enterState(FEEDER_IDLE, F("completed"));
+            }
+            break;
     }
-    
-    Serial.println("[FEEDER] Target weight reduction achieved: " + String(weightReduction) + "g");
-    
-    // Restart sensor service if it was active
-    if (wasSensorActive) {
-        startSensorService();
-        Serial.println("[FEEDER] Restarted sensor service printing");
+
+    if (pendingSaves != 0 && feederState != FEEDER_DISPENSING) {
+        saveNextValue();
     }
-    
-    return true;
 }
 
-void startFeederSequence(int feedAmount, int blowerDuration) {
-    if (feederSequenceActive) {
-        Serial.println("[FEEDER] Warning: Feeder sequence already active, please wait");
+static void beginSequence(int feedAmount, int blowerDuration, float weightTolerance) {
+    if (feederState != FEEDER_IDLE) {
+        SerialTx.println(F("[FEEDER] Warning: Feeder sequence already active, please wait"));
         return;
     }
-    
-    feederSequenceActive = true;
-    feederStopRequested = false;
-    
-    // Declare variables at the beginning to avoid goto bypass issues
-    int remainingBlowerTime;
-    
-    Serial.println("[FEEDER] Starting automated feeder sequence");
-    Serial.println("[FEEDER] Feed amount: " + String(feedAmount) + "g");
-    
-    // Step 1: Start blower, wait 5 seconds, then open feeder motor
-    Serial.println("[FEEDER] Step 1: Starting blower, waiting 5s, then opening feeder motor");
-    Serial.println("[FEEDER] Blower duration: " + String(blowerDuration) + "s");
-    Serial.println("[FEEDER] Waiting for weight reduction of " + String(feedAmount) + "g");
-    
+
+    targetReduction = (float)feedAmount;
+    blowerDurationMs = (unsigned long)blowerDuration * 1000UL;
+    sequenceTolerance = weightTolerance;
+
+    SerialTx.println(F("[FEEDER] Starting automated feeder sequence"));
+    SerialTx.print(F("[FEEDER] Feed amount: "));
+    SerialTx.print(feedAmount);
+    SerialTx.println(F("g"));
+    SerialTx.print(F("[FEEDER] Blower duration: "));
+    SerialTx.print(blowerDuration);
+    SerialTx.println(F("s"));
+
     startBlower();
-    if (!interruptibleDelay(5000)) {
-        stopBlower();
-        goto emergency_stop;
-    }
-    feederMotorOpen();
-    
-    // Wait for weight reduction (no time limit while motor is opening)
-    if (!waitForWeightReduction(feedAmount)) {
-        feederMotorClose();
-        stopBlower();
-        goto emergency_stop;
-    }
-    Serial.println("[FEEDER] Step 1 completed: Target weight reduction achieved");
-    
-    // Step 2: Close feeder motor immediately when weight target is reached
-    Serial.println("[FEEDER] Step 2: Closing feeder motor");
-    feederMotorClose();
-    Serial.println("[FEEDER] Step 2 completed: Feeder motor close finished, blower continues");
-    
-    // Step 3: Continue blower for remaining duration
-    remainingBlowerTime = blowerDuration;
-    
-    if (remainingBlowerTime > 0) {
-        Serial.println("[FEEDER] Step 3: Continuing blower for remaining " + String(remainingBlowerTime) + "s");
-        if (!interruptibleDelay(remainingBlowerTime * 1000)) {
-            stopBlower();
-            goto emergency_stop;
-        }
-    }
-    
-    stopBlower();
-    
-    feederSequenceActive = false;
-    feederStopRequested = false;
-    Serial.println("[FEEDER] Automated feeder sequence completed successfully!");
-    return;
+    enterState(FEEDER_SPINUP);
+}
 
-emergency_stop:
-    feederMotorClose();
-    stopBlower();
-    feederSequenceActive = false;
-    feederStopRequested = false;
-    
-    // Make sure to restart sensor service if it was stopped
-    if (!isSensorServiceActive()) {
-        startSensorService();
-        Serial.println("[FEEDER] Restarted sensor service after emergency stop");
+// Start the next due schedule entry once the feeder is free
+static void runFeedSchedule() {
+    if (feederState != FEEDER_IDLE) return;
+    int8_t index = scheduleDueEntry();
+    if (index < 0) return;
+
+    ScheduleEntry entry;
+    scheduleGet((uint8_t)index, entry);
+    SerialTx.print(F("[EVENT] - schedule:feed:"));
+    SerialTx.println(index);
+    // The entry's tolerance applies to this feed only; the stored default is the host's
+    beginSequence(entry.amountG, entry.blowerS, (float)entry.toleranceG);
+    scheduleMarkFired((uint8_t)index);
+}
+
+void initFeederService() {
+    feederState = FEEDER_IDLE;
+    loadDosingModel();
+    float storedLead;
+    if (configGetFloat(CONFIG_KEY_FEED_CUTOFF_LEAD, storedLead) &&
+        storedLead >= FEED_CUTOFF_LEAD_MIN_MS && storedLead <= FEED_CUTOFF_LEAD_MAX_MS) {
+        cutoffLeadMs = storedLead;
+    }
+    float storedTolerance;
+    if (configGetFloat(CONFIG_KEY_WEIGHT_TOLERANCE, storedTolerance)) {
+        g_weightTolerance = storedTolerance;
     }
-    
-    Serial.println("[FEEDER] Feeder sequence stopped by user request");
+    registerTask(F("feeder"), updateFeederService, WEIGHT_CHECK_INTERVAL, 50, TASK_PRIORITY_NORMAL, 5000);
+    initSchedule();
+    registerTask(F("schedule"), runFeedSchedule, 1000, 1000, TASK_PRIORITY_NORMAL, 5000);
+    SerialTx.println(F("[FEEDER SERVICE] Initialized - ready to handle feeding sequences"));
+}
+
+void startFeederSequence(int feedAmount, int blowerDuration) {
+    beginSequence(feedAmount, blowerDuration, g_weightTolerance);
 }
 
 void stopFeederSequence() {
-    if (feederSequenceActive) {
-        Serial.println("[FEEDER] Stop request received - stopping sequence");
-        feederStopRequested = true;
+    if (feederState != FEEDER_IDLE) {
+        SerialTx.println(F("[FEEDER] Stop request received - stopping sequence"));
+        finishSequence(F("stopped"));
     } else {
-        Serial.println("[FEEDER] No active sequence to stop");
+        SerialTx.println(F("[FEEDER] No active sequence to stop"));
     }
 }
 
+bool isFeederSequenceActive() {
+    return feederState != FEEDER_IDLE;
+}
+
+FeederState getFeederState() {
+    return feederState;
+}
+
+void printDosingModel() {
+    SerialTx.print(F("[INFO] - Dosing model: feeds="));
+    SerialTx.print(dosingModel.feeds);
+    SerialTx.print(F(" flow="));
+    SerialTx.print(dosingModel.a, 3);
+    SerialTx.print('+');
+    SerialTx.print(dosingModel.b, 3);
+    SerialTx.print(F("*kg g/s"));
+    SerialTx.println(dosingModel.feeds >= DOSING_MIN_FEEDS ? F(" (planning)") : F(" (learning)"));
+}
+
+void resetDosingModel() {
+    dosingReset(dosingModel);
+    pendingSaves |= SAVE_DOSING_ALL;
+    SerialTx.println(F("[INFO] - Dosing model reset"));
+}
+
 // Overload that allows specifying weight tolerance from host
 void startFeederSequence(int feedAmount, int blowerDuration, int weightTolerance) {
-    g_weightTolerance = (float)weightTolerance; // grams
+    if (feederState == FEEDER_IDLE) {
+        g_weightTolerance = (float)weightTolerance; // grams
+        configSetFloat(CONFIG_KEY_WEIGHT_TOLERANCE, g_weightTolerance);
+    }
     startFeederSequence(feedAmount, blowerDuration);
 }
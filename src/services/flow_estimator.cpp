@@ -0,0 +1,35 @@
+#include "flow_estimator.h"
+
+void flowReset(FlowEstimator& estimator) {
+    estimator.samples.clear();
+}
+
+void flowAddSample(FlowEstimator& estimator, unsigned long timeMs, float grams) {
+    FlowSample sample;
+    sample.timeMs = timeMs;
+    sample.grams = grams;
+    estimator.samples.pushOverwrite(sample);
+}
+
+bool flowRate(const FlowEstimator& estimator, float& gramsPerSecond) {
+    uint8_t n = estimator.samples.size();
+    if (n < FLOW_MIN_SAMPLES) return false;
+
+    // Times relative to the oldest sample keep the float sums well conditioned
+    unsigned long t0 = estimator.samples.at(0).timeMs;
+    float sumT = 0, sumG = 0, sumTT = 0, sumTG = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        const FlowSample& sample = estimator.samples.at(i);
+        float t = (sample.timeMs - t0) / 1000.0f;
+        sumT += t;
+        sumG += sample.grams;
+        sumTT += t * t;
+        sumTG += t * sample.grams;
+    }
+
+    float denominator = n * sumTT - sumT * sumT;
+    if (denominator <= 0.0f) return false;
+
+    gramsPerSecond = (n * sumTG - sumT * sumG) / denominator;
+    return true;
+}
@@ -0,0 +1,54 @@
+#include "perf_stats.h"
+
+static PerfStat perfSlots[PERF_SLOT_COUNT];
+
+static const char kSlotLoop[] PROGMEM = "loop";
+static const char kSlotCommand[] PROGMEM = "command_dispatch";
+static const char kSlotSerialize[] PROGMEM = "serialize";
+static const char kSlotSensorRead[] PROGMEM = "sensor_read";
+static const char* const kSlotNames[PERF_SLOT_COUNT] = {
+    kSlotLoop, kSlotCommand, kSlotSerialize, kSlotSensorRead
+};
+
+void perfReset(PerfStat& stat) {
+    stat.count = 0;
+    stat.sumUs = 0;
+    stat.minUs = 0xFFFFFFFFUL;
+    stat.maxUs = 0;
+    for (uint8_t i = 0; i < PERF_HISTOGRAM_BINS; i++) {
+        stat.histogram[i] = 0;
+    }
+}
+
+void perfRecord(PerfStat& stat, uint32_t elapsedUs) {
+    stat.count++;
+    stat.sumUs += elapsedUs;
+    if (elapsedUs < stat.minUs) stat.minUs = elapsedUs;
+    if (elapsedUs > stat.maxUs) stat.maxUs = elapsedUs;
+
+    uint8_t bin = 0;
+    uint32_t bound = 16;
+    while (bin < PERF_HISTOGRAM_BINS - 1 && elapsedUs >= bound) {
+        bound <<= 1;
+        bin++;
+    }
+    if (stat.histogram[bin] != 0xFFFF) stat.histogram[bin]++;
+}
+
+uint32_t perfMean(const PerfStat& stat) {
+    return stat.count > 0 ? (uint32_t)(stat.sumUs / stat.count) : 0;
+}
+
+PerfStat& perfSlot(PerfSlot slot) {
+    return perfSlots[slot];
+}
+
+const __FlashStringHelper* perfSlotName(PerfSlot slot) {
+    return reinterpret_cast<const __FlashStringHelper*>(kSlotNames[slot]);
+}
+
+void perfResetSlots() {
+    for (uint8_t i = 0; i < PERF_SLOT_COUNT; i++) {
+        perfReset(perfSlots[i]);
+    }
+}
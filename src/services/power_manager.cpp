@@ -0,0 +1,175 @@
+#include "power_manager.h"
+#include "config_store.h"
+#include "adc_engine.h"
+#include "soil_sensor.h"
+#include "task_scheduler.h"
+
+#ifndef NATIVE_BUILD
+#include <avr/sleep.h>
+#endif
+
+#define POWER_FLAG_IDLE   0x01
+#define POWER_FLAG_GATING 0x02
+
+static bool idleEnabled = true;
+static bool gatingEnabled = false;
+static uint8_t batteryLowPct = POWER_BATTERY_LOW_PCT;
+static uint8_t batteryCriticalPct = POWER_BATTERY_CRITICAL_PCT;
+static PowerLevel powerLevel = POWER_LEVEL_NORMAL;
+
+static int8_t adcReaders[POWER_ADC_READERS];
+static uint8_t adcReaderCount = 0;
+
+static PowerStats stats;
+static uint16_t idleUsRemainder = 0;   // Sub-millisecond part of the idle time
+
+static void saveFlags() {
+    uint32_t flags = (idleEnabled ? POWER_FLAG_IDLE : 0) | (gatingEnabled ? POWER_FLAG_GATING : 0);
+    configSet(CONFIG_KEY_POWER_FLAGS, flags);
+}
+
+void initPowerManager() {
+    uint32_t value;
+    if (configGet(CONFIG_KEY_POWER_FLAGS, value)) {
+        idleEnabled = (value & POWER_FLAG_IDLE) != 0;
+        gatingEnabled = (value & POWER_FLAG_GATING) != 0;
+    }
+    if (configGet(CONFIG_KEY_BATTERY_THRESHOLDS, value)) {
+        uint8_t low = (uint8_t)value;
+        uint8_t critical = (uint8_t)(value >> 8);
+        if (critical <= low && low <= 100) {
+            batteryLowPct = low;
+            batteryCriticalPct = critical;
+        }
+    }
+    powerLevel = POWER_LEVEL_NORMAL;
+    adcReaderCount = 0;
+    resetPowerStats();
+}
+
+// With gating on, the ADC engine only runs during the last cycle before a
+// reader is due and until that reader has run, or while a gated soil probe
+// is powered for its sample
+static void updateAdcGating() {
+    bool needed = !gatingEnabled || adcReaderCount == 0 || isSoilProbeSampling();
+    for (uint8_t i = 0; i < adcReaderCount && !needed; i++) {
+        unsigned long dueInMs;
+        needed = getTaskDueInMs(adcReaders[i], dueInMs) && dueInMs <= ADC_ENGINE_CYCLE_MS;
+    }
+    if (needed == isAdcEngineRunning()) return;
+    if (needed) {
+        startAdcEngine();
+    } else {
+        stopAdcEngine();
+    }
+}
+
+void powerIdle() {
+    updateAdcGating();
+    if (!idleEnabled) return;
+
+    unsigned long startUs = micros();
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    // sei() takes effect after the next instruction, so an interrupt that
+    // arrives here still wakes the sleep instead of being missed
+    noInterrupts();
+    sleep_enable();
+    interrupts();
+    sleep_cpu();
+    sleep_disable();
+
+    uint32_t sleptUs = (micros() - startUs) + idleUsRemainder;
+    stats.idleMs += sleptUs / 1000;
+    idleUsRemainder = (uint16_t)(sleptUs % 1000);
+    stats.sleeps++;
+}
+
+void setPowerIdleEnabled(bool enabled) {
+    idleEnabled = enabled;
+    saveFlags();
+}
+
+bool isPowerIdleEnabled() {
+    return idleEnabled;
+}
+
+void setPowerGatingEnabled(bool enabled) {
+    gatingEnabled = enabled;
+    saveFlags();
+}
+
+bool isPowerGatingEnabled() {
+    return gatingEnabled;
+}
+
+void addPowerAdcReader(int8_t taskId) {
+    if (taskId == TASK_INVALID || adcReaderCount >= POWER_ADC_READERS) return;
+    adcReaders[adcReaderCount++] = taskId;
+}
+
+bool setBatteryThresholds(uint8_t lowPct, uint8_t criticalPct) {
+    if (lowPct > 100 || criticalPct > lowPct) return false;
+    batteryLowPct = lowPct;
+    batteryCriticalPct = criticalPct;
+    configSet(CONFIG_KEY_BATTERY_THRESHOLDS, (uint32_t)lowPct | ((uint32_t)criticalPct << 8));
+    return true;
+}
+
+uint8_t getBatteryLowPct() {
+    return batteryLowPct;
+}
+
+uint8_t getBatteryCriticalPct() {
+    return batteryCriticalPct;
+}
+
+bool updateBatteryLevel(float percent) {
+    // A level is entered below its threshold but only left once the battery
+    // has recovered by the hysteresis, so a sagging pack does not flap
+    float criticalEdge = batteryCriticalPct;
+    float lowEdge = batteryLowPct;
+    if (powerLevel == POWER_LEVEL_CRITICAL) criticalEdge += POWER_BATTERY_HYSTERESIS_PCT;
+    if (powerLevel != POWER_LEVEL_NORMAL) lowEdge += POWER_BATTERY_HYSTERESIS_PCT;
+
+    PowerLevel next = POWER_LEVEL_NORMAL;
+    if (batteryCriticalPct > 0 && percent < criticalEdge) {
+        next = POWER_LEVEL_CRITICAL;
+    } else if (batteryLowPct > 0 && percent < lowEdge) {
+        next = POWER_LEVEL_LOW;
+    }
+
+    if (next == powerLevel) return false;
+    powerLevel = next;
+    return true;
+}
+
+PowerLevel getPowerLevel() {
+    return powerLevel;
+}
+
+const char* powerLevelName(PowerLevel level) {
+    switch (level) {
+        case POWER_LEVEL_LOW:      return "low";
+        case POWER_LEVEL_CRITICAL: return "critical";
+        default:                   return "normal";
+    }
+}
+
+uint8_t getPowerPeriodScale() {
+    switch (powerLevel) {
+        case POWER_LEVEL_LOW:      return POWER_LOW_PERIOD_SCALE;
+        case POWER_LEVEL_CRITICAL: return POWER_CRITICAL_PERIOD_SCALE;
+        default:                   return 1;
+    }
+}
+
+const PowerStats& getPowerStats() {
+    return stats;
+}
+
+void resetPowerStats() {
+    stats.sleeps = 0;
+    stats.idleMs = 0;
+    stats.sinceMs = millis();
+    idleUsRemainder = 0;
+}
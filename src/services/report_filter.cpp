@@ -0,0 +1,46 @@
+#include "report_filter.h"
+
+void reportReset(ReportState& state) {
+    for (uint8_t i = 0; i < REPORT_MAX_FIELDS; i++) {
+        state.lastSent[i] = 0.0f;
+    }
+    state.lastSentMs = 0;
+    state.primed = false;
+    state.sent = 0;
+    state.suppressed = 0;
+}
+
+bool reportOutsideDeadband(const Deadband& deadband, float last, float value) {
+    float delta = value - last;
+    if (delta < 0) delta = -delta;
+
+    float band = deadband.band;
+    if (deadband.relative) {
+        band *= (last < 0) ? -last : last;
+    }
+    // A zero band reports any change at all
+    return band <= 0.0f ? delta > 0.0f : delta > band;
+}
+
+bool reportShouldSend(ReportState& state, const float* values, const Deadband* deadbands,
+                      uint8_t count, unsigned long now, unsigned long maxSilenceMs) {
+    if (count > REPORT_MAX_FIELDS) count = REPORT_MAX_FIELDS;
+
+    bool send = !state.primed || (now - state.lastSentMs >= maxSilenceMs);
+    for (uint8_t i = 0; i < count && !send; i++) {
+        send = reportOutsideDeadband(deadbands[i], state.lastSent[i], values[i]);
+    }
+
+    if (!send) {
+        state.suppressed++;
+        return false;
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        state.lastSent[i] = values[i];
+    }
+    state.lastSentMs = now;
+    state.primed = true;
+    state.sent++;
+    return true;
+}
@@ -0,0 +1,89 @@
+#include "sample_log.h"
+
+static uint8_t ramLogBytes[SAMPLE_LOG_RAM_SIZE];
+
+static void ramRead(uint16_t addr, uint8_t* data, uint16_t len) {
+    memcpy(data, &ramLogBytes[addr], len);
+}
+
+static void ramWrite(uint16_t addr, const uint8_t* data, uint16_t len) {
+    memcpy(&ramLogBytes[addr], data, len);
+}
+
+static const LogStorage kRamStorage = { SAMPLE_LOG_RAM_SIZE, ramRead, ramWrite };
+
+const LogStorage* sampleLogRamStorage() {
+    return &kRamStorage;
+}
+
+// Split accesses that wrap past the end of the storage
+static void ringRead(const LogStorage& storage, uint16_t addr, uint8_t* data, uint16_t len) {
+    uint16_t first = storage.capacity - addr;
+    if (first > len) first = len;
+    storage.read(addr, data, first);
+    if (first < len) storage.read(0, data + first, len - first);
+}
+
+static void ringWrite(const LogStorage& storage, uint16_t addr, const uint8_t* data, uint16_t len) {
+    uint16_t first = storage.capacity - addr;
+    if (first > len) first = len;
+    storage.write(addr, data, first);
+    if (first < len) storage.write(0, data + first, len - first);
+}
+
+void sampleLogReset(SampleLog& log, const LogStorage* storage) {
+    log.storage = storage;
+    log.tail = 0;
+    log.used = 0;
+    log.records = 0;
+    log.logged = 0;
+    log.dropped = 0;
+}
+
+bool sampleLogAppend(SampleLog& log, uint8_t sensorId, uint32_t timestampMs,
+                     const uint8_t* payload, uint8_t length) {
+    uint16_t size = SAMPLE_LOG_HEADER_SIZE + length;
+    if (length > SAMPLE_LOG_MAX_PAYLOAD || size > log.storage->capacity) return false;
+
+    while (log.storage->capacity - log.used < size) {
+        sampleLogDrop(log);
+        log.dropped++;
+    }
+
+    uint8_t header[SAMPLE_LOG_HEADER_SIZE];
+    header[0] = length;
+    header[1] = sensorId;
+    telemetryPutU32(&header[2], timestampMs);
+
+    uint16_t head = (uint16_t)(((uint32_t)log.tail + log.used) % log.storage->capacity);
+    ringWrite(*log.storage, head, header, SAMPLE_LOG_HEADER_SIZE);
+    ringWrite(*log.storage, (head + SAMPLE_LOG_HEADER_SIZE) % log.storage->capacity, payload, length);
+    log.used += size;
+    log.records++;
+    log.logged++;
+    return true;
+}
+
+bool sampleLogPeek(const SampleLog& log, SampleLogRecord& record) {
+    if (log.records == 0) return false;
+
+    uint8_t header[SAMPLE_LOG_HEADER_SIZE];
+    ringRead(*log.storage, log.tail, header, SAMPLE_LOG_HEADER_SIZE);
+    record.length = header[0];
+    record.sensorId = header[1];
+    record.timestampMs = telemetryGetU32(&header[2]);
+    ringRead(*log.storage, (log.tail + SAMPLE_LOG_HEADER_SIZE) % log.storage->capacity,
+             record.payload, record.length);
+    return true;
+}
+
+void sampleLogDrop(SampleLog& log) {
+    if (log.records == 0) return;
+
+    uint8_t length;
+    log.storage->read(log.tail, &length, 1);
+    uint16_t size = SAMPLE_LOG_HEADER_SIZE + length;
+    log.tail = (uint16_t)(((uint32_t)log.tail + size) % log.storage->capacity);
+    log.used -= size;
+    log.records--;
+}
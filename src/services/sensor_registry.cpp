@@ -0,0 +1,183 @@
+#include "sensor_registry.h"
+#include "telemetry_codec.h"
+#include "dht_sensor.h"
+#include "soil_sensor.h"
+#include "weight_sensor.h"
+#include "power_monitor.h"
+
+// === Fields ===
+static const char kTypeTemperature[] PROGMEM = "temperature";
+static const char kTypeHumidity[] PROGMEM = "humidity";
+static const char kTypeSoilMoisture[] PROGMEM = "soil_moisture";
+static const char kTypeWeight[] PROGMEM = "weight";
+static const char kTypeSolarVoltage[] PROGMEM = "solarVoltage";
+static const char kTypeSolarCurrent[] PROGMEM = "solarCurrent";
+static const char kTypeLoadVoltage[] PROGMEM = "loadVoltage";
+static const char kTypeLoadCurrent[] PROGMEM = "loadCurrent";
+static const char kTypeBatteryVoltage[] PROGMEM = "batteryVoltage";
+static const char kTypeBatteryPercentage[] PROGMEM = "batteryPercentage";
+static const char kTypeBatteryStatus[] PROGMEM = "batteryStatus";
+
+static const char kUnitCelsius[] PROGMEM = "C";
+static const char kUnitPercent[] PROGMEM = "%";
+static const char kUnitKilogram[] PROGMEM = "kg";
+static const char kUnitVolt[] PROGMEM = "V";
+static const char kUnitAmpere[] PROGMEM = "A";
+static const char kUnitString[] PROGMEM = "string";
+
+static const char kLabelCharging[] PROGMEM = "charging";
+static const char kLabelDischarging[] PROGMEM = "discharging";
+
+// In SensorFieldId order. Default deadbands are absolute in the field's
+// unit, or a fraction of the last sent value when relative.
+static const SensorFieldInfo kSensorFields[] PROGMEM = {
+    { kTypeTemperature,       kUnitCelsius,  WIRE_I16,  10.0f,   { false, 0.2f },   NULL, NULL },
+    { kTypeHumidity,          kUnitPercent,  WIRE_U16,  10.0f,   { false, 1.0f },   NULL, NULL },
+    { kTypeSoilMoisture,      kUnitPercent,  WIRE_U8,   1.0f,    { false, 2.0f },   NULL, NULL },
+    { kTypeWeight,            kUnitKilogram, WIRE_I32,  1000.0f, { false, 0.005f }, NULL, NULL },
+    { kTypeSolarVoltage,      kUnitVolt,     WIRE_U16,  1000.0f, { true,  0.02f },  NULL, NULL },
+    { kTypeSolarCurrent,      kUnitAmpere,   WIRE_I16,  1000.0f, { false, 0.1f },   NULL, NULL },
+    { kTypeLoadVoltage,       kUnitVolt,     WIRE_U16,  1000.0f, { true,  0.01f },  NULL, NULL },
+    { kTypeLoadCurrent,       kUnitAmpere,   WIRE_I16,  1000.0f, { false, 0.1f },   NULL, NULL },
+    { kTypeBatteryVoltage,    kUnitVolt,     WIRE_NONE, 1000.0f, { true,  0.01f },  NULL, NULL },
+    { kTypeBatteryPercentage, kUnitPercent,  WIRE_U16,  10.0f,   { false, 1.0f },   NULL, NULL },
+    { kTypeBatteryStatus,     kUnitString,   WIRE_U8,   1.0f,    { false, 0.0f },   kLabelDischarging, kLabelCharging },
+};
+static_assert(sizeof(kSensorFields) / sizeof(kSensorFields[0]) == FIELD_COUNT, "kSensorFields must follow SensorFieldId");
+
+// === Read functions ===
+static void readDHTSample(uint8_t index, SensorSample& sample) {
+    // Cached by the DHT driver; stamped with the conversion time. Nothing
+    // to report before the first good conversion or once it is stale.
+    const DhtCachedReading& reading = getDHTReading(index);
+    sample.values[0] = reading.temperature;
+    sample.values[1] = reading.humidity;
+    sample.timestamp = reading.timestamp;
+    sample.valid = reading.valid && getDHTReadingAge(index) <= DHT_STALE_MS;
+}
+
+static void readDHTSystemSample(SensorSample& sample) { readDHTSample(DHT_INDEX_SYSTEM, sample); }
+static void readDHTFeederSample(SensorSample& sample) { readDHTSample(DHT_INDEX_FEEDER, sample); }
+
+static void readSoilSample(SensorSample& sample) {
+    SoilReading reading = readSoil();
+    sample.values[0] = reading.moisture;
+    sample.timestamp = reading.timestamp;
+}
+
+static void readWeightSample(SensorSample& sample) {
+    WeightReading reading = readWeight();
+    // 1 g resolution; kg only for the serializers
+    long grams = (reading.weightMg + (reading.weightMg < 0 ? -500 : 500)) / 1000;
+    sample.values[0] = grams * 0.001f;
+    sample.timestamp = reading.timestamp;
+}
+
+static void readPowerSample(SensorSample& sample) {
+    PowerReading reading = readPowerMonitor();
+    // Integer mV/mA/0.1 % from the driver, converted for the serializers
+    sample.values[0] = reading.solarMillivolts * 0.001f;
+    sample.values[1] = reading.solarMilliamps * 0.001f;
+    sample.values[2] = reading.loadMillivolts * 0.001f;
+    sample.values[3] = reading.loadMilliamps * 0.001f;
+    sample.values[4] = reading.batteryMillivolts * 0.001f;
+    sample.values[5] = reading.batteryPercentX10 * 0.1f;
+    sample.values[6] = reading.charging ? 1.0f : 0.0f;
+    sample.timestamp = reading.timestamp;
+}
+
+// === Sensors ===
+static const char kNameDhtSystem[] PROGMEM = DHT22_SYSTEM;
+static const char kNameDhtFeeder[] PROGMEM = DHT22_FEEDER;
+static const char kNameSoil[] PROGMEM = SOIL_SENSOR;
+static const char kNameWeight[] PROGMEM = WEIGHT_SENSOR;
+static const char kNamePowerMonitor[] PROGMEM = POWER_MONITOR;
+
+static const char kTaskDhtSystem[] PROGMEM = "dht_system";
+static const char kTaskDhtFeeder[] PROGMEM = "dht_feeder";
+static const char kTaskSoil[] PROGMEM = "soil";
+static const char kTaskWeight[] PROGMEM = "weight";
+static const char kTaskPowerMonitor[] PROGMEM = "power_monitor";
+
+static constexpr uint8_t kDhtFields[] PROGMEM = { FIELD_TEMPERATURE, FIELD_HUMIDITY };
+static constexpr uint8_t kSoilFields[] PROGMEM = { FIELD_SOIL_MOISTURE };
+static constexpr uint8_t kWeightFields[] PROGMEM = { FIELD_WEIGHT };
+static constexpr uint8_t kPowerFields[] PROGMEM = {
+    FIELD_SOLAR_VOLTAGE, FIELD_SOLAR_CURRENT, FIELD_LOAD_VOLTAGE, FIELD_LOAD_CURRENT,
+    FIELD_BATTERY_VOLTAGE, FIELD_BATTERY_PERCENTAGE, FIELD_BATTERY_STATUS
+};
+
+#define FIELD_LIST(fields) fields, sizeof(fields)
+
+// In SensorSlot order
+static const SensorDescriptor kSensors[] PROGMEM = {
+    { kNameDhtSystem,    kTaskDhtSystem,    TELEMETRY_ID_DHT_SYSTEM,    initDHT,          readDHTSystemSample, FIELD_LIST(kDhtFields),    5000 },
+    { kNameDhtFeeder,    kTaskDhtFeeder,    TELEMETRY_ID_DHT_FEEDER,    NULL,             readDHTFeederSample, FIELD_LIST(kDhtFields),    5000 },
+    { kNameSoil,         kTaskSoil,         TELEMETRY_ID_SOIL,          initSoil,         readSoilSample,      FIELD_LIST(kSoilFields),   5000 },
+    { kNameWeight,       kTaskWeight,       TELEMETRY_ID_WEIGHT,        initWeight,       readWeightSample,    FIELD_LIST(kWeightFields), 5000 },
+    { kNamePowerMonitor, kTaskPowerMonitor, TELEMETRY_ID_POWER_MONITOR, initPowerMonitor, readPowerSample,     FIELD_LIST(kPowerFields),  5000 },
+};
+static_assert(sizeof(kSensors) / sizeof(kSensors[0]) == SENSOR_COUNT, "kSensors must follow SensorSlot");
+static_assert(2 * sizeof(kDhtFields) + sizeof(kSoilFields) + sizeof(kWeightFields) + sizeof(kPowerFields) ==
+              SENSOR_TOTAL_FIELDS, "SENSOR_TOTAL_FIELDS must match the field lists");
+static_assert(sizeof(kPowerFields) <= SENSOR_MAX_FIELDS && SENSOR_MAX_FIELDS <= REPORT_MAX_FIELDS,
+              "Field lists must fit a SensorSample and the report filter");
+
+void getSensor(uint8_t slot, SensorDescriptor& sensor) {
+    memcpy_P(&sensor, &kSensors[slot], sizeof(sensor));
+}
+
+void getSensorField(uint8_t fieldId, SensorFieldInfo& field) {
+    memcpy_P(&field, &kSensorFields[fieldId], sizeof(field));
+}
+
+uint8_t getSensorFieldId(const SensorDescriptor& sensor, uint8_t index) {
+    return pgm_read_byte(&sensor.fields[index]);
+}
+
+int8_t findSensorField(const char* type) {
+    for (uint8_t i = 0; i < FIELD_COUNT; i++) {
+        SensorFieldInfo field;
+        getSensorField(i, field);
+        if (strcmp_P(type, field.type) == 0) return (int8_t)i;
+    }
+    return SENSOR_INVALID_FIELD;
+}
+
+void initRegisteredSensors() {
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+        SensorDescriptor sensor;
+        getSensor(i, sensor);
+        if (sensor.init != NULL) sensor.init();
+    }
+}
+
+size_t packSensorSample(const SensorDescriptor& sensor, const SensorSample& sample,
+                        uint8_t* out, size_t outCap) {
+    size_t len = 0;
+    for (uint8_t i = 0; i < sensor.fieldCount; i++) {
+        SensorFieldInfo field;
+        getSensorField(getSensorFieldId(sensor, i), field);
+        long scaled = lround(sample.values[i] * field.wireScale);
+
+        size_t size = 0;
+        switch (field.wire) {
+            case WIRE_U8:  size = 1; break;
+            case WIRE_U16:
+            case WIRE_I16: size = 2; break;
+            case WIRE_I32: size = 4; break;
+            default:       continue;
+        }
+        if (len + size > outCap) return 0;
+
+        if (size == 1) {
+            out[len] = (uint8_t)scaled;
+        } else if (size == 2) {
+            telemetryPutU16(&out[len], (uint16_t)scaled);
+        } else {
+            telemetryPutU32(&out[len], (uint32_t)scaled);
+        }
+        len += size;
+    }
+    return len;
+}
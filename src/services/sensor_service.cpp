@@ -1,17 +1,32 @@
-#include <Arduino.h>
-#include <ArduinoJson.h>
+#include "hal.h"
 #include "blower.h"
 #include "dht_sensor.h"
-#include "soil_sensor.h"
 #include "weight_sensor.h"
-#include "power_monitor.h"
+#include "soil_sensor.h"
 #include "feeder_motor.h"
 #include "relay_control.h"
+#include "adc_engine.h"
 #include "sensor_service.h"
 #include "feeder_service.h"
+#include "telemetry_codec.h"
+#include "task_scheduler.h"
+#include "command_parser.h"
+#include "command_queue.h"
+#include "perf_stats.h"
+#include "report_filter.h"
+#include "sensor_registry.h"
+#include "telemetry_json.h"
+#include "config_store.h"
+#include "sample_log.h"
+#include "feed_schedule.h"
+#include "power_manager.h"
+#include "serial_link.h"
+#include "serial_tx.h"
 
-// Forward declaration of printJson function
-static void printJson(String jsonString);
+static void printBinaryRecord(uint8_t sensorId, const uint8_t* payload, size_t payloadLen,
+                              unsigned long timestampMs);
+static void commandTask();
+static void scheduleSensorTasks();
 
 // Timer-based sensor service variables
 static unsigned long sensorPrintInterval = 5000; // Default 5 seconds
@@ -20,157 +35,1349 @@ static bool sensorServiceActive = false;
 static bool isUseFreezeLoadV = false;
 static float freezeLoadV = 0.0;
 
-// Non-blocking step scheduler variables
-static const uint8_t kTotalSensors = 5;
-static uint8_t sensorIndex = 0;
-static unsigned long lastStepTime = 0;
-static unsigned long stepInterval = 1000; // ms
+// Minimum period for a single sensor's telemetry task
+static const unsigned long kMinSensorPeriod = 1000; // ms
 
+// Telemetry output format
+enum TelemetryFormat {
+    TELEMETRY_FORMAT_JSON,
+    TELEMETRY_FORMAT_BINARY
+};
+static TelemetryFormat telemetryFormat = TELEMETRY_FORMAT_JSON;
+static uint16_t telemetrySeq = 0;
 
-enum DeviceType {
-    DEVICE_UNKNOWN,
-    DEVICE_BLOWER,
-    DEVICE_FEEDERMOTOR,
-    DEVICE_RELAY,
-    DEVICE_FEEDER
+// Report-on-change: per-field deadbands plus a heartbeat per sensor
+enum ReportMode {
+    REPORT_MODE_ALL,
+    REPORT_MODE_ON_CHANGE
 };
+static ReportMode reportMode = REPORT_MODE_ALL;
+static unsigned long reportHeartbeatMs = 60000; // Max silence per sensor
+static ReportState reportStates[SENSOR_COUNT];
+// Current bands, starting from the registry defaults
+static Deadband fieldDeadbands[FIELD_COUNT];
 
-DeviceType parseDeviceType(const String& device) {
-    if (device == "blower") return DEVICE_BLOWER;
-    if (device == "feedermotor") return DEVICE_FEEDERMOTOR;
-    if (device == "relay") return DEVICE_RELAY;
-    if (device == "feeder") return DEVICE_FEEDER;
-    return DEVICE_UNKNOWN;
-}
+// Returns true if the record should be sent; always true in REPORT_MODE_ALL
+static bool passesReportFilter(uint8_t slot, const SensorDescriptor& sensor, const SensorSample& sample) {
+    ReportState& state = reportStates[slot];
+    if (reportMode == REPORT_MODE_ALL) {
+        state.sent++;
+        return true;
+    }
 
-// Helper functions to print individual sensor data
-static void printDHTSystem() {
-  String jsonString;
-  StaticJsonDocument<256> dhtSystem = readDHTSystem();
-  serializeJson(dhtSystem, jsonString);
-  printJson(jsonString);
+    Deadband deadbands[SENSOR_MAX_FIELDS];
+    for (uint8_t i = 0; i < sensor.fieldCount; i++) {
+        deadbands[i] = fieldDeadbands[getSensorFieldId(sensor, i)];
+    }
+    return reportShouldSend(state, sample.values, deadbands, sensor.fieldCount, millis(), reportHeartbeatMs);
 }
 
-static void printDHTFeeder() {
-  String jsonString;
-  StaticJsonDocument<256> dhtFeeder = readDHTFeeder();
-  serializeJson(dhtFeeder, jsonString);
-  printJson(jsonString);
-}
+// Offline log: while no line has been received from the host for
+// HOST_HEARTBEAT_TIMEOUT_MS, every record that is sent is also logged so the
+// host can fetch what it missed with log:dump
+#define HOST_HEARTBEAT_TIMEOUT_MS 30000
+static SampleLog sampleLog;
+static bool hostSeen = false;
+static unsigned long lastHostLineMs = 0;
+static int8_t logDumpTaskId = TASK_INVALID;
+static uint16_t logDumpCount = 0;
 
-static void printSoil() {
-  String jsonString;
-  StaticJsonDocument<256> soil = readSoil();
-  serializeJson(soil, jsonString);
-  printJson(jsonString);
+static bool isHostOnline() {
+    return hostSeen && millis() - lastHostLineMs < HOST_HEARTBEAT_TIMEOUT_MS;
 }
 
-static void printWeight() {
-  String jsonString;
-  StaticJsonDocument<256> weight = readWeight();
-  serializeJson(weight, jsonString);
-  printJson(jsonString);
+static void logOfflineSample(const SensorDescriptor& sensor, const SensorSample& sample) {
+    if (isHostOnline()) return;
+    uint8_t payload[SAMPLE_LOG_MAX_PAYLOAD];
+    size_t payloadLen = packSensorSample(sensor, sample, payload, sizeof(payload));
+    if (payloadLen > 0) {
+        sampleLogAppend(sampleLog, sensor.telemetryId, sample.timestamp, payload, (uint8_t)payloadLen);
+    }
 }
 
-static void printPowerMonitor() {
-  String jsonString;
-  StaticJsonDocument<1024> powerMonitor = readPowerMonitor();
-  // Adjust to new JSON structure where "value" is an array of objects {type, unit, value}
-  JsonArray values = powerMonitor["value"].as<JsonArray>();
-  if (!values.isNull()) {
+// Incoming command line, assembled byte by byte without heap allocation
+static CommandLineBuffer commandLine;
+// Complete lines waiting for the command task
+static CommandQueue commandQueue;
+static uint32_t commandOverflows = 0;  // Lines longer than COMMAND_LINE_SIZE
+
+// While a load that sags the supply is running, report the last load voltage
+// measured before it started
+static void applyFreezeLoadV(const SensorDescriptor& sensor, SensorSample& sample) {
+  for (uint8_t i = 0; i < sensor.fieldCount; i++) {
+    if (getSensorFieldId(sensor, i) != FIELD_LOAD_VOLTAGE) continue;
     if (isUseFreezeLoadV) {
-      for (JsonObject item : values) {
-        const char* type = item["type"];
-        if (type && strcmp(type, "loadVoltage") == 0) {
-          item["value"] = freezeLoadV;
-          break;
-        }
-      }
+      sample.values[i] = freezeLoadV;
     } else {
-      for (JsonObject item : values) {
-        const char* type = item["type"];
-        if (type && strcmp(type, "loadVoltage") == 0) {
-          freezeLoadV = item["value"].as<float>();
-          break;
-        }
-      }
+      freezeLoadV = sample.values[i];
+    }
+  }
+}
+
+// Battery readings drive the power level; a change rescales the telemetry
+// periods (see power_manager.h)
+static void applyPowerLevel(const SensorDescriptor& sensor, const SensorSample& sample) {
+  for (uint8_t i = 0; i < sensor.fieldCount; i++) {
+    if (getSensorFieldId(sensor, i) != FIELD_BATTERY_PERCENTAGE) continue;
+    if (updateBatteryLevel(sample.values[i])) {
+      SerialTx.print(F("[EVENT] - power:level:"));
+      SerialTx.print(powerLevelName(getPowerLevel()));
+      SerialTx.print(':');
+      SerialTx.println(sample.values[i], 1);
+      scheduleSensorTasks();
+    }
+  }
+}
+
+// A sensor that loses its reading (a DHT gone stale) is announced once, and
+// again when it recovers. Before the first reading it is simply not reported.
+static bool sensorLive[SENSOR_COUNT];
+static bool sensorLost[SENSOR_COUNT];
+
+static void trackSensorReading(uint8_t slot, const SensorDescriptor& sensor, bool valid) {
+  if (valid == sensorLive[slot]) return;
+  sensorLive[slot] = valid;
+  if (valid && !sensorLost[slot]) return;
+  sensorLost[slot] = !valid;
+  SerialTx.print(F("[EVENT] - sensor:"));
+  SerialTx.print((const __FlashStringHelper*)sensor.name);
+  SerialTx.println(valid ? F(":ok") : F(":stale"));
+}
+
+static void readSensorSample(uint8_t slot, const SensorDescriptor& sensor, SensorSample& sample) {
+  PerfScope scope(PERF_SENSOR_READ);
+  sample.valid = true;
+  sensor.read(sample);
+  trackSensorReading(slot, sensor, sample.valid);
+  if (!sample.valid) return;
+  applyFreezeLoadV(sensor, sample);
+  applyPowerLevel(sensor, sample);
+}
+
+// Read one registered sensor and send it in the current format
+static void printSensor(uint8_t slot) {
+  SensorDescriptor sensor;
+  getSensor(slot, sensor);
+  SensorSample sample;
+  readSensorSample(slot, sensor, sample);
+  if (!sample.valid || !passesReportFilter(slot, sensor, sample)) return;
+  logOfflineSample(sensor, sample);
+
+  if (telemetryFormat == TELEMETRY_FORMAT_BINARY) {
+    uint8_t payload[TELEMETRY_MAX_PAYLOAD];
+    size_t payloadLen = packSensorSample(sensor, sample, payload, sizeof(payload));
+    printBinaryRecord(sensor.telemetryId, payload, payloadLen, sample.timestamp);
+    return;
+  }
+  PerfScope scope(PERF_SERIALIZE);
+  // A newer record of the same sensor replaces one still waiting in the queue
+  serialTxBegin(TX_TELEMETRY, sensor.telemetryId);
+  SerialTx.print(F("[SEND] - "));
+  writeSensorJson(SerialTx, sensor, sample);
+  SerialTx.println();
+  serialTxEnd();
+}
+
+// === Snapshot mode ===
+// One combined record per cycle instead of one line per sensor, so the host
+// can correlate sensors and detect dropped records from the sequence number.
+
+static bool snapshotMode = false;
+static int8_t snapshotTaskId = TASK_INVALID;
+
+static void captureSnapshot(SensorSample* samples) {
+  for (uint8_t slot = 0; slot < SENSOR_COUNT; slot++) {
+    SensorDescriptor sensor;
+    getSensor(slot, sensor);
+    readSensorSample(slot, sensor, samples[slot]);
+  }
+}
+
+static uint16_t snapshotAge(unsigned long now, const SensorSample& sample) {
+  if (!sample.valid) return TELEMETRY_SNAPSHOT_NO_READING;
+  unsigned long age = now - sample.timestamp;
+  return age > TELEMETRY_SNAPSHOT_MAX_AGE ? TELEMETRY_SNAPSHOT_MAX_AGE : (uint16_t)age;
+}
+
+// Each sensor in registry order as its sample age followed by its payload
+static void printSnapshotBinary(const SensorSample* samples, unsigned long now) {
+  uint8_t payload[TELEMETRY_MAX_PAYLOAD];
+  size_t len = 0;
+  for (uint8_t slot = 0; slot < SENSOR_COUNT; slot++) {
+    SensorDescriptor sensor;
+    getSensor(slot, sensor);
+    if (len + TELEMETRY_SNAPSHOT_AGE_SIZE > sizeof(payload)) return;
+    telemetryPutU16(&payload[len], snapshotAge(now, samples[slot]));
+    len += TELEMETRY_SNAPSHOT_AGE_SIZE;
+    size_t packed = packSensorSample(sensor, samples[slot], &payload[len], sizeof(payload) - len);
+    if (packed == 0) return;
+    len += packed;
+  }
+  printBinaryRecord(TELEMETRY_ID_SNAPSHOT, payload, len, now);
+}
+
+static void printSnapshotJson(const SensorSample* samples, unsigned long now) {
+  PerfScope scope(PERF_SERIALIZE);
+  // Streamed into the record like the per-sensor lines; a record larger
+  // than the telemetry ring is counted as lost by the queue
+  uint16_t lost = getTxQueueStats().lost;
+  serialTxBegin(TX_TELEMETRY, TELEMETRY_ID_SNAPSHOT);
+  SerialTx.print(F("[SEND] - "));
+  writeSnapshotJson(SerialTx, telemetrySeq++, now, samples);
+  SerialTx.println();
+  serialTxEnd();
+  if (getTxQueueStats().lost != lost) {
+    SerialTx.println(F("[ERROR] - Snapshot too large for the transmit queue"));
+  }
+}
+
+static void printSnapshot() {
+  SensorSample samples[SENSOR_COUNT];
+  captureSnapshot(samples);
+  unsigned long now = millis();
+  // Logged per sensor, so a dump looks the same in either mode
+  for (uint8_t slot = 0; slot < SENSOR_COUNT; slot++) {
+    SensorDescriptor sensor;
+    getSensor(slot, sensor);
+    if (samples[slot].valid) logOfflineSample(sensor, samples[slot]);
+  }
+  if (telemetryFormat == TELEMETRY_FORMAT_BINARY) {
+    printSnapshotBinary(samples, now);
+  } else {
+    printSnapshotJson(samples, now);
+  }
+}
+
+static void printBinaryRecord(uint8_t sensorId, const uint8_t* payload, size_t payloadLen,
+                              unsigned long timestampMs) {
+  PerfScope scope(PERF_SERIALIZE);
+  TelemetryRecordHeader header;
+  header.sensorId = sensorId;
+  header.seq = telemetrySeq++;
+  header.timestampMs = timestampMs;
+
+  uint8_t frame[TELEMETRY_MAX_FRAME];
+  size_t frameLen = telemetryEncodeFrame(header, payload, payloadLen, frame, sizeof(frame));
+  if (frameLen > 0) {
+    serialTxBegin(TX_TELEMETRY, sensorId);
+    SerialTx.write(frame, frameLen);
+    serialTxEnd();
+  }
+}
+
+// Queue logged records as binary frames for as long as the transmit queue
+// has bulk room for a whole frame, so the dump runs at link speed without
+// blocking or pushing out live telemetry
+static void logDumpTask() {
+  SampleLogRecord record;
+  while (sampleLogPeek(sampleLog, record)) {
+    TelemetryRecordHeader header;
+    header.sensorId = record.sensorId;
+    header.seq = telemetrySeq;
+    header.timestampMs = record.timestampMs;
+    uint8_t frame[TELEMETRY_MAX_FRAME];
+    size_t frameLen = telemetryEncodeFrame(header, record.payload, record.length, frame, sizeof(frame));
+    if (frameLen > 0) {
+      if (txQueueFree(TX_BULK) < frameLen + TX_RECORD_HEADER) return;
+      serialTxBegin(TX_BULK, TX_KEY_NONE);
+      SerialTx.write(frame, frameLen);
+      serialTxEnd();
+      telemetrySeq++;
+      logDumpCount++;
     }
+    sampleLogDrop(sampleLog);
   }
-  serializeJson(powerMonitor, jsonString);
-  printJson(jsonString);
+  SerialTx.print(F("[EVENT] - log:dump:end:"));
+  SerialTx.println(logDumpCount);
+  setTaskEnabled(logDumpTaskId, false);
 }
 
-static void printJson(String jsonString) {
-  Serial.println("[SEND] - " + jsonString);
+void setTelemetryBinaryMode(bool enabled) {
+  telemetryFormat = enabled ? TELEMETRY_FORMAT_BINARY : TELEMETRY_FORMAT_JSON;
+  SerialTx.print(F("[INFO] - Telemetry format set to: "));
+  SerialTx.println(enabled ? F("binary") : F("json"));
 }
 
 void initAllSensors() {
-  // Read sensors
-  initDHT();
-  initSoil();
-  initWeight();
-  initPowerMonitor();
+  // Background ADC sampling for the power monitor and soil sensor
+  initAdcEngine();
+
+  // Every sensor in the registry
+  initRegisteredSensors();
 
   // Control devices
   initBlower();
+  long blowerSpeed;
+  if (configGetLong(CONFIG_KEY_BLOWER_SPEED, blowerSpeed)) {
+    setBlowerSpeed((int)blowerSpeed);
+  }
+  long blowerRamp;
+  if (configGetLong(CONFIG_KEY_BLOWER_RAMP_RATE, blowerRamp)) {
+    setBlowerRampRate((uint16_t)blowerRamp);
+  }
+  long blowerPwmHz;
+  if (configGetLong(CONFIG_KEY_BLOWER_PWM_HZ, blowerPwmHz)) {
+    setBlowerPwmFrequency((uint32_t)blowerPwmHz);
+  }
   initFeederMotor();
   initRelayControl();
 }
 
+// Telemetry tasks, one per registry entry, generated at compile time
+static int8_t sensorTaskIds[SENSOR_COUNT];
+static unsigned long sensorPeriods[SENSOR_COUNT];
+
+template <uint8_t Slot>
+static void sensorTask() {
+  printSensor(Slot);
+}
+
+template <uint8_t Count>
+struct SensorTasks {
+  static void registerAll() {
+    SensorTasks<Count - 1>::registerAll();
+    SensorDescriptor sensor;
+    getSensor(Count - 1, sensor);
+    sensorPeriods[Count - 1] = sensor.periodMs;
+    sensorTaskIds[Count - 1] = registerTask((const __FlashStringHelper*)sensor.taskName, sensorTask<Count - 1>,
+                                            sensor.periodMs, 1000, TASK_PRIORITY_LOW, 20000);
+  }
+};
+
+template <>
+struct SensorTasks<0> {
+  static void registerAll() {}
+};
+
+static void serialCommandTask() {
+  if (Serial.available()) {
+    controlSensor();
+  }
+}
+
+// Telemetry period of a slot, stretched while the battery is low
+static unsigned long effectiveSensorPeriod(uint8_t slot) {
+  unsigned long period = snapshotMode ? sensorPrintInterval : sensorPeriods[slot];
+  return max(kMinSensorPeriod, period) * getPowerPeriodScale();
+}
+
+// Spread the sensor tasks evenly across their periods
+static void scheduleSensorTasks() {
+  for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+    unsigned long period = effectiveSensorPeriod(i);
+    setTaskEnabled(sensorTaskIds[i], sensorServiceActive && !snapshotMode);
+    setTaskPeriod(sensorTaskIds[i], period);
+    delayTask(sensorTaskIds[i], (period / SENSOR_COUNT) * (i + 1));
+  }
+  // In snapshot mode a single task reports every sensor once per interval
+  unsigned long period = max(kMinSensorPeriod, sensorPrintInterval) * getPowerPeriodScale();
+  setTaskEnabled(snapshotTaskId, sensorServiceActive && snapshotMode);
+  setTaskPeriod(snapshotTaskId, period);
+  delayTask(snapshotTaskId, period);
+
+  // Gated sensors wake once per telemetry period
+  bool gating = isPowerGatingEnabled() && sensorServiceActive;
+  setWeightPowerSave(gating, effectiveSensorPeriod(SENSOR_WEIGHT));
+  setSoilPowerSave(gating, effectiveSensorPeriod(SENSOR_SOIL));
+}
+
 // New timer-based sensor service functions
 void initSensorService() {
   lastSensorPrintTime = millis();
-  lastStepTime = millis();
+  commandLineReset(commandLine);
+  commandQueueReset(commandQueue);
+  sampleLogReset(sampleLog, sampleLogRamStorage());
+  perfResetSlots();
+  for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+    reportReset(reportStates[i]);
+  }
+  for (uint8_t i = 0; i < FIELD_COUNT; i++) {
+    SensorFieldInfo field;
+    getSensorField(i, field);
+    fieldDeadbands[i] = field.deadband;
+  }
   sensorServiceActive = true;
-  // Distribute sensor prints across the configured interval, with a sane minimum
-  stepInterval = max(200UL, sensorPrintInterval / kTotalSensors);
-  Serial.println("[INFO] - Sensor service initialized in background mode");
-}
 
-void updateSensorService() {
-  if (!sensorServiceActive) return;
-  
-  // If there are incoming commands, skip sensor work to avoid blocking control path
-  if (Serial.available()) return;
-
-  unsigned long currentMillis = millis();
+  // Command intake runs first in every scheduler pass; queued commands
+  // are executed one per pass
+  registerTask(F("serial_rx"), serialCommandTask, 0, 0, TASK_PRIORITY_CRITICAL, 2000);
+  registerTask(F("command"), commandTask, 0, 0, TASK_PRIORITY_HIGH, 20000);
+  registerTask(F("weight_sampler"), updateWeightSampler, 0, 0, TASK_PRIORITY_HIGH, 500);
+  registerTask(F("feeder_motor"), updateFeederMotor, 10, 10, TASK_PRIORITY_HIGH, 2000);
+  // At most one staggered DHT conversion per run
+  registerTask(F("dht"), updateDHT, 100, 100, TASK_PRIORITY_HIGH, 6000);
+#if SOIL_POWER_PIN >= 0
+  registerTask(F("soil_power"), updateSoilPower, 20, 20, TASK_PRIORITY_HIGH, 1000);
+#endif
 
-  // Time-sliced: handle one sensor per tick
-  if (currentMillis - lastStepTime >= stepInterval) {
-    switch (sensorIndex) {
-      case 0: printDHTSystem();    break;
-      case 1: printDHTFeeder();    break;
-      case 2: printSoil();         break;
-      case 3: printWeight();       break;
-      case 4: printPowerMonitor(); break;
-    }
-    sensorIndex = (sensorIndex + 1) % kTotalSensors;
-    lastStepTime = currentMillis;
+  SensorTasks<SENSOR_COUNT>::registerAll();
+  // A stored interval overrides the registry periods, as sensors:interval does
+  long storedInterval;
+  if (configGetLong(CONFIG_KEY_SENSOR_INTERVAL, storedInterval) && storedInterval > 0) {
+    sensorPrintInterval = (unsigned long)storedInterval;
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+      sensorPeriods[i] = sensorPrintInterval;
+    }
   }
+  snapshotTaskId = registerTask(F("snapshot"), printSnapshot, sensorPrintInterval, 1000, TASK_PRIORITY_LOW, 20000);
+  logDumpTaskId = registerTask(F("log_dump"), logDumpTask, 0, 0, TASK_PRIORITY_LOW, 5000);
+  // Tasks that read the ADC engine's sums, for power gating
+  addPowerAdcReader(sensorTaskIds[SENSOR_POWER_MONITOR]);
+  addPowerAdcReader(sensorTaskIds[SENSOR_SOIL]);
+  addPowerAdcReader(snapshotTaskId);
+  setTaskEnabled(logDumpTaskId, false);
+  scheduleSensorTasks();
+  SerialTx.println(F("[INFO] - Sensor service initialized in background mode"));
 }
 
 void setSensorPrintInterval(unsigned long intervalMs) {
   sensorPrintInterval = intervalMs;
-  stepInterval = max(200UL, sensorPrintInterval / kTotalSensors);
-  Serial.println("[INFO] - Sensor print interval set to: " + String(intervalMs) + "ms");
+  for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+    sensorPeriods[i] = intervalMs;
+  }
+  scheduleSensorTasks();
+  configSetLong(CONFIG_KEY_SENSOR_INTERVAL, (long)intervalMs);
+  SerialTx.print(F("[INFO] - Sensor print interval set to: "));
+  SerialTx.print(intervalMs);
+  SerialTx.println(F("ms"));
 }
 
 // Sensor service control functions
 void startSensorService() {
   sensorServiceActive = true;
   lastSensorPrintTime = millis();
-  Serial.println("[INFO] - Sensor service started");
+  scheduleSensorTasks();
+  SerialTx.println(F("[INFO] - Sensor service started"));
 }
 
 void stopSensorService() {
   sensorServiceActive = false;
-  Serial.println("[INFO] - Sensor service stopped");
+  scheduleSensorTasks();
+  SerialTx.println(F("[INFO] - Sensor service stopped"));
 }
 
 bool isSensorServiceActive() {
   return sensorServiceActive;
 }
 
+// === Command handlers ===
+// Each handler gets the text after "<device>:<verb>:" and owns that buffer.
+
+static void cmdSensorsStart(char*) { startSensorService(); }
+static void cmdSensorsStop(char*) { stopSensorService(); }
+
+static void cmdSensorsInterval(char* args) {
+    long interval;
+    if (commandParseLong(args, interval) && interval > 0) {
+        setSensorPrintInterval((unsigned long)interval);
+    } else {
+        SerialTx.println(F("[ERROR] - Invalid sensor interval"));
+    }
+}
+
+// === Streamed reports ===
+// A reply of more than a few lines would overflow the control ring if it
+// were printed at once. The command only starts the report; the command
+// task then prints it a line at a time, each line once the ring has room
+// for the longest one, and holds all but stop commands until it is done so
+// replies stay in command order.
+
+// Longest report line plus its record header: the power monitor's sensor
+// line is 229 bytes with every counter at its widest
+#define REPORT_LINE_ROOM 240
+static_assert(REPORT_LINE_ROOM <= TX_CONTROL_SIZE, "A report line must fit in the control ring");
+
+enum ReportKind {
+    REPORT_NONE,
+    REPORT_SENSORS_STATUS,
+    REPORT_STATS,
+    REPORT_SCHEDULE,
+    REPORT_LINK
+};
+
+static ReportKind activeReport = REPORT_NONE;
+static uint8_t reportLine = 0;
+
+// [INFO] - Task <name> prio=<p> period=<ms> runs=<n> maxUs=<us> missed=<n> overruns=<n> [(disabled)]
+static bool printTaskStatus(uint8_t index) {
+    TaskInfo task;
+    if (!getTaskInfo(index, task)) return false;
+    SerialTx.print(F("[INFO] - Task "));
+    SerialTx.print(task.name);
+    SerialTx.print(F(" prio="));
+    SerialTx.print(task.priority);
+    SerialTx.print(F(" period="));
+    SerialTx.print(task.periodMs);
+    SerialTx.print(F("ms runs="));
+    SerialTx.print(task.timing->count);
+    SerialTx.print(F(" maxUs="));
+    SerialTx.print(task.timing->maxUs);
+    SerialTx.print(F(" missed="));
+    SerialTx.print(task.deadlineMisses);
+    SerialTx.print(F(" overruns="));
+    SerialTx.print(task.budgetOverruns);
+    if (!task.enabled) SerialTx.print(F(" (disabled)"));
+    SerialTx.println();
+    return true;
+}
+
+// [INFO] - Sensor <task> (<name>): <type>[<unit>],... period=<ms> sent=<n> suppressed=<n>
+static void printSensorStatus(uint8_t slot) {
+    SensorDescriptor sensor;
+    getSensor(slot, sensor);
+    SerialTx.print(F("[INFO] - Sensor "));
+    SerialTx.print((const __FlashStringHelper*)sensor.taskName);
+    SerialTx.print(F(" ("));
+    SerialTx.print((const __FlashStringHelper*)sensor.name);
+    SerialTx.print(F("): "));
+    for (uint8_t f = 0; f < sensor.fieldCount; f++) {
+        SensorFieldInfo field;
+        getSensorField(getSensorFieldId(sensor, f), field);
+        if (f > 0) SerialTx.print(',');
+        SerialTx.print((const __FlashStringHelper*)field.type);
+        SerialTx.print('[');
+        SerialTx.print((const __FlashStringHelper*)field.unit);
+        SerialTx.print(']');
+    }
+    SerialTx.print(F(" period="));
+    SerialTx.print(sensorPeriods[slot]);
+    SerialTx.print(F("ms sent="));
+    SerialTx.print(reportStates[slot].sent);
+    SerialTx.print(F(" suppressed="));
+    SerialTx.println(reportStates[slot].suppressed);
+}
+
+static bool printSensorsStatusLine(uint8_t line) {
+    switch (line) {
+        case 0:
+            SerialTx.print(F("[INFO] - Sensor service status: "));
+            SerialTx.println(isSensorServiceActive() ? F("ACTIVE") : F("INACTIVE"));
+            return true;
+        case 1:
+            SerialTx.print(F("[INFO] - Print interval: "));
+            SerialTx.print(sensorPrintInterval);
+            SerialTx.println(F("ms"));
+            return true;
+        case 2:
+            SerialTx.print(F("[INFO] - Telemetry format: "));
+            SerialTx.println(telemetryFormat == TELEMETRY_FORMAT_BINARY ? F("binary") : F("json"));
+            return true;
+        case 3:
+            SerialTx.print(F("[INFO] - Snapshot mode: "));
+            SerialTx.println(snapshotMode ? F("on") : F("off"));
+            return true;
+        case 4:
+            SerialTx.print(F("[INFO] - Report mode: "));
+            SerialTx.print(reportMode == REPORT_MODE_ON_CHANGE ? F("change") : F("all"));
+            SerialTx.print(F(", heartbeat "));
+            SerialTx.print(reportHeartbeatMs);
+            SerialTx.println(F("ms"));
+            return true;
+    }
+    line -= 5;
+    if (line < SENSOR_COUNT) {
+        printSensorStatus(line);
+        return true;
+    }
+    line -= SENSOR_COUNT;
+    switch (line) {
+        case 0:
+            SerialTx.print(F("[INFO] - Blower output: "));
+            SerialTx.print(getBlowerOutput());
+            SerialTx.print(F(" ramp="));
+            SerialTx.print(getBlowerRampRate());
+            SerialTx.print(F("/s pwm="));
+            SerialTx.print(getBlowerPwmFrequency());
+            SerialTx.println(F("Hz"));
+            return true;
+        case 1:
+            SerialTx.print(F("[INFO] - DHT reading age: system "));
+            SerialTx.print(getDHTReadingAge(DHT_INDEX_SYSTEM));
+            SerialTx.print(F("ms, feeder "));
+            SerialTx.print(getDHTReadingAge(DHT_INDEX_FEEDER));
+            SerialTx.println(F("ms"));
+            return true;
+        case 2:
+            SerialTx.print(F("[INFO] - Command queue: depth="));
+            SerialTx.print(commandQueueDepth(commandQueue));
+            SerialTx.print('/');
+            SerialTx.print(commandQueueCapacity());
+            SerialTx.print(F(" max="));
+            SerialTx.print(commandQueue.stats.maxDepth);
+            SerialTx.print(F(" queued="));
+            SerialTx.print(commandQueue.stats.queued);
+            SerialTx.print(F(" executed="));
+            SerialTx.print(commandQueue.stats.executed);
+            SerialTx.print(F(" rejected="));
+            SerialTx.print(commandQueue.stats.rejected);
+            SerialTx.print(F(" overflows="));
+            SerialTx.println(commandOverflows);
+            return true;
+        case 3:
+            SerialTx.print(F("[INFO] - Scheduler tasks: "));
+            SerialTx.print(getTaskCount());
+            SerialTx.print('/');
+            SerialTx.println(MAX_TASKS);
+            return true;
+    }
+    return printTaskStatus(line - 4);
+}
+
+// [STATS] - <name> n=<count> min=<us> mean=<us> max=<us> hist=<b0,b1,...>
+static void printPerfStat(const __FlashStringHelper* name, const PerfStat& stat) {
+    SerialTx.print(F("[STATS] - "));
+    SerialTx.print(name);
+    SerialTx.print(F(" n="));
+    SerialTx.print(stat.count);
+    SerialTx.print(F(" min="));
+    SerialTx.print(stat.count > 0 ? stat.minUs : 0);
+    SerialTx.print(F(" mean="));
+    SerialTx.print(perfMean(stat));
+    SerialTx.print(F(" max="));
+    SerialTx.print(stat.maxUs);
+    SerialTx.print(F(" hist="));
+    for (uint8_t i = 0; i < PERF_HISTOGRAM_BINS; i++) {
+        if (i > 0) SerialTx.print(',');
+        SerialTx.print(stat.histogram[i]);
+    }
+    SerialTx.println();
+}
+
+static bool printStatsLine(uint8_t line) {
+    if (line < PERF_SLOT_COUNT) {
+        printPerfStat(perfSlotName((PerfSlot)line), perfSlot((PerfSlot)line));
+        return true;
+    }
+    TaskInfo task;
+    if (!getTaskInfo(line - PERF_SLOT_COUNT, task)) return false;
+    printPerfStat(task.name, *task.timing);
+    return true;
+}
+
+// Header, then one line per schedule entry in use
+static bool printScheduleLine(uint8_t line) {
+    if (line == 0) {
+        const ScheduleStats& stats = getScheduleStats();
+        SerialTx.print(F("[INFO] - Schedule: clock "));
+        SerialTx.print(scheduleClockValid() ? F("synced") : F("not synced"));
+        SerialTx.print(F(" fired="));
+        SerialTx.print(stats.fired);
+        SerialTx.print(F(" missed="));
+        SerialTx.println(stats.missed);
+        return true;
+    }
+    if (line > SCHEDULE_MAX_ENTRIES) return false;
+    // [INFO] - Schedule <i>: <daily hh:mm|every <n>min> amount=<g> blower=<s> tolerance=<g> [disabled]
+    uint8_t i = line - 1;
+    ScheduleEntry entry;
+    scheduleGet(i, entry);
+    if (entry.kind == SCHEDULE_UNUSED) return true;
+    SerialTx.print(F("[INFO] - Schedule "));
+    SerialTx.print(i);
+    if (entry.kind == SCHEDULE_DAILY) {
+        SerialTx.print(F(": daily "));
+        SerialTx.print(entry.minutes / 60);
+        SerialTx.print(entry.minutes % 60 < 10 ? F(":0") : F(":"));
+        SerialTx.print(entry.minutes % 60);
+    } else {
+        SerialTx.print(F(": every "));
+        SerialTx.print(entry.minutes);
+        SerialTx.print(F("min"));
+    }
+    SerialTx.print(F(" amount="));
+    SerialTx.print(entry.amountG);
+    SerialTx.print(F("g blower="));
+    SerialTx.print(entry.blowerS);
+    SerialTx.print(F("s tolerance="));
+    SerialTx.print(entry.toleranceG);
+    SerialTx.print(F("g"));
+    if (!entry.enabled) SerialTx.print(F(" disabled"));
+    SerialTx.println();
+    return true;
+}
+
+static bool printLinkStatusLine(uint8_t line) {
+    switch (line) {
+        case 0:
+            SerialTx.print(F("[INFO] - Link: "));
+            SerialTx.print(getLinkBaud());
+            SerialTx.print(F(" baud"));
+            if (isLinkSwitchPending()) SerialTx.print(F(" (switch pending)"));
+            SerialTx.print(F(" idle fallback="));
+            SerialTx.print(getLinkIdleFallback());
+            SerialTx.println(F("ms"));
+            return true;
+        case 1: {
+            const TxQueueStats& tx = getTxQueueStats();
+            SerialTx.print(F("[INFO] - TX queue: records="));
+            SerialTx.print(tx.records);
+            SerialTx.print(F(" dropped="));
+            SerialTx.print(tx.dropped);
+            SerialTx.print(F(" coalesced="));
+            SerialTx.print(tx.coalesced);
+            SerialTx.print(F(" lost="));
+            SerialTx.print(tx.lost);
+            SerialTx.print(F(" peak control="));
+            SerialTx.print(tx.maxControl);
+            SerialTx.print('/');
+            SerialTx.print(TX_CONTROL_SIZE);
+            SerialTx.print(F(" telemetry="));
+            SerialTx.print(tx.maxTelemetry);
+            SerialTx.print('/');
+            SerialTx.println(TX_TELEMETRY_SIZE);
+            return true;
+        }
+        case 2:
+            printLinkCapabilities();
+            return true;
+    }
+    return false;
+}
+
+// Print report lines while the control ring has room; true while unfinished
+static bool continueReport() {
+    while (activeReport != REPORT_NONE && txQueueFree(TX_CONTROL) >= REPORT_LINE_ROOM) {
+        bool printed = false;
+        switch (activeReport) {
+            case REPORT_SENSORS_STATUS: printed = printSensorsStatusLine(reportLine); break;
+            case REPORT_STATS:          printed = printStatsLine(reportLine); break;
+            case REPORT_SCHEDULE:       printed = printScheduleLine(reportLine); break;
+            case REPORT_LINK:           printed = printLinkStatusLine(reportLine); break;
+            case REPORT_NONE:           break;
+        }
+        if (printed) {
+            reportLine++;
+        } else {
+            activeReport = REPORT_NONE;
+        }
+    }
+    return activeReport != REPORT_NONE;
+}
+
+static void startReport(ReportKind kind) {
+    activeReport = kind;
+    reportLine = 0;
+    continueReport();
+}
+
+static void cmdStatsDump(char*) { startReport(REPORT_STATS); }
+
+static void cmdStatsReset(char*) {
+    perfResetSlots();
+    resetTaskStats();
+    SerialTx.println(F("[INFO] - Timing statistics reset"));
+}
+
+static void cmdSensorsStatus(char*) { startReport(REPORT_SENSORS_STATUS); }
+
+static void cmdSensorsFormat(char* args) {
+    if (strcmp(args, "binary") == 0) {
+        setTelemetryBinaryMode(true);
+    } else if (strcmp(args, "json") == 0) {
+        setTelemetryBinaryMode(false);
+    }
+}
+
+static void cmdSensorsSnapshot(char* args) {
+    if (strcmp(args, "on") == 0) {
+        snapshotMode = true;
+    } else if (strcmp(args, "off") == 0) {
+        snapshotMode = false;
+    } else {
+        return;
+    }
+    scheduleSensorTasks();
+    SerialTx.print(F("[INFO] - Snapshot mode set to: "));
+    SerialTx.println(args);
+}
+
+static void cmdSensorsReport(char* args) {
+    if (strcmp(args, "change") == 0) {
+        reportMode = REPORT_MODE_ON_CHANGE;
+    } else if (strcmp(args, "all") == 0) {
+        reportMode = REPORT_MODE_ALL;
+    } else {
+        return;
+    }
+    // Start from a full report so the host has every value
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+        reportStates[i].primed = false;
+    }
+    SerialTx.print(F("[INFO] - Report mode set to: "));
+    SerialTx.println(args);
+}
+
+static void cmdSensorsHeartbeat(char* args) {
+    long heartbeat;
+    if (commandParseLong(args, heartbeat) && heartbeat > 0) {
+        reportHeartbeatMs = (unsigned long)heartbeat;
+        SerialTx.print(F("[INFO] - Report heartbeat set to: "));
+        SerialTx.print(reportHeartbeatMs);
+        SerialTx.println(F("ms"));
+    } else {
+        SerialTx.println(F("[ERROR] - Invalid report heartbeat"));
+    }
+}
+
+// <field>,<band> for an absolute band or <field>,<band>% for a relative one
+static void cmdSensorsDeadband(char* args) {
+    char* comma = strchr(args, ',');
+    if (comma == NULL) {
+        SerialTx.println(F("[ERROR] - Invalid deadband format. Expected: field,value or field,value%"));
+        return;
+    }
+    *comma = '\0';
+    char* valueText = comma + 1;
+
+    int8_t field = findSensorField(args);
+    if (field == SENSOR_INVALID_FIELD) {
+        SerialTx.print(F("[ERROR] - Unknown field: "));
+        SerialTx.println(args);
+        return;
+    }
+
+    char* end;
+    float band = (float)strtod(valueText, &end);
+    bool relative = (*end == '%');
+    if (end == valueText || (relative ? end[1] != '\0' : *end != '\0') || band < 0.0f) {
+        SerialTx.println(F("[ERROR] - Invalid deadband value"));
+        return;
+    }
+    fieldDeadbands[field].relative = relative;
+    fieldDeadbands[field].band = relative ? band / 100.0f : band;
+    SerialTx.print(F("[INFO] - Deadband for "));
+    SerialTx.print(args);
+    SerialTx.print(F(" set to: "));
+    SerialTx.println(valueText);
+}
+
+static void cmdWeightCalibrate(char*) { calibrateWeight(); }
+
+static void cmdWeightScale(char* args) {
+    char* end;
+    float factor = (float)strtod(args, &end);
+    if (end == args || *end != '\0') {
+        SerialTx.println(F("[ERROR] - Invalid scale factor"));
+        return;
+    }
+    if (!setWeightScaleFactor(factor)) {
+        SerialTx.println(F("[ERROR] - Scale factor out of range, magnitude must be 31 to 10000000"));
+        return;
+    }
+    SerialTx.print(F("[INFO] - Weight scale factor set to: "));
+    SerialTx.println(getWeightScaleFactor(), 1);
+}
+
+// <index>,<hhmm|minutes>,<amount g>,<blower s>,<tolerance g>
+static void setScheduleEntry(char* args, uint8_t kind) {
+    long params[5];
+    ScheduleEntry entry;
+    bool parsed = commandParseLongList(args, params, 5) == 5 &&
+                  params[0] >= 0 && params[0] < SCHEDULE_MAX_ENTRIES &&
+                  params[1] >= 0 && params[1] <= 0xFFFF && params[2] > 0 && params[2] <= 0xFFFF &&
+                  params[3] >= 0 && params[3] <= 0xFF && params[4] >= 0 && params[4] <= 0xFF;
+    if (parsed) {
+        entry.kind = kind;
+        entry.enabled = true;
+        // Daily times are given as hhmm
+        entry.minutes = (uint16_t)(kind == SCHEDULE_DAILY ? (params[1] / 100) * 60 + params[1] % 100 : params[1]);
+        entry.amountG = (uint16_t)params[2];
+        entry.blowerS = (uint8_t)params[3];
+        entry.toleranceG = (uint8_t)params[4];
+        if (kind == SCHEDULE_DAILY && params[1] % 100 >= 60) parsed = false;
+    }
+    if (!parsed || !scheduleSet((uint8_t)params[0], entry)) {
+        SerialTx.println(F("[ERROR] - Invalid schedule entry. Expected: index,time,feedAmount,blowerDuration,weightTolerance"));
+        return;
+    }
+    SerialTx.print(F("[INFO] - Schedule entry "));
+    SerialTx.print(params[0]);
+    SerialTx.println(F(" set"));
+}
+
+static void cmdScheduleDaily(char* args) { setScheduleEntry(args, SCHEDULE_DAILY); }
+static void cmdScheduleEvery(char* args) { setScheduleEntry(args, SCHEDULE_INTERVAL); }
+
+static bool parseScheduleIndex(const char* args, uint8_t& index) {
+    long value;
+    if (!commandParseLong(args, value) || value < 0 || value >= SCHEDULE_MAX_ENTRIES) {
+        SerialTx.println(F("[ERROR] - Invalid schedule index"));
+        return false;
+    }
+    index = (uint8_t)value;
+    return true;
+}
+
+static void cmdScheduleClear(char* args) {
+    uint8_t index;
+    if (parseScheduleIndex(args, index) && scheduleClear(index)) {
+        SerialTx.print(F("[INFO] - Schedule entry "));
+        SerialTx.print(index);
+        SerialTx.println(F(" cleared"));
+    }
+}
+
+static void setScheduleEnabled(char* args, bool enabled) {
+    uint8_t index;
+    if (!parseScheduleIndex(args, index)) return;
+    if (scheduleSetEnabled(index, enabled)) {
+        SerialTx.print(F("[INFO] - Schedule entry "));
+        SerialTx.print(index);
+        SerialTx.println(enabled ? F(" enabled") : F(" disabled"));
+    } else {
+        SerialTx.println(F("[ERROR] - Schedule entry is empty"));
+    }
+}
+
+static void cmdScheduleEnable(char* args) { setScheduleEnabled(args, true); }
+static void cmdScheduleDisable(char* args) { setScheduleEnabled(args, false); }
+
+static void cmdScheduleList(char*) { startReport(REPORT_SCHEDULE); }
+
+// <epoch seconds UTC>[,<minutes east of UTC>]
+static void cmdTimeSync(char* args) {
+    long params[2] = { 0, scheduleTzMinutes() };
+    int8_t count = commandParseLongList(args, params, 2);
+    if (count < 1 || params[0] <= 0 || params[1] < -720 || params[1] > 840) {
+        SerialTx.println(F("[ERROR] - Invalid time sync. Expected: epochSeconds[,tzMinutes]"));
+        return;
+    }
+    scheduleSyncClock((uint32_t)params[0], (int16_t)params[1]);
+    SerialTx.print(F("[INFO] - Clock synced: "));
+    SerialTx.print(scheduleEpochNow());
+    SerialTx.print(F(" tz="));
+    SerialTx.print(scheduleTzMinutes());
+    SerialTx.println(F("min"));
+}
+
+static void cmdTimeStatus(char*) {
+    if (!scheduleClockValid()) {
+        SerialTx.println(F("[INFO] - Clock not synced"));
+        return;
+    }
+    SerialTx.print(F("[INFO] - Clock: "));
+    SerialTx.print(scheduleEpochNow());
+    SerialTx.print(F(" tz="));
+    SerialTx.print(scheduleTzMinutes());
+    SerialTx.println(F("min"));
+}
+
+static void cmdLogDump(char*) {
+    logDumpCount = 0;
+    SerialTx.print(F("[EVENT] - log:dump:start:"));
+    SerialTx.println(sampleLog.records);
+    setTaskEnabled(logDumpTaskId, true);
+}
+
+static void cmdLogClear(char*) {
+    sampleLogReset(sampleLog, sampleLog.storage);
+    SerialTx.println(F("[INFO] - Sample log cleared"));
+}
+
+static void cmdLogStatus(char*) {
+    SerialTx.print(F("[INFO] - Sample log: host "));
+    SerialTx.print(isHostOnline() ? F("online") : F("offline"));
+    SerialTx.print(F(" records="));
+    SerialTx.print(sampleLog.records);
+    SerialTx.print(F(" bytes="));
+    SerialTx.print(sampleLog.used);
+    SerialTx.print('/');
+    SerialTx.print(sampleLog.storage->capacity);
+    SerialTx.print(F(" logged="));
+    SerialTx.print(sampleLog.logged);
+    SerialTx.print(F(" dropped="));
+    SerialTx.println(sampleLog.dropped);
+}
+
+static void cmdConfigStatus(char*) {
+    const ConfigStoreStats& stats = getConfigStoreStats();
+    SerialTx.print(F("[INFO] - Config store: records="));
+    SerialTx.print(stats.validRecords);
+    SerialTx.print(F(" bad="));
+    SerialTx.print(stats.badRecords);
+    SerialTx.print(F(" head="));
+    SerialTx.print(stats.head);
+    SerialTx.print('/');
+    SerialTx.print(CONFIG_SLOT_COUNT);
+    SerialTx.print(F(" seq="));
+    SerialTx.print(stats.seq);
+    SerialTx.print(F(" writes="));
+    SerialTx.println(stats.writes);
+}
+
+static void cmdPowerStatus(char*) {
+    const PowerStats& stats = getPowerStats();
+    unsigned long window = millis() - stats.sinceMs;
+    // Share of time asleep in 0.1 %, the proxy for the CPU's current draw
+    unsigned long idlePermille = window > 0 ? (unsigned long)((uint64_t)stats.idleMs * 1000 / window) : 0;
+    SerialTx.print(F("[INFO] - Power: level="));
+    SerialTx.print(powerLevelName(getPowerLevel()));
+    SerialTx.print(F(" scale=x"));
+    SerialTx.print(getPowerPeriodScale());
+    SerialTx.print(F(" battery low="));
+    SerialTx.print(getBatteryLowPct());
+    SerialTx.print(F("% critical="));
+    SerialTx.print(getBatteryCriticalPct());
+    SerialTx.println('%');
+    SerialTx.print(F("[INFO] - Idle sleep: "));
+    SerialTx.print(isPowerIdleEnabled() ? F("on") : F("off"));
+    SerialTx.print(F(" sleeps="));
+    SerialTx.print(stats.sleeps);
+    SerialTx.print(F(" idle="));
+    SerialTx.print(idlePermille / 10);
+    SerialTx.print('.');
+    SerialTx.print(idlePermille % 10);
+    SerialTx.print(F("% over "));
+    SerialTx.print(window);
+    SerialTx.println(F("ms"));
+    SerialTx.print(F("[INFO] - Power gating: "));
+    SerialTx.print(isPowerGatingEnabled() ? F("on") : F("off"));
+    SerialTx.print(F(" hx711="));
+    SerialTx.println(isWeightPoweredDown() ? F("down") : F("up"));
+}
+
+static bool parseOnOff(const char* args, bool& on) {
+    if (strcmp(args, "on") == 0) {
+        on = true;
+    } else if (strcmp(args, "off") == 0) {
+        on = false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static void cmdPowerIdle(char* args) {
+    bool on;
+    if (!parseOnOff(args, on)) return;
+    setPowerIdleEnabled(on);
+    resetPowerStats();
+    SerialTx.print(F("[INFO] - Idle sleep set to: "));
+    SerialTx.println(args);
+}
+
+static void cmdPowerGate(char* args) {
+    bool on;
+    if (!parseOnOff(args, on)) return;
+    setPowerGatingEnabled(on);
+    scheduleSensorTasks();
+    SerialTx.print(F("[INFO] - Power gating set to: "));
+    SerialTx.println(args);
+}
+
+// <low %>,<critical %>; 0 disables a level
+static void cmdPowerBattery(char* args) {
+    long params[2];
+    if (commandParseLongList(args, params, 2) != 2 || params[0] < 0 || params[1] < 0 ||
+        !setBatteryThresholds((uint8_t)min(params[0], 255L), (uint8_t)min(params[1], 255L))) {
+        SerialTx.println(F("[ERROR] - Invalid battery thresholds. Expected: lowPercent,criticalPercent"));
+        return;
+    }
+    SerialTx.print(F("[INFO] - Battery thresholds set to: low="));
+    SerialTx.print(getBatteryLowPct());
+    SerialTx.print(F("% critical="));
+    SerialTx.print(getBatteryCriticalPct());
+    SerialTx.println('%');
+}
+
+static void cmdLinkBaud(char* args) {
+    long baud;
+    if (!commandParseLong(args, baud) || baud <= 0 || !linkRequestBaud((unsigned long)baud)) {
+        SerialTx.println(F("[ERROR] - Unsupported baud rate or switch already pending"));
+    }
+}
+
+static void cmdLinkAck(char*) {
+    if (!linkAcknowledge()) {
+        SerialTx.println(F("[ERROR] - No baud switch pending"));
+    }
+}
+
+// Idle fallback in ms, 0 = off
+static void cmdLinkIdle(char* args) {
+    long idleMs;
+    if (!commandParseLong(args, idleMs) || idleMs < 0) {
+        SerialTx.println(F("[ERROR] - Invalid link idle time"));
+        return;
+    }
+    setLinkIdleFallback((unsigned long)idleMs);
+    SerialTx.print(F("[INFO] - Link idle fallback set to: "));
+    SerialTx.print(idleMs);
+    SerialTx.println(F("ms"));
+}
+
+static void cmdLinkStatus(char*) { startReport(REPORT_LINK); }
+
+static void cmdFeederStart(char* args) {
+    // Parse parameters: feedAmount,blowerDuration,weightTolerance (all required)
+    long params[3];
+    if (commandParseLongList(args, params, 3) == 3) {
+        startFeederSequence((int)params[0], (int)params[1], (int)params[2]);
+    } else {
+        SerialTx.println(F("[ERROR] - Invalid feeder start parameters format. Expected: feedAmount,blowerDuration,weightTolerance"));
+    }
+}
+
+static void cmdFeederStop(char*) { stopFeederSequence(); }
+
+static void cmdFeederModel(char* args) {
+    if (strcmp(args, "reset") == 0) {
+        resetDosingModel();
+    } else {
+        printDosingModel();
+    }
+}
+
+static void cmdBlowerStart(char*) {
+    isUseFreezeLoadV = true;
+    startBlower();
+}
+
+static void cmdBlowerStop(char*) {
+    isUseFreezeLoadV = false;
+    stopBlower();
+}
+
+static void cmdBlowerSpeed(char* args) {
+    long speed;
+    if (commandParseLong(args, speed)) {
+        setBlowerSpeed((int)speed);
+        configSetLong(CONFIG_KEY_BLOWER_SPEED, constrain(speed, 0L, 255L));
+    }
+}
+
+static void cmdBlowerRamp(char* args) {
+    long rate;
+    if (commandParseLong(args, rate) && rate >= 0 && rate <= 0xFFFF) {
+        setBlowerRampRate((uint16_t)rate);
+        configSetLong(CONFIG_KEY_BLOWER_RAMP_RATE, rate);
+        SerialTx.print(F("[INFO] - Blower ramp rate set to: "));
+        SerialTx.print(rate);
+        SerialTx.println(F("/s"));
+    } else {
+        SerialTx.println(F("[ERROR] - Invalid blower ramp rate"));
+    }
+}
+
+static void cmdBlowerPwm(char* args) {
+    long hz;
+    uint32_t actual = 0;
+    if (commandParseLong(args, hz) && hz > 0) {
+        actual = setBlowerPwmFrequency((uint32_t)hz);
+    }
+    if (actual == 0) {
+        SerialTx.print(F("[ERROR] - Invalid blower PWM frequency ("));
+        SerialTx.print(BLOWER_PWM_MIN_HZ);
+        SerialTx.print('-');
+        SerialTx.print(BLOWER_PWM_MAX_HZ);
+        SerialTx.println(F("Hz)"));
+        return;
+    }
+    configSetLong(CONFIG_KEY_BLOWER_PWM_HZ, hz);
+    SerialTx.print(F("[INFO] - Blower PWM frequency set to: "));
+    SerialTx.print(actual);
+    SerialTx.println(F("Hz"));
+}
+
+static void cmdBlowerDirection(char* args) {
+    if (strcmp(args, "reverse") == 0) {
+        setBlowerDirection(true);
+    } else if (strcmp(args, "normal") == 0) {
+        setBlowerDirection(false);
+    }
+}
+
+// Optional pulse length in ms; the default when absent
+static bool parsePulseLength(const char* args, uint16_t& pulseMs) {
+    pulseMs = FEEDER_MOTOR_PULSE_MS;
+    if (*args == '\0') return true;
+    long value;
+    if (!commandParseLong(args, value) || value <= 0 || value > FEEDER_MOTOR_MAX_PULSE_MS) {
+        SerialTx.println(F("[ERROR] - Invalid feeder motor pulse length"));
+        return false;
+    }
+    pulseMs = (uint16_t)value;
+    return true;
+}
+
+static void cmdFeederMotorOpen(char* args) {
+    uint16_t pulseMs;
+    if (parsePulseLength(args, pulseMs)) feederMotorOpen(pulseMs);
+}
+
+static void cmdFeederMotorClose(char* args) {
+    uint16_t pulseMs;
+    if (parsePulseLength(args, pulseMs)) feederMotorClose(pulseMs);
+}
+
+static void cmdRelayLed(char* args) {
+    if (strcmp(args, "on") == 0) {
+        isUseFreezeLoadV = true;
+        relayLedOn();
+    } else if (strcmp(args, "off") == 0) {
+        isUseFreezeLoadV = false;
+        relayLedOff();
+    }
+}
+
+static void cmdRelayFan(char* args) {
+    if (strcmp(args, "on") == 0) {
+        isUseFreezeLoadV = true;
+        relayFanOn();
+    } else if (strcmp(args, "off") == 0) {
+        isUseFreezeLoadV = false;
+        relayFanOff();
+    }
+}
+
+static void cmdRelayAll(char* args) {
+    if (strcmp(args, "off") == 0) {
+        isUseFreezeLoadV = false;
+        relayAllOff();
+    }
+}
+
+// === Command table (device and verb strings live in flash) ===
+static const char kDevSensors[] PROGMEM = "sensors";
+static const char kDevWeight[] PROGMEM = "weight";
+static const char kDevFeeder[] PROGMEM = "feeder";
+static const char kDevBlower[] PROGMEM = "blower";
+static const char kDevFeederMotor[] PROGMEM = "feedermotor";
+static const char kDevRelay[] PROGMEM = "relay";
+static const char kDevStats[] PROGMEM = "stats";
+static const char kDevConfig[] PROGMEM = "config";
+static const char kDevLog[] PROGMEM = "log";
+static const char kDevSchedule[] PROGMEM = "schedule";
+static const char kDevTime[] PROGMEM = "time";
+static const char kDevPower[] PROGMEM = "power";
+static const char kDevLink[] PROGMEM = "link";
+
+static const char kVerbStart[] PROGMEM = "start";
+static const char kVerbStop[] PROGMEM = "stop";
+static const char kVerbInterval[] PROGMEM = "interval";
+static const char kVerbStatus[] PROGMEM = "status";
+static const char kVerbFormat[] PROGMEM = "format";
+static const char kVerbSnapshot[] PROGMEM = "snapshot";
+static const char kVerbReport[] PROGMEM = "report";
+static const char kVerbHeartbeat[] PROGMEM = "heartbeat";
+static const char kVerbDeadband[] PROGMEM = "deadband";
+static const char kVerbCalibrate[] PROGMEM = "calibrate";
+static const char kVerbScale[] PROGMEM = "scale";
+static const char kVerbSpeed[] PROGMEM = "speed";
+static const char kVerbDirection[] PROGMEM = "direction";
+static const char kVerbRamp[] PROGMEM = "ramp";
+static const char kVerbPwm[] PROGMEM = "pwm";
+static const char kVerbModel[] PROGMEM = "model";
+static const char kVerbDaily[] PROGMEM = "daily";
+static const char kVerbEvery[] PROGMEM = "every";
+static const char kVerbEnable[] PROGMEM = "enable";
+static const char kVerbDisable[] PROGMEM = "disable";
+static const char kVerbList[] PROGMEM = "list";
+static const char kVerbSync[] PROGMEM = "sync";
+static const char kVerbOpen[] PROGMEM = "open";
+static const char kVerbClose[] PROGMEM = "close";
+static const char kVerbLed[] PROGMEM = "led";
+static const char kVerbFan[] PROGMEM = "fan";
+static const char kVerbAll[] PROGMEM = "all";
+static const char kVerbDump[] PROGMEM = "dump";
+static const char kVerbReset[] PROGMEM = "reset";
+static const char kVerbClear[] PROGMEM = "clear";
+static const char kVerbIdle[] PROGMEM = "idle";
+static const char kVerbGate[] PROGMEM = "gate";
+static const char kVerbBattery[] PROGMEM = "battery";
+static const char kVerbBaud[] PROGMEM = "baud";
+static const char kVerbAck[] PROGMEM = "ack";
+
+static const CommandEntry kCommandTable[] PROGMEM = {
+    { kDevSensors,     kVerbStart,     cmdSensorsStart,     false },
+    { kDevSensors,     kVerbStop,      cmdSensorsStop,      false },
+    { kDevSensors,     kVerbInterval,  cmdSensorsInterval,  false },
+    { kDevSensors,     kVerbStatus,    cmdSensorsStatus,    false },
+    { kDevSensors,     kVerbFormat,    cmdSensorsFormat,    false },
+    { kDevSensors,     kVerbSnapshot,  cmdSensorsSnapshot,  false },
+    { kDevSensors,     kVerbReport,    cmdSensorsReport,    false },
+    { kDevSensors,     kVerbHeartbeat, cmdSensorsHeartbeat, false },
+    { kDevSensors,     kVerbDeadband,  cmdSensorsDeadband,  false },
+    { kDevWeight,      kVerbCalibrate, cmdWeightCalibrate,  false },
+    { kDevWeight,      kVerbScale,     cmdWeightScale,      false },
+    { kDevFeeder,      kVerbStart,     cmdFeederStart,      false },
+    { kDevFeeder,      kVerbStop,      cmdFeederStop,       true },
+    { kDevFeeder,      kVerbModel,     cmdFeederModel,      false },
+    { kDevBlower,      kVerbStart,     cmdBlowerStart,      false },
+    { kDevBlower,      kVerbStop,      cmdBlowerStop,       true },
+    { kDevBlower,      kVerbSpeed,     cmdBlowerSpeed,      false },
+    { kDevBlower,      kVerbDirection, cmdBlowerDirection,  false },
+    { kDevBlower,      kVerbRamp,      cmdBlowerRamp,       false },
+    { kDevBlower,      kVerbPwm,       cmdBlowerPwm,        false },
+    { kDevFeederMotor, kVerbOpen,      cmdFeederMotorOpen,  false },
+    { kDevFeederMotor, kVerbClose,     cmdFeederMotorClose, true },
+    { kDevRelay,       kVerbLed,       cmdRelayLed,         false },
+    { kDevRelay,       kVerbFan,       cmdRelayFan,         false },
+    { kDevRelay,       kVerbAll,       cmdRelayAll,         false },
+    { kDevStats,       kVerbDump,      cmdStatsDump,        false },
+    { kDevStats,       kVerbReset,     cmdStatsReset,       false },
+    { kDevConfig,      kVerbStatus,    cmdConfigStatus,     false },
+    { kDevLog,         kVerbDump,      cmdLogDump,          false },
+    { kDevLog,         kVerbClear,     cmdLogClear,         false },
+    { kDevLog,         kVerbStatus,    cmdLogStatus,        false },
+    { kDevSchedule,    kVerbDaily,     cmdScheduleDaily,    false },
+    { kDevSchedule,    kVerbEvery,     cmdScheduleEvery,    false },
+    { kDevSchedule,    kVerbClear,     cmdScheduleClear,    false },
+    { kDevSchedule,    kVerbEnable,    cmdScheduleEnable,   false },
+    { kDevSchedule,    kVerbDisable,   cmdScheduleDisable,  false },
+    { kDevSchedule,    kVerbList,      cmdScheduleList,     false },
+    { kDevTime,        kVerbSync,      cmdTimeSync,         false },
+    { kDevTime,        kVerbStatus,    cmdTimeStatus,       false },
+    { kDevPower,       kVerbStatus,    cmdPowerStatus,      false },
+    { kDevPower,       kVerbIdle,      cmdPowerIdle,        false },
+    { kDevPower,       kVerbGate,      cmdPowerGate,        false },
+    { kDevPower,       kVerbBattery,   cmdPowerBattery,     false },
+    { kDevLink,        kVerbBaud,      cmdLinkBaud,         false },
+    { kDevLink,        kVerbAck,       cmdLinkAck,          true },
+    { kDevLink,        kVerbIdle,      cmdLinkIdle,         false },
+    { kDevLink,        kVerbStatus,    cmdLinkStatus,       false },
+};
+static const uint8_t kCommandCount = sizeof(kCommandTable) / sizeof(kCommandTable[0]);
+
+static void executeCommand(char* line) {
+    PerfScope scope(PERF_COMMAND_DISPATCH);
+    char* device;
+    CommandResult result = dispatchCommand(line, kCommandTable, kCommandCount, device);
+    if (result == COMMAND_UNKNOWN_DEVICE) {
+        // ไม่รู้จักอุปกรณ์
+        SerialTx.print(F("[INFO] - Unknown device: "));
+        SerialTx.println(device);
+    } else if (result == COMMAND_UNKNOWN_VERB) {
+        SerialTx.print(F("[INFO] - Unknown command for device: "));
+        SerialTx.println(device);
+    }
+}
+
+// Stop commands jump ahead of everything already queued
+static void queueCommand(const char* line) {
+    CommandPriority priority = COMMAND_PRIORITY_NORMAL;
+    int8_t index = findCommand(line, kCommandTable, kCommandCount);
+    if (index >= 0) {
+        CommandEntry entry;
+        memcpy_P(&entry, &kCommandTable[index], sizeof(entry));
+        if (entry.urgent) priority = COMMAND_PRIORITY_URGENT;
+    }
+
+    if (!commandQueuePush(commandQueue, line, priority)) {
+        SerialTx.print(F("[ERROR] - Command queue full, rejected: "));
+        SerialTx.println(line);
+    }
+}
+
+static void commandTask() {
+    QueuedCommand command;
+    // Only stop commands run while a report is still being printed
+    bool reporting = continueReport();
+    if (commandQueuePop(commandQueue, command, reporting)) {
+        executeCommand(command.line);
+    }
+}
+
 void controlSensor() {
     // control command will be:
     
@@ -180,8 +1387,11 @@ void controlSensor() {
     // [control]:blower:speed:100\n
     // [control]:blower:direction:reverse\n
     // [control]:blower:direction:normal\n
+    // [control]:blower:ramp:100\n
+    // [control]:blower:pwm:20000\n
     // [control]:feedermotor:open\n
     // [control]:feedermotor:close\n
+    // [control]:feedermotor:open:500\n
     // [control]:relay:led:on\n
     // [control]:relay:led:off\n
     // [control]:relay:fan:on\n
@@ -191,135 +1401,78 @@ void controlSensor() {
     // Feeder sequence controls:
     // [control]:feeder:start:feedAmount,blowerDuration,weightTolerance\n
     // [control]:feeder:stop\n
+    // [control]:feeder:model\n
+    // [control]:feeder:model:reset\n
     
     // Sensor service controls:
     // [control]:sensors:start\n
     // [control]:sensors:stop\n
     // [control]:sensors:interval:1000\n
     // [control]:sensors:status\n
+    // [control]:sensors:format:binary\n
+    // [control]:sensors:format:json\n
+    // [control]:sensors:snapshot:on\n
+    // [control]:sensors:snapshot:off\n
+    // [control]:sensors:report:change\n
+    // [control]:sensors:report:all\n
+    // [control]:sensors:heartbeat:60000\n
+    // [control]:sensors:deadband:loadVoltage,1%\n
     
     // Weight calibration controls:
     // [control]:weight:calibrate\n
+    // [control]:weight:scale:35445\n
     
-    if (Serial.available()) {
-        String command = Serial.readStringUntil('\n');
-        command.trim();
-        if (!command.startsWith("[control]:")) return;
-
-
-        command = command.substring(10); // remove "[control]:"
-        int firstColon = command.indexOf(':');
-        if (firstColon == -1) return;
-
-        String device = command.substring(0, firstColon);
-        String rest = command.substring(firstColon + 1);
-        
-        // Handle sensor service commands
-        if (device == "sensors") {
-            if (rest == "start") {
-                startSensorService();
-            } else if (rest == "stop") {
-                stopSensorService();
-            } else if (rest.startsWith("interval:")) {
-                unsigned long interval = rest.substring(9).toInt();
-                setSensorPrintInterval(interval);
-            } else if (rest == "status") {
-                Serial.println("[INFO] - Sensor service status: " + 
-                             String(isSensorServiceActive() ? "ACTIVE" : "INACTIVE"));
-                Serial.println("[INFO] - Print interval: " + String(sensorPrintInterval) + "ms");
-            }
-            return;
-        }
-        
-        // Handle weight calibration commands
-        if (device == "weight") {
-            if (rest == "calibrate") {
-                calibrateWeight();
-            }
-            return;
-        }
-        
-        DeviceType deviceType = parseDeviceType(device);
-        switch (deviceType) {
-            case DEVICE_FEEDER:
-                if (rest.startsWith("start:")) {
-                    String params = rest.substring(6);
-                    
-                    // Parse parameters: feedAmount,blowerDuration,weightTolerance (all required)
-                    int comma1 = params.indexOf(',');
-                    if (comma1 != -1) {
-                        int feedAmount = params.substring(0, comma1).toInt();
-                        String restParams = params.substring(comma1 + 1);
-                        int comma2 = restParams.indexOf(',');
-                        if (comma2 != -1) {
-                            int blowerDuration = restParams.substring(0, comma2).toInt();
-                            int weightTolerance = restParams.substring(comma2 + 1).toInt();
-                            startFeederSequence(feedAmount, blowerDuration, weightTolerance);
-                        } else {
-                            Serial.println("[ERROR] - Invalid feeder start parameters format. Expected: feedAmount,blowerDuration,weightTolerance");
-                        }
-                    } else {
-                        Serial.println("[ERROR] - Invalid feeder start parameters format. Expected: feedAmount,blowerDuration,weightTolerance");
-                    }
-                } else if (rest == "stop") {
-                    stopFeederSequence();
-                }
-                break;
-            case DEVICE_BLOWER:
-                if (rest == "start") {
-                    isUseFreezeLoadV = true;
-                    startBlower();
-                } else if (rest == "stop") {
-                    isUseFreezeLoadV = false;
-                    stopBlower();
-                } else if (rest.startsWith("speed:")) {
-                    int speed = rest.substring(6).toInt();
-                    setBlowerSpeed(speed);
-                } else if (rest.startsWith("direction:")) {
-                    String dir = rest.substring(10);
-                    if (dir == "reverse") {
-                        setBlowerDirection(true);
-                    } else if (dir == "normal") {
-                        setBlowerDirection(false);
-                    }
-                }
-                break;
-            case DEVICE_FEEDERMOTOR:
-                if (rest == "open") {
-                    feederMotorOpen();
-                } else if (rest == "close") {
-                    feederMotorClose();
-                }
-                break;
-            case DEVICE_RELAY:
-                if (rest.startsWith("led:")) {
-                    String ledCmd = rest.substring(4);
-                    if (ledCmd == "on") {
-                        isUseFreezeLoadV = true;
-                        relayLedOn();
-                    } else if (ledCmd == "off") {
-                        isUseFreezeLoadV = false;
-                        relayLedOff();
-                    }
-                } else if (rest.startsWith("fan:")) {
-                    String fanCmd = rest.substring(4);
-                    if (fanCmd == "on") {
-                        isUseFreezeLoadV = true;
-                        relayFanOn();
-                    } else if (fanCmd == "off") {
-                        isUseFreezeLoadV = false;
-                        relayFanOff();
-                    }
-                } else if (rest == "all:off") {
-                    isUseFreezeLoadV = false;
-                    relayAllOff();
-                }
-                break;
-            default:
-                // ไม่รู้จักอุปกรณ์
-                Serial.println("[INFO] - Unknown device: " + device);
-                break;
+    // Persistent configuration:
+    // [control]:config:status\n
+    
+    // Offline sample log:
+    // [control]:log:dump\n
+    // [control]:log:clear\n
+    // [control]:log:status\n
+    
+    // Feeding schedule:
+    // [control]:time:sync:1760000000,420\n
+    // [control]:time:status\n
+    // [control]:schedule:daily:0,0730,50,8,5\n
+    // [control]:schedule:every:1,240,20,5,3\n
+    // [control]:schedule:enable:0\n
+    // [control]:schedule:disable:0\n
+    // [control]:schedule:clear:0\n
+    // [control]:schedule:list\n
+    
+    // Power saving:
+    // [control]:power:status\n
+    // [control]:power:idle:on\n
+    // [control]:power:gate:on\n
+    // [control]:power:battery:30,15\n
+    
+    // Serial link:
+    // [control]:link:baud:500000\n
+    // [control]:link:ack\n
+    // [control]:link:idle:60000\n
+    // [control]:link:status\n
+    
+    // Timing statistics:
+    // [control]:stats:dump\n
+    // [control]:stats:reset\n
+    
+    // Consume only what has already arrived; never wait for the rest of a line
+    int pending = Serial.available();
+    while (pending-- > 0) {
+        if (!commandLineFeed(commandLine, (char)Serial.read())) continue;
+
+        // Any complete line counts as a heartbeat from the host
+        hostSeen = true;
+        lastHostLineMs = millis();
+        linkHostActivity();
+
+        if (commandLine.overflow) {
+            commandOverflows++;
+            SerialTx.println(F("[ERROR] - Command too long, rejected"));
+        } else if (commandLine.length > 0) {
+            queueCommand(commandLine.data);
         }
+        commandLineReset(commandLine);
     }
 }
 
@@ -333,11 +1486,13 @@ void readAndPrintAllSensors() {
     // Add a small delay to prevent multiple prints within the same second
     static unsigned long lastPrintTime = 0;
     if (currentMillis - lastPrintTime >= 2000) { // At least 5 seconds between prints
-      printDHTSystem();
-      printDHTFeeder();
-      printSoil();
-      printWeight();
-      printPowerMonitor();
+      if (snapshotMode) {
+        printSnapshot();
+      } else {
+        for (uint8_t slot = 0; slot < SENSOR_COUNT; slot++) {
+          printSensor(slot);
+        }
+      }
       
       lastPrintTime = currentMillis;
     }
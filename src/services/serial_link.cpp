@@ -0,0 +1,148 @@
+#include "serial_link.h"
+#include "task_scheduler.h"
+#include "serial_tx.h"
+
+// The core runs the USART in double-speed mode, baud = F_CPU / (8 * (UBRR + 1)).
+// At 16 MHz 250k, 500k and 1M hit that exactly (UBRR 7, 3, 1); 115200 stays
+// the default for existing hosts (UBRR 16, +2.1 %).
+static const unsigned long kLinkRates[] PROGMEM = { LINK_DEFAULT_BAUD, 250000UL, 500000UL, 1000000UL };
+static const uint8_t kLinkRateCount = sizeof(kLinkRates) / sizeof(kLinkRates[0]);
+
+static constexpr bool isExactRate(unsigned long baud) {
+    return F_CPU % (8UL * baud) == 0;
+}
+static_assert(isExactRate(250000UL) && isExactRate(500000UL) && isExactRate(1000000UL),
+              "High-speed link rates need an exact USART divisor");
+
+// Changing the rate first waits until everything queued before the change
+// has left the UART, so no record is cut or sent at the wrong rate
+enum LinkState {
+    LINK_STEADY,
+    LINK_DRAINING,
+    LINK_AWAIT_ACK
+};
+
+static LinkState linkState = LINK_STEADY;
+static unsigned long currentBaud = LINK_DEFAULT_BAUD;
+static unsigned long previousBaud = LINK_DEFAULT_BAUD;
+static unsigned long targetBaud = LINK_DEFAULT_BAUD;
+static bool fallingBack = false;
+static unsigned long switchedAt = 0;
+static unsigned long lastHostLineMs = 0;
+static unsigned long idleFallbackMs = LINK_IDLE_FALLBACK_MS;
+
+static bool isSupportedRate(unsigned long baud) {
+    for (uint8_t i = 0; i < kLinkRateCount; i++) {
+        if (pgm_read_dword(&kLinkRates[i]) == baud) return true;
+    }
+    return false;
+}
+
+static void openPort(unsigned long baud) {
+    // The TX buffer is already empty; this only waits for the last byte
+    Serial.flush();
+    Serial.end();
+    Serial.begin(baud);
+    currentBaud = baud;
+}
+
+static void changeRate(unsigned long baud, bool fallback) {
+    targetBaud = baud;
+    fallingBack = fallback;
+    serialTxPause(true);
+    linkState = LINK_DRAINING;
+}
+
+static void linkTask() {
+    unsigned long now = millis();
+    switch (linkState) {
+        case LINK_DRAINING:
+            if (!isSerialTxDrained()) return;
+            openPort(targetBaud);
+            serialTxPause(false);
+            if (fallingBack) {
+                linkState = LINK_STEADY;
+                lastHostLineMs = now;
+                SerialTx.print(F("[EVENT] - link:baud:fallback:"));
+                SerialTx.println(currentBaud);
+            } else {
+                linkState = LINK_AWAIT_ACK;
+                switchedAt = now;
+            }
+            break;
+
+        case LINK_AWAIT_ACK:
+            if (now - switchedAt >= LINK_ACK_TIMEOUT_MS) changeRate(previousBaud, true);
+            break;
+
+        case LINK_STEADY:
+            if (idleFallbackMs > 0 && currentBaud != LINK_DEFAULT_BAUD && now - lastHostLineMs >= idleFallbackMs) {
+                changeRate(LINK_DEFAULT_BAUD, true);
+            }
+            break;
+    }
+}
+
+void initSerialLink() {
+    Serial.begin(LINK_DEFAULT_BAUD);
+    Serial.setTimeout(10);
+    currentBaud = LINK_DEFAULT_BAUD;
+    linkState = LINK_STEADY;
+    lastHostLineMs = millis();
+    initSerialTx();
+    printLinkCapabilities();
+    registerTask(F("link"), linkTask, 10, 10, TASK_PRIORITY_NORMAL, 2000);
+}
+
+bool linkRequestBaud(unsigned long baud) {
+    if (linkState != LINK_STEADY || !isSupportedRate(baud)) return false;
+    SerialTx.print(F("[EVENT] - link:baud:switch:"));
+    SerialTx.println(baud);
+    previousBaud = currentBaud;
+    changeRate(baud, false);
+    return true;
+}
+
+bool linkAcknowledge() {
+    if (linkState != LINK_AWAIT_ACK) return false;
+    linkState = LINK_STEADY;
+    lastHostLineMs = millis();
+    SerialTx.print(F("[EVENT] - link:baud:ok:"));
+    SerialTx.println(currentBaud);
+    return true;
+}
+
+void linkHostActivity() {
+    lastHostLineMs = millis();
+}
+
+void setLinkIdleFallback(unsigned long ms) {
+    idleFallbackMs = ms;
+    lastHostLineMs = millis();
+}
+
+unsigned long getLinkIdleFallback() {
+    return idleFallbackMs;
+}
+
+unsigned long getLinkBaud() {
+    return currentBaud;
+}
+
+bool isLinkSwitchPending() {
+    return linkState != LINK_STEADY;
+}
+
+void printLinkCapabilities() {
+    SerialTx.print(F("[EVENT] - link:caps:default="));
+    SerialTx.print(LINK_DEFAULT_BAUD);
+    SerialTx.print(F(",rates="));
+    for (uint8_t i = 0; i < kLinkRateCount; i++) {
+        if (i > 0) SerialTx.print('|');
+        SerialTx.print((unsigned long)pgm_read_dword(&kLinkRates[i]));
+    }
+    SerialTx.print(F(",formats=json|binary,rx="));
+    SerialTx.print(SERIAL_RX_BUFFER_SIZE);
+    SerialTx.print(F(",tx="));
+    SerialTx.println(SERIAL_TX_BUFFER_SIZE);
+}
@@ -0,0 +1,111 @@
+#include "serial_tx.h"
+#include "task_scheduler.h"
+
+SerialTxPrint SerialTx;
+
+static bool directMode = true;
+static bool paused = false;
+static bool lineRecord = false;   // The open record was started by a plain print
+
+#define SERIAL_TX_CHUNK 16
+
+static void endLineRecord() {
+    if (!lineRecord) return;
+    txQueueEnd();
+    lineRecord = false;
+}
+
+// Control output is never dropped: when the ring has no room for it, wait
+// for the UART to send what is queued ahead, as a direct write would. Only
+// the open record is left once nothing more can be read, so a record larger
+// than the ring is still lost.
+static void waitForControlRoom(size_t need) {
+    uint8_t chunk[SERIAL_TX_CHUNK];
+    while (txQueueFree(TX_CONTROL) < need) {
+        size_t count = txQueueRead(chunk, SERIAL_TX_CHUNK, paused);
+        if (count == 0) return;
+        Serial.write(chunk, count);
+    }
+}
+
+size_t SerialTxPrint::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t SerialTxPrint::write(const uint8_t* data, size_t length) {
+    if (directMode) return Serial.write(data, length);
+
+    size_t done = 0;
+    while (done < length) {
+        if (!txQueueRecordOpen()) {
+            waitForControlRoom(TX_RECORD_HEADER);
+            txQueueBegin(TX_CONTROL, TX_KEY_NONE);
+            lineRecord = true;
+        }
+        size_t chunk = length - done;
+        if (lineRecord) {
+            const uint8_t* newline = (const uint8_t*)memchr(data + done, '\n', chunk);
+            if (newline != NULL) chunk = (size_t)(newline - (data + done)) + 1;
+            waitForControlRoom(chunk);
+        }
+        txQueueWrite(data + done, chunk);
+        done += chunk;
+        if (lineRecord && data[done - 1] == '\n') {
+            endLineRecord();
+            serialTxPump();
+        }
+    }
+    // Telemetry bytes that did not fit are counted as lost by the queue, not retried
+    return length;
+}
+
+void initSerialTx() {
+    txQueueReset();
+    registerTask(F("serial_tx"), serialTxPump, 0, 0, TASK_PRIORITY_CRITICAL, 1000);
+}
+
+void serialTxBegin(TxClass cls, uint8_t key) {
+    if (directMode) return;
+    endLineRecord();
+    txQueueBegin(cls, key);
+}
+
+void serialTxEnd() {
+    if (directMode) return;
+    txQueueEnd();
+    serialTxPump();
+}
+
+void serialTxPump() {
+    if (directMode) return;
+    uint8_t chunk[SERIAL_TX_CHUNK];
+    int room = Serial.availableForWrite();
+    while (room > 0) {
+        size_t count = txQueueRead(chunk, room < SERIAL_TX_CHUNK ? room : SERIAL_TX_CHUNK, paused);
+        if (count == 0) break;
+        Serial.write(chunk, count);
+        room -= count;
+    }
+}
+
+void serialTxPause(bool pause) {
+    paused = pause;
+}
+
+bool isSerialTxDrained() {
+    return paused && !txQueueSending() && txQueueEmpty(TX_CONTROL) &&
+           Serial.availableForWrite() >= SERIAL_TX_BUFFER_SIZE - 1;
+}
+
+void serialTxSetDirect(bool direct) {
+    if (direct && !directMode) {
+        endLineRecord();
+        txQueueEnd();
+        uint8_t chunk[SERIAL_TX_CHUNK];
+        size_t count;
+        while ((count = txQueueRead(chunk, SERIAL_TX_CHUNK, false)) > 0) {
+            Serial.write(chunk, count);
+        }
+    }
+    directMode = direct;
+}
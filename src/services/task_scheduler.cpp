@@ -0,0 +1,137 @@
+#include "task_scheduler.h"
+
+struct Task {
+    const __FlashStringHelper* name;
+    TaskCallback callback;
+    unsigned long periodMs;
+    unsigned long deadlineMs;
+    unsigned long budgetUs;
+    unsigned long nextRunMs;
+    uint8_t priority;
+    bool enabled;
+    bool running;
+
+    // Statistics
+    PerfStat timing;
+    uint16_t deadlineMisses;
+    uint16_t budgetOverruns;
+};
+
+static Task tasks[MAX_TASKS];
+static uint8_t taskCount = 0;
+// Task ids ordered by priority; ids stay stable for callers
+static uint8_t taskOrder[MAX_TASKS];
+
+int8_t registerTask(const __FlashStringHelper* name, TaskCallback callback,
+                    unsigned long periodMs, unsigned long deadlineMs,
+                    uint8_t priority, unsigned long budgetUs) {
+    if (taskCount >= MAX_TASKS || callback == NULL) {
+        return TASK_INVALID;
+    }
+
+    uint8_t id = taskCount;
+    Task& task = tasks[id];
+    task.name = name;
+    task.callback = callback;
+    task.periodMs = periodMs;
+    task.deadlineMs = deadlineMs;
+    task.budgetUs = budgetUs;
+    task.nextRunMs = millis();
+    task.priority = priority;
+    task.enabled = true;
+    task.running = false;
+    perfReset(task.timing);
+    task.deadlineMisses = 0;
+    task.budgetOverruns = 0;
+
+    // Insert into the priority order, after tasks of equal priority
+    uint8_t pos = taskCount;
+    while (pos > 0 && tasks[taskOrder[pos - 1]].priority > priority) {
+        taskOrder[pos] = taskOrder[pos - 1];
+        pos--;
+    }
+    taskOrder[pos] = id;
+    taskCount++;
+    return (int8_t)id;
+}
+
+void setTaskPeriod(int8_t taskId, unsigned long periodMs) {
+    if (taskId < 0 || taskId >= taskCount) return;
+    tasks[taskId].periodMs = periodMs;
+}
+
+void setTaskEnabled(int8_t taskId, bool enabled) {
+    if (taskId < 0 || taskId >= taskCount) return;
+    Task& task = tasks[taskId];
+    if (enabled && !task.enabled) {
+        task.nextRunMs = millis();
+    }
+    task.enabled = enabled;
+}
+
+void delayTask(int8_t taskId, unsigned long delayMs) {
+    if (taskId < 0 || taskId >= taskCount) return;
+    tasks[taskId].nextRunMs = millis() + delayMs;
+}
+
+bool getTaskDueInMs(int8_t taskId, unsigned long& dueInMs) {
+    if (taskId < 0 || taskId >= taskCount || !tasks[taskId].enabled) return false;
+    long remaining = (long)(tasks[taskId].nextRunMs - millis());
+    dueInMs = remaining > 0 ? (unsigned long)remaining : 0;
+    return true;
+}
+
+void runScheduler() {
+    for (uint8_t i = 0; i < taskCount; i++) {
+        Task& task = tasks[taskOrder[i]];
+        if (!task.enabled || task.running) continue;
+
+        unsigned long now = millis();
+        long lateness = (long)(now - task.nextRunMs);
+        if (lateness < 0) continue;
+
+        if (task.periodMs > 0 && (unsigned long)lateness > task.deadlineMs) {
+            task.deadlineMisses++;
+        }
+
+        task.running = true;
+        unsigned long startUs = micros();
+        task.callback();
+        unsigned long elapsedUs = micros() - startUs;
+        task.running = false;
+
+        perfRecord(task.timing, elapsedUs);
+        if (elapsedUs > task.budgetUs) task.budgetOverruns++;
+
+        // Keep a fixed cadence, but do not try to catch up after a long stall
+        task.nextRunMs += task.periodMs;
+        if ((long)(millis() - task.nextRunMs) >= 0) {
+            task.nextRunMs = millis() + task.periodMs;
+        }
+    }
+}
+
+uint8_t getTaskCount() {
+    return taskCount;
+}
+
+bool getTaskInfo(uint8_t position, TaskInfo& info) {
+    if (position >= taskCount) return false;
+    const Task& task = tasks[taskOrder[position]];
+    info.name = task.name;
+    info.periodMs = task.periodMs;
+    info.priority = task.priority;
+    info.enabled = task.enabled;
+    info.timing = &task.timing;
+    info.deadlineMisses = task.deadlineMisses;
+    info.budgetOverruns = task.budgetOverruns;
+    return true;
+}
+
+void resetTaskStats() {
+    for (uint8_t i = 0; i < taskCount; i++) {
+        perfReset(tasks[i].timing);
+        tasks[i].deadlineMisses = 0;
+        tasks[i].budgetOverruns = 0;
+    }
+}
@@ -0,0 +1,147 @@
+#include "telemetry_codec.h"
+
+uint16_t telemetryCrc16(const uint8_t* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+size_t cobsEncode(const uint8_t* in, size_t len, uint8_t* out, size_t outCap) {
+    if (outCap == 0) return 0;
+
+    size_t codeIndex = 0;
+    size_t outIndex = 1;
+    uint8_t code = 1;
+
+    for (size_t i = 0; i < len; i++) {
+        if (in[i] == 0) {
+            out[codeIndex] = code;
+            code = 1;
+            codeIndex = outIndex++;
+            if (codeIndex >= outCap) return 0;
+        } else {
+            if (outIndex >= outCap) return 0;
+            out[outIndex++] = in[i];
+            code++;
+            if (code == 0xFF) {
+                out[codeIndex] = code;
+                code = 1;
+                codeIndex = outIndex++;
+                if (codeIndex >= outCap) return 0;
+            }
+        }
+    }
+    out[codeIndex] = code;
+    return outIndex;
+}
+
+size_t cobsDecode(const uint8_t* in, size_t len, uint8_t* out, size_t outCap) {
+    size_t inIndex = 0;
+    size_t outIndex = 0;
+
+    while (inIndex < len) {
+        uint8_t code = in[inIndex++];
+        if (code == 0) return 0;
+
+        for (uint8_t i = 1; i < code; i++) {
+            if (inIndex >= len || outIndex >= outCap) return 0;
+            uint8_t b = in[inIndex++];
+            if (b == 0) return 0;
+            out[outIndex++] = b;
+        }
+        // A code < 0xFF implies a zero, except at the very end of the block
+        if (code != 0xFF && inIndex < len) {
+            if (outIndex >= outCap) return 0;
+            out[outIndex++] = 0;
+        }
+    }
+    return outIndex;
+}
+
+void telemetryPutU16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+}
+
+void telemetryPutU32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+uint16_t telemetryGetU16(const uint8_t* p) {
+    return (uint16_t)(p[0] | ((uint16_t)p[1] << 8));
+}
+
+uint32_t telemetryGetU32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+size_t telemetryEncodeFrame(const TelemetryRecordHeader& header,
+                            const uint8_t* payload, size_t payloadLen,
+                            uint8_t* out, size_t outCap) {
+    if (payloadLen > TELEMETRY_MAX_PAYLOAD || outCap < 2) return 0;
+
+    uint8_t raw[TELEMETRY_MAX_RECORD + TELEMETRY_CRC_SIZE];
+    raw[0] = header.sensorId;
+    telemetryPutU16(&raw[1], header.seq);
+    telemetryPutU32(&raw[3], header.timestampMs);
+    for (size_t i = 0; i < payloadLen; i++) {
+        raw[TELEMETRY_HEADER_SIZE + i] = payload[i];
+    }
+    size_t rawLen = TELEMETRY_HEADER_SIZE + payloadLen;
+    telemetryPutU16(&raw[rawLen], telemetryCrc16(raw, rawLen));
+    rawLen += TELEMETRY_CRC_SIZE;
+
+    out[0] = 0x00;
+    size_t encodedLen = cobsEncode(raw, rawLen, &out[1], outCap - 2);
+    if (encodedLen == 0) return 0;
+    out[1 + encodedLen] = 0x00;
+    return encodedLen + 2;
+}
+
+bool telemetryDecodeFrame(const uint8_t* frame, size_t frameLen,
+                          TelemetryRecordHeader& header,
+                          uint8_t* payload, size_t payloadCap, size_t& payloadLen) {
+    uint8_t raw[TELEMETRY_MAX_RECORD + TELEMETRY_CRC_SIZE];
+    size_t rawLen = cobsDecode(frame, frameLen, raw, sizeof(raw));
+    if (rawLen < TELEMETRY_HEADER_SIZE + TELEMETRY_CRC_SIZE) return false;
+
+    size_t bodyLen = rawLen - TELEMETRY_CRC_SIZE;
+    if (telemetryCrc16(raw, bodyLen) != telemetryGetU16(&raw[bodyLen])) return false;
+
+    payloadLen = bodyLen - TELEMETRY_HEADER_SIZE;
+    if (payloadLen > payloadCap) return false;
+
+    header.sensorId = raw[0];
+    header.seq = telemetryGetU16(&raw[1]);
+    header.timestampMs = telemetryGetU32(&raw[3]);
+    for (size_t i = 0; i < payloadLen; i++) {
+        payload[i] = raw[TELEMETRY_HEADER_SIZE + i];
+    }
+    return true;
+}
+
+bool telemetrySnapshotBlock(const uint8_t* snapshot, uint8_t sensorId,
+                            uint16_t& ageMs, const uint8_t*& sensorPayload) {
+    static const uint8_t kPayloadSizes[] = {
+        TELEMETRY_DHT_PAYLOAD_SIZE, TELEMETRY_DHT_PAYLOAD_SIZE, TELEMETRY_SOIL_PAYLOAD_SIZE,
+        TELEMETRY_WEIGHT_PAYLOAD_SIZE, TELEMETRY_POWER_PAYLOAD_SIZE
+    };
+    if (sensorId < TELEMETRY_ID_DHT_SYSTEM || sensorId > TELEMETRY_ID_POWER_MONITOR) return false;
+
+    size_t offset = 0;
+    for (uint8_t id = TELEMETRY_ID_DHT_SYSTEM; id < sensorId; id++) {
+        offset += TELEMETRY_SNAPSHOT_AGE_SIZE + kPayloadSizes[id - TELEMETRY_ID_DHT_SYSTEM];
+    }
+    ageMs = telemetryGetU16(&snapshot[offset]);
+    sensorPayload = &snapshot[offset + TELEMETRY_SNAPSHOT_AGE_SIZE];
+    return ageMs != TELEMETRY_SNAPSHOT_NO_READING;
+}
@@ -0,0 +1,62 @@
+// hal.h first: on the host it supplies the PROGMEM names ArduinoJson uses
+#include "telemetry_json.h"
+#include <ArduinoJson.h>
+
+// Field strings are copied out of flash into the document, so the pools
+// below include room for them. Documents only live for one write.
+#define SENSOR_JSON_STRING_BYTES 32   // Sensor name, or type + unit (+ label) of one field
+#define SNAPSHOT_JSON_KEY_BYTES 20    // Sensor name or field type used as a key
+
+#define FLASH(s) ((const __FlashStringHelper*)(s))
+
+template <typename TTarget>
+static void setFieldValue(TTarget target, const SensorFieldInfo& field, float value) {
+  if (field.offLabel != NULL) {
+    target = FLASH(value != 0.0f ? field.onLabel : field.offLabel);
+  } else {
+    target = value;
+  }
+}
+
+size_t writeSensorJson(Print& out, const SensorDescriptor& sensor, const SensorSample& sample) {
+  StaticJsonDocument<JSON_OBJECT_SIZE(2) + JSON_ARRAY_SIZE(SENSOR_MAX_FIELDS) +
+                     SENSOR_MAX_FIELDS * JSON_OBJECT_SIZE(3) +
+                     (SENSOR_MAX_FIELDS + 1) * SENSOR_JSON_STRING_BYTES> doc;
+  doc["name"] = FLASH(sensor.name);
+  JsonArray values = doc.createNestedArray("value");
+  for (uint8_t i = 0; i < sensor.fieldCount; i++) {
+    SensorFieldInfo field;
+    getSensorField(getSensorFieldId(sensor, i), field);
+    JsonObject item = values.createNestedObject();
+    item["type"] = FLASH(field.type);
+    item["unit"] = FLASH(field.unit);
+    setFieldValue(item["value"], field, sample.values[i]);
+  }
+  return serializeJson(doc, out);
+}
+
+size_t writeSnapshotJson(Print& out, uint16_t seq, unsigned long now, const SensorSample* samples) {
+  // Root and sensors objects, then "t" plus every field of every sensor
+  StaticJsonDocument<JSON_OBJECT_SIZE(4) + JSON_OBJECT_SIZE(SENSOR_COUNT) +
+                     JSON_OBJECT_SIZE(SENSOR_COUNT + SENSOR_TOTAL_FIELDS) +
+                     (SENSOR_COUNT + SENSOR_TOTAL_FIELDS) * SNAPSHOT_JSON_KEY_BYTES> doc;
+  doc["name"] = "SNAPSHOT";
+  doc["seq"] = seq;
+  doc["t"] = now;
+  JsonObject sensors = doc.createNestedObject("sensors");
+
+  for (uint8_t slot = 0; slot < SENSOR_COUNT; slot++) {
+    if (!samples[slot].valid) continue;
+    SensorDescriptor sensor;
+    getSensor(slot, sensor);
+    JsonObject entry = sensors.createNestedObject(FLASH(sensor.name));
+    entry["t"] = samples[slot].timestamp;
+    for (uint8_t i = 0; i < sensor.fieldCount; i++) {
+      SensorFieldInfo field;
+      getSensorField(getSensorFieldId(sensor, i), field);
+      setFieldValue(entry[FLASH(field.type)], field, samples[slot].values[i]);
+    }
+  }
+
+  return serializeJson(doc, out);
+}
@@ -0,0 +1,257 @@
+#include "tx_queue.h"
+
+#define TX_FLAG_DROPPABLE 0x01
+#define TX_FLAG_DEAD      0x02
+
+struct TxRing {
+    uint8_t* data;
+    uint16_t capacity;
+    uint16_t head;      // Oldest committed record
+    uint16_t used;      // Bytes in use, including the open record
+    uint16_t records;   // Committed records
+};
+
+static uint8_t controlBytes[TX_CONTROL_SIZE];
+static uint8_t telemetryBytes[TX_TELEMETRY_SIZE];
+static TxRing controlRing;
+static TxRing telemetryRing;
+static TxQueueStats stats;
+
+// Record being written; it sits at the end of its ring
+static TxRing* openRing = NULL;
+static uint16_t openStart = 0;
+static uint16_t openLength = 0;
+static uint8_t openKey = TX_KEY_NONE;
+static uint8_t openFlags = 0;
+static bool openLost = false;
+
+// Record being sent; always the head of its ring
+static TxRing* sendRing = NULL;
+static uint16_t sendOffset = 0;
+static uint16_t sendLength = 0;
+
+static void ringReset(TxRing& ring, uint8_t* data, uint16_t capacity) {
+    ring.data = data;
+    ring.capacity = capacity;
+    ring.head = 0;
+    ring.used = 0;
+    ring.records = 0;
+}
+
+static uint16_t ringPos(const TxRing& ring, uint16_t base, uint16_t offset) {
+    return (uint16_t)(((uint32_t)base + offset) % ring.capacity);
+}
+
+static void ringPut(TxRing& ring, uint16_t pos, const uint8_t* src, uint16_t length) {
+    uint16_t first = ring.capacity - pos;
+    if (first > length) first = length;
+    memcpy(&ring.data[pos], src, first);
+    if (first < length) memcpy(ring.data, src + first, length - first);
+}
+
+static void ringGet(const TxRing& ring, uint16_t pos, uint8_t* dst, uint16_t length) {
+    uint16_t first = ring.capacity - pos;
+    if (first > length) first = length;
+    memcpy(dst, &ring.data[pos], first);
+    if (first < length) memcpy(dst + first, ring.data, length - first);
+}
+
+static uint16_t recordLength(const TxRing& ring, uint16_t pos) {
+    return (uint16_t)(ring.data[pos] | (ring.data[ringPos(ring, pos, 1)] << 8));
+}
+
+static uint8_t& recordFlags(TxRing& ring, uint16_t pos) {
+    return ring.data[ringPos(ring, pos, 3)];
+}
+
+static void popHead(TxRing& ring) {
+    uint16_t size = TX_RECORD_HEADER + recordLength(ring, ring.head);
+    ring.head = ringPos(ring, ring.head, size);
+    ring.used -= size;
+    ring.records--;
+}
+
+// Drop the record behind a partly sent head. The head's bytes cannot be
+// dropped, so its unsent rest is moved up to end where the dropped record
+// ended, and the head becomes a record of just that rest.
+static void dropBehindSending(TxRing& ring) {
+    uint16_t headLength = recordLength(ring, ring.head);
+    uint16_t next = ringPos(ring, ring.head, TX_RECORD_HEADER + headLength);
+    uint16_t nextSize = TX_RECORD_HEADER + recordLength(ring, next);
+    uint8_t nextFlags = recordFlags(ring, next);
+    if (!(nextFlags & TX_FLAG_DEAD)) stats.dropped++;
+
+    uint16_t rest = sendLength - sendOffset;
+    // Copy from the end, since the ranges overlap when the dropped record is short
+    for (uint16_t i = 1; i <= rest; i++) {
+        ring.data[ringPos(ring, next, ring.capacity + nextSize - i)] = ring.data[ringPos(ring, next, ring.capacity - i)];
+    }
+    uint8_t header[TX_RECORD_HEADER] = { (uint8_t)rest, (uint8_t)(rest >> 8),
+                                         ring.data[ringPos(ring, ring.head, 2)], recordFlags(ring, ring.head) };
+    uint16_t freed = sendOffset + nextSize;
+    ring.head = ringPos(ring, ring.head, freed);
+    ringPut(ring, ring.head, header, TX_RECORD_HEADER);
+    ring.used -= freed;
+    ring.records--;
+    sendOffset = 0;
+    sendLength = rest;
+}
+
+// Free at least need bytes by dropping droppable or replaced records from
+// the head. A record that is being sent is never dropped; the records
+// behind it are dropped instead.
+static bool makeRoom(TxRing& ring, uint16_t need) {
+    while (ring.capacity - ring.used < need) {
+        if (ring.records == 0) return false;
+        bool sending = sendRing == &ring;
+        if (sending && ring.records < 2) return false;
+        uint16_t victim = ring.head;
+        if (sending) victim = ringPos(ring, ring.head, TX_RECORD_HEADER + recordLength(ring, ring.head));
+        uint8_t flags = recordFlags(ring, victim);
+        if (!(flags & (TX_FLAG_DROPPABLE | TX_FLAG_DEAD))) return false;
+        if (sending) {
+            dropBehindSending(ring);
+        } else {
+            if (!(flags & TX_FLAG_DEAD)) stats.dropped++;
+            popHead(ring);
+        }
+    }
+    return true;
+}
+
+// The newest record replaces queued ones with the same key
+static void coalesce(TxRing& ring, uint8_t key) {
+    uint16_t pos = ring.head;
+    for (uint16_t i = 0; i < ring.records; i++) {
+        uint8_t& flags = recordFlags(ring, pos);
+        bool sending = i == 0 && sendRing == &ring;
+        if (!sending && !(flags & TX_FLAG_DEAD) && ring.data[ringPos(ring, pos, 2)] == key) {
+            flags |= TX_FLAG_DEAD;
+            stats.coalesced++;
+        }
+        pos = ringPos(ring, pos, TX_RECORD_HEADER + recordLength(ring, pos));
+    }
+}
+
+static void loseOpenRecord() {
+    if (!openLost) openRing->used -= TX_RECORD_HEADER + openLength;
+    openLost = true;
+}
+
+void txQueueReset() {
+    ringReset(controlRing, controlBytes, TX_CONTROL_SIZE);
+    ringReset(telemetryRing, telemetryBytes, TX_TELEMETRY_SIZE);
+    memset(&stats, 0, sizeof(stats));
+    openRing = NULL;
+    sendRing = NULL;
+}
+
+void txQueueBegin(TxClass cls, uint8_t key) {
+    if (openRing != NULL) txQueueEnd();
+    openRing = cls == TX_CONTROL ? &controlRing : &telemetryRing;
+    openFlags = cls == TX_TELEMETRY ? TX_FLAG_DROPPABLE : 0;
+    openKey = key;
+    openLength = 0;
+    openLost = false;
+    if (!makeRoom(*openRing, TX_RECORD_HEADER)) {
+        openLost = true;
+        return;
+    }
+    openStart = ringPos(*openRing, openRing->head, openRing->used);
+    openRing->used += TX_RECORD_HEADER;
+}
+
+void txQueueWrite(const uint8_t* data, size_t length) {
+    if (openRing == NULL || openLost || length == 0) return;
+    if ((uint32_t)openLength + length > (uint32_t)(openRing->capacity - TX_RECORD_HEADER) || !makeRoom(*openRing, (uint16_t)length)) {
+        loseOpenRecord();
+        return;
+    }
+    ringPut(*openRing, ringPos(*openRing, openStart, TX_RECORD_HEADER + openLength), data, (uint16_t)length);
+    openRing->used += (uint16_t)length;
+    openLength += (uint16_t)length;
+}
+
+void txQueueEnd() {
+    if (openRing == NULL) return;
+    TxRing& ring = *openRing;
+    openRing = NULL;
+    if (openLost) {
+        stats.lost++;
+        return;
+    }
+    if (openLength == 0) {
+        ring.used -= TX_RECORD_HEADER;
+        return;
+    }
+    if (openKey != TX_KEY_NONE && (openFlags & TX_FLAG_DROPPABLE)) coalesce(ring, openKey);
+
+    uint8_t header[TX_RECORD_HEADER] = { (uint8_t)openLength, (uint8_t)(openLength >> 8), openKey, openFlags };
+    ringPut(ring, openStart, header, TX_RECORD_HEADER);
+    ring.records++;
+    stats.records++;
+    if (&ring == &controlRing) {
+        if (ring.used > stats.maxControl) stats.maxControl = ring.used;
+    } else if (ring.used > stats.maxTelemetry) {
+        stats.maxTelemetry = ring.used;
+    }
+}
+
+bool txQueueRecordOpen() {
+    return openRing != NULL;
+}
+
+// Oldest live record of a ring; replaced records are discarded on the way
+static bool ringHasRecord(TxRing& ring) {
+    while (ring.records > 0 && (recordFlags(ring, ring.head) & TX_FLAG_DEAD)) {
+        popHead(ring);
+    }
+    return ring.records > 0;
+}
+
+size_t txQueueRead(uint8_t* out, size_t max, bool controlOnly) {
+    size_t count = 0;
+    while (count < max) {
+        if (sendRing == NULL) {
+            if (ringHasRecord(controlRing)) {
+                sendRing = &controlRing;
+            } else if (!controlOnly && ringHasRecord(telemetryRing)) {
+                sendRing = &telemetryRing;
+            } else {
+                break;
+            }
+            sendOffset = 0;
+            sendLength = recordLength(*sendRing, sendRing->head);
+        }
+
+        uint16_t chunk = sendLength - sendOffset;
+        if (chunk > max - count) chunk = (uint16_t)(max - count);
+        ringGet(*sendRing, ringPos(*sendRing, sendRing->head, TX_RECORD_HEADER + sendOffset), out + count, chunk);
+        count += chunk;
+        sendOffset += chunk;
+        if (sendOffset == sendLength) {
+            popHead(*sendRing);
+            sendRing = NULL;
+        }
+    }
+    return count;
+}
+
+bool txQueueSending() {
+    return sendRing != NULL;
+}
+
+bool txQueueEmpty(TxClass cls) {
+    return !ringHasRecord(cls == TX_CONTROL ? controlRing : telemetryRing);
+}
+
+uint16_t txQueueFree(TxClass cls) {
+    const TxRing& ring = cls == TX_CONTROL ? controlRing : telemetryRing;
+    uint16_t free = ring.capacity - ring.used;
+    if (cls != TX_BULK) return free;
+    return free > TX_BULK_RESERVE ? free - TX_BULK_RESERVE : 0;
+}
+
+const TxQueueStats& getTxQueueStats() {
+    return stats;
+}
@@ -0,0 +1,181 @@
+// Command parsing benchmark (pio test -e native_bench -f test_bench_commands).
+// Compares the String-based parser controlSensor() used before the command
+// table with the in-place parser: commands per second on this PC and heap
+// traffic per command, counted by the String fake in src/hal/. Both sides
+// only decode the command and its arguments; nothing is executed.
+#include <unity.h>
+#include <stdio.h>
+#include <chrono>
+#include "hal.h"
+#include "command_parser.h"
+
+#define BENCH_ROUNDS 20000
+
+static const char* const kLines[] = {
+    "[control]:relay:led:on\n",
+    "[control]:blower:speed:120\n",
+    "[control]:feeder:start:50,8,5\n",
+    "[control]:sensors:interval:1000\n",
+    "[control]:blower:direction:reverse\n",
+    "[control]:feedermotor:close\n",
+    "[control]:relay:all:off\n",
+    "[control]:sensors:status\n",
+};
+#define LINE_COUNT (sizeof(kLines) / sizeof(kLines[0]))
+
+// Whatever the parser decoded, so the work cannot be optimized away
+static volatile long sink;
+
+// === Before: String per line, substring per token ===
+
+// Serial.readStringUntil('\n'): one character at a time
+static String readLegacyLine(const char* text) {
+    String line;
+    for (; *text != '\0' && *text != '\n'; text++) {
+        line += *text;
+    }
+    return line;
+}
+
+static void legacyParse(const char* text) {
+    String command = readLegacyLine(text);
+    command.trim();
+    if (!command.startsWith("[control]:")) return;
+
+    command = command.substring(10);
+    int firstColon = command.indexOf(':');
+    if (firstColon == -1) return;
+    String device = command.substring(0, firstColon);
+    String rest = command.substring(firstColon + 1);
+
+    if (device == "sensors") {
+        if (rest.startsWith("interval:")) sink = rest.substring(9).toInt();
+        else if (rest == "status") sink = 1;
+    } else if (device == "feeder") {
+        if (rest.startsWith("start:")) {
+            String params = rest.substring(6);
+            int comma1 = params.indexOf(',');
+            if (comma1 != -1) {
+                sink = params.substring(0, comma1).toInt();
+                String restParams = params.substring(comma1 + 1);
+                int comma2 = restParams.indexOf(',');
+                if (comma2 != -1) {
+                    sink = restParams.substring(0, comma2).toInt();
+                    sink = restParams.substring(comma2 + 1).toInt();
+                }
+            }
+        }
+    } else if (device == "blower") {
+        if (rest.startsWith("speed:")) {
+            sink = rest.substring(6).toInt();
+        } else if (rest.startsWith("direction:")) {
+            String dir = rest.substring(10);
+            sink = dir == "reverse";
+        }
+    } else if (device == "feedermotor") {
+        sink = rest == "close";
+    } else if (device == "relay") {
+        if (rest.startsWith("led:")) {
+            String ledCmd = rest.substring(4);
+            sink = ledCmd == "on";
+        } else if (rest == "all:off") {
+            sink = 0;
+        }
+    }
+}
+
+// === After: fixed line buffer and PROGMEM table ===
+
+static void onFlag(char*) { sink = 1; }
+static void onLong(char* args) {
+    long value;
+    if (commandParseLong(args, value)) sink = value;
+}
+static void onLongList(char* args) {
+    long values[3];
+    if (commandParseLongList(args, values, 3) == 3) sink = values[2];
+}
+static void onDirection(char* args) { sink = strcmp(args, "reverse") == 0; }
+static void onOnOff(char* args) { sink = strcmp(args, "on") == 0; }
+
+static const char kSensors[] PROGMEM = "sensors";
+static const char kFeeder[] PROGMEM = "feeder";
+static const char kBlower[] PROGMEM = "blower";
+static const char kFeederMotor[] PROGMEM = "feedermotor";
+static const char kRelay[] PROGMEM = "relay";
+static const char kInterval[] PROGMEM = "interval";
+static const char kStatus[] PROGMEM = "status";
+static const char kStart[] PROGMEM = "start";
+static const char kSpeed[] PROGMEM = "speed";
+static const char kDirection[] PROGMEM = "direction";
+static const char kClose[] PROGMEM = "close";
+static const char kLed[] PROGMEM = "led";
+static const char kAll[] PROGMEM = "all";
+
+static const CommandEntry kTable[] PROGMEM = {
+    {kSensors, kInterval, onLong, false},
+    {kSensors, kStatus, onFlag, false},
+    {kFeeder, kStart, onLongList, false},
+    {kBlower, kSpeed, onLong, false},
+    {kBlower, kDirection, onDirection, false},
+    {kFeederMotor, kClose, onFlag, true},
+    {kRelay, kLed, onOnOff, false},
+    {kRelay, kAll, onFlag, false},
+};
+#define TABLE_SIZE (sizeof(kTable) / sizeof(kTable[0]))
+
+static CommandLineBuffer lineBuffer;
+
+static void inPlaceParse(const char* text) {
+    for (; *text != '\0'; text++) {
+        if (!commandLineFeed(lineBuffer, *text)) continue;
+        // The RX stage classifies the line for the queue, the command task dispatches it
+        sink = findCommand(lineBuffer.data, kTable, TABLE_SIZE);
+        char* device;
+        dispatchCommand(lineBuffer.data, kTable, TABLE_SIZE, device);
+        commandLineReset(lineBuffer);
+    }
+}
+
+// === Measurement ===
+
+typedef std::chrono::steady_clock HostClock;
+
+static void run(const char* name, void (*parse)(const char*)) {
+    halResetHeapStats();
+    HostClock::time_point start = HostClock::now();
+    for (unsigned round = 0; round < BENCH_ROUNDS; round++) {
+        parse(kLines[round % LINE_COUNT]);
+    }
+    double seconds = std::chrono::duration<double>(HostClock::now() - start).count();
+
+    const HalHeapStats& heap = halHeapStats();
+    char line[160];
+    snprintf(line, sizeof(line), "%-9s %10.0f commands/s | %5.1f allocations, %6.1f bytes allocated per command",
+             name, BENCH_ROUNDS / seconds, (double)heap.allocations / BENCH_ROUNDS,
+             (double)heap.bytes / BENCH_ROUNDS);
+    TEST_MESSAGE(line);
+}
+
+void setUp() {
+    commandLineReset(lineBuffer);
+}
+
+void tearDown() {}
+
+void test_bench_string_parser() {
+    run("String", legacyParse);
+    TEST_ASSERT_GREATER_THAN(0, halHeapStats().allocations);
+}
+
+void test_bench_in_place_parser() {
+    run("in-place", inPlaceParse);
+    TEST_ASSERT_EQUAL_UINT32(0, halHeapStats().allocations);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_bench_string_parser);
+    RUN_TEST(test_bench_in_place_parser);
+    return UNITY_END();
+}
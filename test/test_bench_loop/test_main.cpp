@@ -0,0 +1,210 @@
+// Loop benchmark (pio test -e native_bench -f test_bench_loop).
+// Boots like setup() in main.cpp and measures the three things loop() is made
+// of: a scheduler pass, the command RX stage and a complete feeder sequence.
+// Host time is the per-iteration cost of the code itself on this PC; virtual
+// time is what the fakes charge for waiting on hardware (serial TX room, DHT
+// conversions, HX711 reads), which is the worst-case latency the board sees.
+#include <unity.h>
+#include <stdio.h>
+#include <chrono>
+#include <string>
+#include "hal.h"
+#include "sensor_service.h"
+#include "feeder_service.h"
+#include "task_scheduler.h"
+#include "config_store.h"
+#include "power_manager.h"
+#include "serial_link.h"
+#include "serial_tx.h"
+#include "weight_sensor.h"
+#include "power_monitor.h"
+#include "soil_sensor.h"
+
+#define BENCH_IDLE_US 1000UL   // Virtual time between loop() iterations
+
+struct LoopCost {
+    unsigned long count;
+    double hostNsSum;
+    double hostNsMax;
+    unsigned long virtualUsSum;
+    unsigned long virtualUsMax;
+};
+
+typedef std::chrono::steady_clock HostClock;
+
+static void resetCost(LoopCost& cost) {
+    memset(&cost, 0, sizeof(cost));
+}
+
+template <typename Fn> static void measure(LoopCost& cost, Fn fn) {
+    unsigned long startUs = micros();
+    HostClock::time_point start = HostClock::now();
+    fn();
+    double ns = std::chrono::duration<double, std::nano>(HostClock::now() - start).count();
+    unsigned long virtualUs = micros() - startUs;
+
+    cost.count++;
+    cost.hostNsSum += ns;
+    if (ns > cost.hostNsMax) cost.hostNsMax = ns;
+    cost.virtualUsSum += virtualUs;
+    if (virtualUs > cost.virtualUsMax) cost.virtualUsMax = virtualUs;
+}
+
+static void report(const char* name, const LoopCost& cost) {
+    char line[200];
+    snprintf(line, sizeof(line),
+             "%-16s n=%-7lu host mean %8.0f ns max %9.0f ns | virtual mean %6lu us max %6lu us",
+             name, cost.count, cost.count ? cost.hostNsSum / cost.count : 0.0, cost.hostNsMax,
+             cost.count ? cost.virtualUsSum / cost.count : 0UL, cost.virtualUsMax);
+    TEST_MESSAGE(line);
+}
+
+static void boot() {
+    static bool booted = false;
+    if (booted) return;
+    booted = true;
+
+    // A charged 12 V battery on a sunny day, so the power manager runs at
+    // its normal level and telemetry is not throttled
+    halSetAnalogInput(LOAD_VOLTAGE_PIN, 582);    // 12.8 V
+    halSetAnalogInput(LOAD_CURRENT_PIN, 512);    // 0 A
+    halSetAnalogInput(SOLAR_VOLTAGE_PIN, 818);   // 18 V
+    halSetAnalogInput(SOLAR_CURRENT_PIN, 512);
+    halSetAnalogInput(SOIL_PIN, 500);
+
+    initSerialLink();
+    initConfigStore();
+    initPowerManager();
+    initAllSensors();
+    initSensorService();
+    initFeederService();
+    serialTxSetDirect(false);
+}
+
+void setUp() {
+    boot();
+}
+
+void tearDown() {}
+
+// One minute of telemetry with no host traffic
+void test_bench_scheduler_pass() {
+    LoopCost cost;
+    resetCost(cost);
+    unsigned long endMs = millis() + 60000UL;
+    while (millis() < endMs) {
+        measure(cost, runScheduler);
+        halAdvanceMicros(BENCH_IDLE_US);
+    }
+    report("runScheduler", cost);
+    TEST_ASSERT_GREATER_THAN(0, cost.count);
+}
+
+// The minute above ran with no host, so every record went to the offline
+// log as well; dump it the way a returning host would, until the end event
+void test_bench_log_dump() {
+    halSerialClearOutput();
+    halSerialInject("[control]:log:dump\n");
+    unsigned long startUs = micros();
+    unsigned long records = 0;
+    bool ended = false;
+    while (!ended && micros() - startUs < 10000000UL) {
+        controlSensor();
+        runScheduler();
+        halAdvanceMicros(BENCH_IDLE_US);
+        // Binary frames contain zero bytes, so search the whole capture
+        std::string output(halSerialOutput(), halSerialOutputLength());
+        size_t start = output.find("log:dump:start:");
+        if (start != std::string::npos) records = strtoul(output.c_str() + start + 15, NULL, 10);
+        ended = output.find("log:dump:end:") != std::string::npos;
+    }
+    TEST_ASSERT_TRUE(ended);
+    Serial.flush();
+    unsigned long elapsedUs = micros() - startUs;
+    size_t bytes = halSerialOutputLength();
+
+    char line[200];
+    snprintf(line, sizeof(line),
+             "log dump: %lu records, %u bytes in %lu ms = %.0f records/s, %.0f B/s (%.0f%% of %lu baud)",
+             records, (unsigned)bytes, elapsedUs / 1000, records * 1e6 / elapsedUs, bytes * 1e6 / elapsedUs,
+             bytes * 1e6 / elapsedUs * 10.0 * 100.0 / halSerialBaud(), halSerialBaud());
+    TEST_MESSAGE(line);
+    TEST_ASSERT_GREATER_THAN(0, records);
+}
+
+// A command line arrives every 20 ms; the RX stage is timed on its own and
+// the scheduler pass that follows executes the command
+void test_bench_command_rx() {
+    static const char* const lines[] = {
+        "[control]:relay:led:on\n",
+        "[control]:relay:led:off\n",
+        "[control]:blower:speed:120\n",
+        "[control]:sensors:interval:1000\n",
+    };
+    LoopCost rx;
+    LoopCost pass;
+    resetCost(rx);
+    resetCost(pass);
+    uint32_t overflowsBefore = halSerialRxOverflows();
+
+    for (unsigned i = 0; i < 2000; i++) {
+        halSerialInject(lines[i % 4]);
+        measure(rx, controlSensor);
+        measure(pass, runScheduler);
+        halAdvanceMicros(20000UL);
+    }
+    report("controlSensor", rx);
+    report("runScheduler+cmd", pass);
+    TEST_ASSERT_EQUAL_UINT32(overflowsBefore, halSerialRxOverflows());
+}
+
+// feeder:start with the gate passing 10 g/s while it is open
+void test_bench_feeder_sequence() {
+    const float countsPerGram = getWeightScaleFactor() / 1000.0f;
+    const long fullRaw = (long)(2000.0f * countsPerGram);
+    unsigned long openMs = 0;
+    halSetLoadCellRaw(fullRaw);
+
+    LoopCost cost;
+    resetCost(cost);
+    halSerialInject("[control]:feeder:start:50,8,5\n");
+    unsigned long startMs = millis();
+    unsigned long blockedBefore = halSerialBlockedMicros();
+    unsigned long lastMs = startMs;
+    bool started = false;
+
+    while (millis() - startMs < 120000UL) {
+        measure(cost, []() {
+            controlSensor();
+            runScheduler();
+        });
+        halAdvanceMicros(BENCH_IDLE_US);
+
+        unsigned long now = millis();
+        if (getFeederState() == FEEDER_DISPENSING) {
+            openMs += now - lastMs;
+            halSetLoadCellRaw(fullRaw - (long)(openMs * 0.01f * countsPerGram));   // 10 g/s
+        }
+        lastMs = now;
+
+        if (isFeederSequenceActive()) started = true;
+        else if (started) break;
+    }
+    report("feeder sequence", cost);
+
+    char line[96];
+    snprintf(line, sizeof(line), "feeder sequence took %lu ms of virtual time, %lu us blocked on TX",
+             millis() - startMs, halSerialBlockedMicros() - blockedBefore);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_TRUE(started);
+    TEST_ASSERT_FALSE(isFeederSequenceActive());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_bench_scheduler_pass);
+    RUN_TEST(test_bench_log_dump);
+    RUN_TEST(test_bench_command_rx);
+    RUN_TEST(test_bench_feeder_sequence);
+    return UNITY_END();
+}
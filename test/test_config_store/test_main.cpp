@@ -0,0 +1,152 @@
+// EEPROM journal against the RAM-backed EEPROM of the host build
+#include <unity.h>
+#include "hal.h"
+#include "config_store.h"
+
+static void writeEeprom(uint16_t addr, const void* data, size_t len) {
+    eeprom_update_block(data, (void*)(uintptr_t)addr, len);
+}
+
+static void readEeprom(uint16_t addr, void* data, size_t len) {
+    eeprom_read_block(data, (const void*)(uintptr_t)addr, len);
+}
+
+static uint16_t slotAddr(uint16_t slot) {
+    return slot * CONFIG_RECORD_SIZE;
+}
+
+static long storedLong(uint8_t key) {
+    long value = 0;
+    TEST_ASSERT_TRUE(configGetLong(key, value));
+    return value;
+}
+
+void setUp() {
+    halEraseEeprom();
+    initConfigStore();
+}
+
+void tearDown() {}
+
+void test_blank_eeprom_has_no_values() {
+    long value;
+    TEST_ASSERT_FALSE(configGetLong(CONFIG_KEY_TARE_OFFSET, value));
+    TEST_ASSERT_EQUAL_UINT16(0, getConfigStoreStats().validRecords);
+    TEST_ASSERT_EQUAL_UINT16(0, getConfigStoreStats().head);
+}
+
+void test_legacy_offset_is_migrated_once() {
+    halEraseEeprom();
+    int32_t legacy = -123456;
+    writeEeprom(0, &legacy, sizeof(legacy));
+
+    initConfigStore();
+    TEST_ASSERT_EQUAL_INT32(-123456, storedLong(CONFIG_KEY_TARE_OFFSET));
+    TEST_ASSERT_EQUAL_UINT32(1, getConfigStoreStats().writes);
+
+    // The journal record replaced the legacy bytes; nothing to migrate again
+    initConfigStore();
+    TEST_ASSERT_EQUAL_INT32(-123456, storedLong(CONFIG_KEY_TARE_OFFSET));
+    TEST_ASSERT_EQUAL_UINT16(1, getConfigStoreStats().validRecords);
+    TEST_ASSERT_EQUAL_UINT32(0, getConfigStoreStats().writes);
+}
+
+void test_latest_record_wins() {
+    TEST_ASSERT_TRUE(configSetLong(CONFIG_KEY_SENSOR_INTERVAL, 1000));
+    TEST_ASSERT_TRUE(configSetLong(CONFIG_KEY_BLOWER_SPEED, 200));
+    TEST_ASSERT_TRUE(configSetLong(CONFIG_KEY_SENSOR_INTERVAL, 2000));
+    TEST_ASSERT_TRUE(configSetLong(CONFIG_KEY_SENSOR_INTERVAL, 3000));
+    TEST_ASSERT_TRUE(configSetFloat(CONFIG_KEY_SCALE_FACTOR, 35445.5f));
+
+    initConfigStore();
+    TEST_ASSERT_EQUAL_INT32(3000, storedLong(CONFIG_KEY_SENSOR_INTERVAL));
+    TEST_ASSERT_EQUAL_INT32(200, storedLong(CONFIG_KEY_BLOWER_SPEED));
+    float factor = 0;
+    TEST_ASSERT_TRUE(configGetFloat(CONFIG_KEY_SCALE_FACTOR, factor));
+    TEST_ASSERT_EQUAL_FLOAT(35445.5f, factor);
+    TEST_ASSERT_EQUAL_UINT16(5, getConfigStoreStats().validRecords);
+    TEST_ASSERT_EQUAL_UINT32(5, getConfigStoreStats().seq);
+    TEST_ASSERT_EQUAL_UINT16(5, getConfigStoreStats().head);
+}
+
+void test_unchanged_value_is_not_written() {
+    TEST_ASSERT_TRUE(configSetLong(CONFIG_KEY_BLOWER_SPEED, 128));
+    TEST_ASSERT_TRUE(configSetLong(CONFIG_KEY_BLOWER_SPEED, 128));
+    TEST_ASSERT_EQUAL_UINT32(1, getConfigStoreStats().writes);
+}
+
+void test_head_wraps_and_keeps_live_records() {
+    // Two keys written once stay live in slots 0 and 1 while a third key
+    // is rewritten all the way round the ring, twice
+    TEST_ASSERT_TRUE(configSetLong(CONFIG_KEY_TARE_OFFSET, -777));
+    TEST_ASSERT_TRUE(configSetLong(CONFIG_KEY_TIME_ZONE, 420));
+    const long writes = 2L * CONFIG_SLOT_COUNT + 5;
+    for (long i = 1; i <= writes; i++) {
+        TEST_ASSERT_TRUE(configSetLong(CONFIG_KEY_SENSOR_INTERVAL, i));
+        uint16_t head = getConfigStoreStats().head;
+        TEST_ASSERT_TRUE(head != 0 && head != 1);
+    }
+
+    initConfigStore();
+    TEST_ASSERT_EQUAL_INT32(-777, storedLong(CONFIG_KEY_TARE_OFFSET));
+    TEST_ASSERT_EQUAL_INT32(420, storedLong(CONFIG_KEY_TIME_ZONE));
+    TEST_ASSERT_EQUAL_INT32(writes, storedLong(CONFIG_KEY_SENSOR_INTERVAL));
+    TEST_ASSERT_EQUAL_UINT32(writes + 2, getConfigStoreStats().seq);
+    // Every slot has been written; none of them is corrupt
+    TEST_ASSERT_EQUAL_UINT16(CONFIG_SLOT_COUNT, getConfigStoreStats().validRecords);
+    TEST_ASSERT_EQUAL_UINT16(0, getConfigStoreStats().badRecords);
+
+    // The scan found the same head the writer would have used
+    uint16_t head = getConfigStoreStats().head;
+    TEST_ASSERT_TRUE(configSetLong(CONFIG_KEY_SENSOR_INTERVAL, 1));
+    initConfigStore();
+    TEST_ASSERT_EQUAL_INT32(1, storedLong(CONFIG_KEY_SENSOR_INTERVAL));
+    TEST_ASSERT_TRUE(getConfigStoreStats().head != head);
+}
+
+void test_torn_write_keeps_previous_value() {
+    TEST_ASSERT_TRUE(configSetLong(CONFIG_KEY_BLOWER_SPEED, 100));
+    uint16_t slot = getConfigStoreStats().head;
+    TEST_ASSERT_TRUE(configSetLong(CONFIG_KEY_BLOWER_SPEED, 250));
+
+    // Power lost after the first half of the record: the rest is still erased
+    uint8_t raw[CONFIG_RECORD_SIZE];
+    readEeprom(slotAddr(slot), raw, sizeof(raw));
+    memset(&raw[CONFIG_RECORD_SIZE / 2], 0xFF, CONFIG_RECORD_SIZE / 2);
+    writeEeprom(slotAddr(slot), raw, sizeof(raw));
+
+    initConfigStore();
+    TEST_ASSERT_EQUAL_INT32(100, storedLong(CONFIG_KEY_BLOWER_SPEED));
+    TEST_ASSERT_EQUAL_UINT16(1, getConfigStoreStats().badRecords);
+    TEST_ASSERT_EQUAL_UINT16(1, getConfigStoreStats().validRecords);
+}
+
+void test_corrupted_value_is_rejected_by_crc() {
+    TEST_ASSERT_TRUE(configSetLong(CONFIG_KEY_TIME_ZONE, 60));
+    uint16_t slot = getConfigStoreStats().head;
+    TEST_ASSERT_TRUE(configSetLong(CONFIG_KEY_TIME_ZONE, 120));
+
+    // One flipped bit in the value
+    uint8_t raw[CONFIG_RECORD_SIZE];
+    readEeprom(slotAddr(slot), raw, sizeof(raw));
+    raw[6] ^= 0x04;
+    writeEeprom(slotAddr(slot), raw, sizeof(raw));
+
+    initConfigStore();
+    TEST_ASSERT_EQUAL_INT32(60, storedLong(CONFIG_KEY_TIME_ZONE));
+    TEST_ASSERT_EQUAL_UINT16(1, getConfigStoreStats().badRecords);
+    // The bad slot is reused by the next write
+    TEST_ASSERT_EQUAL_UINT16(slot, getConfigStoreStats().head);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_blank_eeprom_has_no_values);
+    RUN_TEST(test_legacy_offset_is_migrated_once);
+    RUN_TEST(test_latest_record_wins);
+    RUN_TEST(test_unchanged_value_is_not_written);
+    RUN_TEST(test_head_wraps_and_keeps_live_records);
+    RUN_TEST(test_torn_write_keeps_previous_value);
+    RUN_TEST(test_corrupted_value_is_rejected_by_crc);
+    return UNITY_END();
+}
@@ -0,0 +1,64 @@
+// DHT samples through the sensor registry: nothing before the first good
+// conversion, the cached value while it is fresh, nothing once it is stale
+#include <unity.h>
+#include "hal.h"
+#include "dht_sensor.h"
+#include "sensor_registry.h"
+
+static SensorSample readFeederDht() {
+    SensorDescriptor sensor;
+    getSensor(SENSOR_DHT_FEEDER, sensor);
+    SensorSample sample;
+    sample.valid = true;
+    sensor.read(sample);
+    return sample;
+}
+
+// Let the driver run for ms of virtual time, one update every 100 ms
+static void runDht(unsigned long ms) {
+    for (unsigned long elapsed = 0; elapsed < ms; elapsed += 100) {
+        updateDHT();
+        halAdvanceMicros(100000UL);
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_dht_sample_lifecycle() {
+    initDHT();
+    halSetDhtReading(DHTPIN2, 27.5f, 55.0f);
+
+    // No conversion yet: the zeroed cache must not be reported
+    TEST_ASSERT_FALSE(readFeederDht().valid);
+
+    runDht(DHT_MIN_READ_INTERVAL + 100);
+    SensorSample sample = readFeederDht();
+    TEST_ASSERT_TRUE(sample.valid);
+    TEST_ASSERT_EQUAL_FLOAT(27.5f, sample.values[0]);
+    TEST_ASSERT_EQUAL_FLOAT(55.0f, sample.values[1]);
+
+    // A failing sensor keeps its last value until it goes stale
+    halSetDhtFailing(DHTPIN2, true);
+    runDht(DHT_STALE_MS / 2);
+    sample = readFeederDht();
+    TEST_ASSERT_TRUE(sample.valid);
+    TEST_ASSERT_EQUAL_FLOAT(27.5f, sample.values[0]);
+
+    runDht(DHT_STALE_MS);
+    TEST_ASSERT_FALSE(readFeederDht().valid);
+
+    // Recovers with the next good conversion
+    halSetDhtFailing(DHTPIN2, false);
+    halSetDhtReading(DHTPIN2, 26.0f, 58.0f);
+    runDht(DHT_MIN_READ_INTERVAL + 100);
+    sample = readFeederDht();
+    TEST_ASSERT_TRUE(sample.valid);
+    TEST_ASSERT_EQUAL_FLOAT(26.0f, sample.values[0]);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_dht_sample_lifecycle);
+    return UNITY_END();
+}
@@ -0,0 +1,81 @@
+// Recursive least squares fit of the gate flow and the open time planned from it
+#include <unity.h>
+#include "hal.h"
+#include "dosing_model.h"
+
+static DosingModel model;
+
+// Feeds at hopper levels cycling over 0.5 to 3.0 kg
+static void learn(float a, float b, unsigned feeds) {
+    for (unsigned i = 0; i < feeds; i++) {
+        float kg = 0.5f + 0.5f * (i % 6);
+        dosingUpdate(model, kg, a + b * kg);
+    }
+}
+
+void setUp() {
+    dosingReset(model);
+}
+
+void tearDown() {}
+
+void test_untrained_model_does_not_predict() {
+    float flow;
+    learn(10.0f, 0.0f, DOSING_MIN_FEEDS - 1);
+    TEST_ASSERT_FALSE(dosingPredictFlow(model, 1.0f, flow));
+    TEST_ASSERT_EQUAL_UINT32(0, dosingPlanOpenMs(model, 1.0f, 40.0f, 30000));
+
+    learn(10.0f, 0.0f, 1);
+    TEST_ASSERT_TRUE(dosingPredictFlow(model, 1.0f, flow));
+}
+
+void test_fit_converges_to_the_flow_line() {
+    learn(8.0f, 2.0f, 30);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 8.0f, model.a);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 2.0f, model.b);
+    TEST_ASSERT_EQUAL_UINT16(30, model.feeds);
+}
+
+void test_forgetting_follows_a_change_in_flow() {
+    learn(8.0f, 2.0f, 30);
+    // Coarser feed: the same slope, 2 g/s less at every level
+    learn(6.0f, 2.0f, 60);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 6.0f, model.a);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 2.0f, model.b);
+}
+
+void test_covariance_does_not_wind_up_at_one_level() {
+    for (unsigned i = 0; i < 500; i++) {
+        dosingUpdate(model, 2.0f, 12.0f);
+    }
+    // Forgetting stops once the trace is back at its initial size
+    TEST_ASSERT_TRUE(model.p00 + model.p11 <= 2.0f * DOSING_INITIAL_P / DOSING_FORGETTING);
+    float flow;
+    TEST_ASSERT_TRUE(dosingPredictFlow(model, 2.0f, flow));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 12.0f, flow);
+}
+
+void test_open_time_from_predicted_flow() {
+    learn(10.0f, 0.0f, 20);
+    TEST_ASSERT_UINT32_WITHIN(5, 4000, dosingPlanOpenMs(model, 1.0f, 40.0f, 30000));
+    TEST_ASSERT_EQUAL_UINT32(30000, dosingPlanOpenMs(model, 1.0f, 1000.0f, 30000));
+    TEST_ASSERT_EQUAL_UINT32(0, dosingPlanOpenMs(model, 1.0f, 0.0f, 30000));
+}
+
+void test_implausible_flow_is_not_planned() {
+    // Flow falls to zero at 2 kg and goes negative above
+    learn(4.0f, -2.0f, 30);
+    TEST_ASSERT_EQUAL_UINT32(0, dosingPlanOpenMs(model, 2.5f, 40.0f, 30000));
+    TEST_ASSERT_NOT_EQUAL(0, dosingPlanOpenMs(model, 0.5f, 40.0f, 30000));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_untrained_model_does_not_predict);
+    RUN_TEST(test_fit_converges_to_the_flow_line);
+    RUN_TEST(test_forgetting_follows_a_change_in_flow);
+    RUN_TEST(test_covariance_does_not_wind_up_at_one_level);
+    RUN_TEST(test_open_time_from_predicted_flow);
+    RUN_TEST(test_implausible_flow_is_not_planned);
+    return UNITY_END();
+}
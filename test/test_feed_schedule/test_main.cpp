@@ -0,0 +1,162 @@
+// Feeding schedule on the virtual clock: daily entries, catch-up limit,
+// arming after a clock sync, interval cadence and time zones
+#include <unity.h>
+#include "hal.h"
+#include "feed_schedule.h"
+#include "config_store.h"
+
+#define SYNC_DAY 20000UL                       // Days since the epoch, at 00:00 UTC
+#define MINUTE_US 60000000UL
+
+static void advanceMinutes(unsigned long minutes) {
+    for (unsigned long i = 0; i < minutes; i++) {
+        halAdvanceMicros(MINUTE_US);
+    }
+}
+
+// Set the wall clock to hh:mm UTC on SYNC_DAY
+static void syncAt(uint16_t hhmm, int16_t tzMinutes = 0) {
+    uint32_t seconds = SYNC_DAY * 86400UL + (hhmm / 100) * 3600UL + (hhmm % 100) * 60UL;
+    scheduleSyncClock(seconds, tzMinutes);
+}
+
+static ScheduleEntry makeEntry(uint8_t kind, uint16_t minutes) {
+    ScheduleEntry entry = { kind, true, minutes, 50, 8, 5 };
+    return entry;
+}
+
+void setUp() {
+    halEraseEeprom();
+    initConfigStore();
+    initSchedule();
+}
+
+void tearDown() {}
+
+void test_daily_entry_fires_once_per_local_day() {
+    syncAt(700);
+    TEST_ASSERT_TRUE(scheduleSet(0, makeEntry(SCHEDULE_DAILY, 7 * 60 + 30)));
+    TEST_ASSERT_EQUAL_INT8(-1, scheduleDueEntry());
+
+    advanceMinutes(30);
+    TEST_ASSERT_EQUAL_INT8(0, scheduleDueEntry());
+    // Stays due until the feed is started
+    TEST_ASSERT_EQUAL_INT8(0, scheduleDueEntry());
+    scheduleMarkFired(0);
+    TEST_ASSERT_EQUAL_INT8(-1, scheduleDueEntry());
+
+    advanceMinutes(5);
+    TEST_ASSERT_EQUAL_INT8(-1, scheduleDueEntry());
+    advanceMinutes(24 * 60 - 5);
+    TEST_ASSERT_EQUAL_INT8(0, scheduleDueEntry());
+    scheduleMarkFired(0);
+    TEST_ASSERT_EQUAL_UINT16(2, getScheduleStats().fired);
+    TEST_ASSERT_EQUAL_UINT16(0, getScheduleStats().missed);
+}
+
+void test_daily_feed_later_than_the_catchup_limit_is_missed() {
+    syncAt(700);
+    TEST_ASSERT_TRUE(scheduleSet(0, makeEntry(SCHEDULE_DAILY, 7 * 60 + 30)));
+
+    // Nothing polled the schedule until SCHEDULE_CATCHUP_MIN after the time
+    advanceMinutes(30 + SCHEDULE_CATCHUP_MIN);
+    TEST_ASSERT_EQUAL_INT8(-1, scheduleDueEntry());
+    TEST_ASSERT_EQUAL_UINT16(1, getScheduleStats().missed);
+    TEST_ASSERT_EQUAL_UINT16(0, getScheduleStats().fired);
+
+    // Counted once, and the entry runs again the next day
+    advanceMinutes(60);
+    TEST_ASSERT_EQUAL_INT8(-1, scheduleDueEntry());
+    TEST_ASSERT_EQUAL_UINT16(1, getScheduleStats().missed);
+    advanceMinutes(24 * 60 - 60 - SCHEDULE_CATCHUP_MIN);
+    TEST_ASSERT_EQUAL_INT8(0, scheduleDueEntry());
+}
+
+void test_daily_feed_within_the_catchup_limit_still_runs() {
+    syncAt(700);
+    TEST_ASSERT_TRUE(scheduleSet(0, makeEntry(SCHEDULE_DAILY, 7 * 60 + 30)));
+    advanceMinutes(30 + SCHEDULE_CATCHUP_MIN - 1);
+    TEST_ASSERT_EQUAL_INT8(0, scheduleDueEntry());
+    TEST_ASSERT_EQUAL_UINT16(0, getScheduleStats().missed);
+}
+
+void test_sync_after_the_daily_time_waits_for_tomorrow() {
+    syncAt(500);
+    TEST_ASSERT_TRUE(scheduleSet(0, makeEntry(SCHEDULE_DAILY, 6 * 60)));
+
+    // The host corrects the clock to two hours later, past the entry's time
+    syncAt(700);
+    TEST_ASSERT_EQUAL_INT8(-1, scheduleDueEntry());
+    TEST_ASSERT_EQUAL_UINT16(0, getScheduleStats().missed);
+
+    advanceMinutes(23 * 60);
+    TEST_ASSERT_EQUAL_INT8(0, scheduleDueEntry());
+}
+
+void test_interval_keeps_its_cadence() {
+    TEST_ASSERT_TRUE(scheduleSet(1, makeEntry(SCHEDULE_INTERVAL, 10)));
+    advanceMinutes(9);
+    TEST_ASSERT_EQUAL_INT8(-1, scheduleDueEntry());
+    advanceMinutes(1);
+    TEST_ASSERT_EQUAL_INT8(1, scheduleDueEntry());
+
+    // Started 3 minutes late: the next run is still 10 minutes after the last due time
+    advanceMinutes(3);
+    scheduleMarkFired(1);
+    advanceMinutes(6);
+    TEST_ASSERT_EQUAL_INT8(-1, scheduleDueEntry());
+    advanceMinutes(1);
+    TEST_ASSERT_EQUAL_INT8(1, scheduleDueEntry());
+}
+
+void test_interval_restarts_after_a_lost_period() {
+    TEST_ASSERT_TRUE(scheduleSet(1, makeEntry(SCHEDULE_INTERVAL, 10)));
+    // More than a whole period passes before the feed can start
+    advanceMinutes(25);
+    TEST_ASSERT_EQUAL_INT8(1, scheduleDueEntry());
+    scheduleMarkFired(1);
+
+    // Counted from the late start, not run twice to catch up
+    TEST_ASSERT_EQUAL_INT8(-1, scheduleDueEntry());
+    advanceMinutes(9);
+    TEST_ASSERT_EQUAL_INT8(-1, scheduleDueEntry());
+    advanceMinutes(1);
+    TEST_ASSERT_EQUAL_INT8(1, scheduleDueEntry());
+}
+
+void test_time_zone_offset_applies_to_daily_entries() {
+    // 05:00 UTC is 07:00 at UTC+2
+    syncAt(500, 120);
+    TEST_ASSERT_EQUAL_INT16(120, scheduleTzMinutes());
+    TEST_ASSERT_TRUE(scheduleSet(0, makeEntry(SCHEDULE_DAILY, 7 * 60 + 30)));
+    advanceMinutes(29);
+    TEST_ASSERT_EQUAL_INT8(-1, scheduleDueEntry());
+    advanceMinutes(1);
+    TEST_ASSERT_EQUAL_INT8(0, scheduleDueEntry());
+}
+
+void test_negative_offset_crosses_the_utc_day() {
+    // 02:00 UTC is 21:00 the previous day at UTC-5: a 21:30 entry is due
+    // in 30 minutes, on the local day that started before SYNC_DAY
+    syncAt(200, -300);
+    TEST_ASSERT_TRUE(scheduleSet(0, makeEntry(SCHEDULE_DAILY, 21 * 60 + 30)));
+    advanceMinutes(30);
+    TEST_ASSERT_EQUAL_INT8(0, scheduleDueEntry());
+    scheduleMarkFired(0);
+    // Crossing midnight UTC does not start a new local day
+    advanceMinutes(3 * 60);
+    TEST_ASSERT_EQUAL_INT8(-1, scheduleDueEntry());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_daily_entry_fires_once_per_local_day);
+    RUN_TEST(test_daily_feed_later_than_the_catchup_limit_is_missed);
+    RUN_TEST(test_daily_feed_within_the_catchup_limit_still_runs);
+    RUN_TEST(test_sync_after_the_daily_time_waits_for_tomorrow);
+    RUN_TEST(test_interval_keeps_its_cadence);
+    RUN_TEST(test_interval_restarts_after_a_lost_period);
+    RUN_TEST(test_time_zone_offset_applies_to_daily_entries);
+    RUN_TEST(test_negative_offset_crosses_the_utc_day);
+    return UNITY_END();
+}
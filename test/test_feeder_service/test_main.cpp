@@ -0,0 +1,190 @@
+// Feeder sequence against the fakes: open time planned from a stored dosing
+// model, and the cut-off lead time learned from the overshoot and stored
+#include <unity.h>
+#include <string>
+#include "hal.h"
+#include "sensor_service.h"
+#include "feeder_service.h"
+#include "task_scheduler.h"
+#include "config_store.h"
+#include "power_manager.h"
+#include "serial_link.h"
+#include "serial_tx.h"
+#include "weight_sensor.h"
+#include "power_monitor.h"
+#include "soil_sensor.h"
+#include "feed_schedule.h"
+
+#define FLOW_G_PER_S 10.0f
+#define IN_FLIGHT_MS 600UL   // Feed still landing after the gate closes
+#define SETTLE_MS 3000UL     // Run on after the feed so deferred config writes finish
+
+// Worst scheduler pass of the last feed, in virtual time and config writes
+static unsigned long worstPassUs = 0;
+static uint32_t worstPassWrites = 0;
+
+static void boot() {
+    static bool booted = false;
+    if (booted) return;
+    booted = true;
+
+    // Normal power level, see test_bench_loop
+    halSetAnalogInput(LOAD_VOLTAGE_PIN, 582);
+    halSetAnalogInput(LOAD_CURRENT_PIN, 512);
+    halSetAnalogInput(SOLAR_VOLTAGE_PIN, 818);
+    halSetAnalogInput(SOLAR_CURRENT_PIN, 512);
+    halSetAnalogInput(SOIL_PIN, 500);
+
+    // A dosing model trained at a flat 10 g/s
+    initConfigStore();
+    configSetFloat(CONFIG_KEY_DOSING_A, FLOW_G_PER_S);
+    configSetFloat(CONFIG_KEY_DOSING_B, 0.0f);
+    configSetFloat(CONFIG_KEY_DOSING_P00, 1.0f);
+    configSetFloat(CONFIG_KEY_DOSING_P01, 0.0f);
+    configSetFloat(CONFIG_KEY_DOSING_P11, 1.0f);
+    configSetLong(CONFIG_KEY_DOSING_FEEDS, 10);
+
+    initSerialLink();
+    initPowerManager();
+    initAllSensors();
+    initSensorService();
+    initFeederService();
+    serialTxSetDirect(false);
+}
+
+// Run one feed, started by the command (or by the schedule when NULL); the
+// gate passes FLOW_G_PER_S while open and for IN_FLIGHT_MS after it closes
+static std::string runFeedFrom(const char* command) {
+    const float countsPerGram = getWeightScaleFactor() / 1000.0f;
+    const long fullRaw = (long)(2000.0f * countsPerGram);
+    unsigned long flowingMs = 0;
+    unsigned long closedAt = 0;
+    bool started = false;
+    halSetLoadCellRaw(fullRaw);
+    halSerialClearOutput();
+
+    if (command != NULL) halSerialInject(command);
+    worstPassUs = 0;
+    worstPassWrites = 0;
+    unsigned long startMs = millis();
+    unsigned long lastMs = startMs;
+    unsigned long endedAt = 0;
+    while (millis() - startMs < 120000UL) {
+        controlSensor();
+        unsigned long passStart = micros();
+        uint32_t writesBefore = getConfigStoreStats().writes;
+        runScheduler();
+        worstPassUs = max(worstPassUs, micros() - passStart);
+        worstPassWrites = max(worstPassWrites, getConfigStoreStats().writes - writesBefore);
+        halAdvanceMicros(1000UL);
+
+        unsigned long now = millis();
+        FeederState state = getFeederState();
+        if (state == FEEDER_DISPENSING) {
+            flowingMs += now - lastMs;
+        } else if (state == FEEDER_POST_BLOW) {
+            if (closedAt == 0) closedAt = now;
+            if (now - closedAt < IN_FLIGHT_MS) flowingMs += now - lastMs;
+        }
+        halSetLoadCellRaw(fullRaw - (long)(flowingMs * FLOW_G_PER_S * 0.001f * countsPerGram));
+        lastMs = now;
+
+        if (isFeederSequenceActive()) {
+            started = true;
+        } else if (started) {
+            if (endedAt == 0) endedAt = now;
+            if (now - endedAt >= SETTLE_MS) break;
+        }
+    }
+    TEST_ASSERT_TRUE(started);
+    TEST_ASSERT_FALSE(isFeederSequenceActive());
+    return std::string(halSerialOutput(), halSerialOutputLength());
+}
+
+static std::string runFeed(int grams) {
+    String command = "[control]:feeder:start:" + String(grams) + ",8,5\n";
+    return runFeedFrom(command.c_str());
+}
+
+static float storedLead() {
+    float lead = 0.0f;
+    TEST_ASSERT_TRUE(configGetFloat(CONFIG_KEY_FEED_CUTOFF_LEAD, lead));
+    return lead;
+}
+
+void setUp() {
+    boot();
+}
+
+void tearDown() {}
+
+void test_open_time_is_planned_from_the_stored_model() {
+    std::string output = runFeed(50);
+    // 80 % of 50 g at 10 g/s
+    TEST_ASSERT_TRUE(output.find("Planned open time: 4000ms") != std::string::npos);
+    TEST_ASSERT_TRUE(output.find("feeder:result:") != std::string::npos);
+}
+
+void test_lead_time_learns_the_in_flight_feed_and_is_stored() {
+    float first = storedLead();
+    // 600 ms in flight is more than the default 400 ms lead
+    TEST_ASSERT_GREATER_THAN(400, (int)first);
+
+    runFeed(50);
+    float second = storedLead();
+    TEST_ASSERT_TRUE(second > first);
+    TEST_ASSERT_TRUE(second <= 1500.0f);
+}
+
+// Index 256 used to wrap to entry 0 in the uint8_t conversion
+void test_schedule_index_out_of_range_is_rejected() {
+    halSerialClearOutput();
+    halSerialInject("[control]:schedule:daily:256,0730,50,8,5\n");
+    controlSensor();
+    runScheduler();
+    Serial.flush();
+
+    std::string output(halSerialOutput(), halSerialOutputLength());
+    TEST_ASSERT_TRUE(output.find("[ERROR] - Invalid schedule entry") != std::string::npos);
+    ScheduleEntry entry;
+    TEST_ASSERT_TRUE(scheduleGet(0, entry));
+    TEST_ASSERT_EQUAL_UINT8(SCHEDULE_UNUSED, entry.kind);
+}
+
+// A schedule entry's tolerance must not replace the host's stored default
+void test_scheduled_feed_keeps_the_stored_tolerance() {
+    runFeed(50);
+    float before = 0.0f;
+    TEST_ASSERT_TRUE(configGetFloat(CONFIG_KEY_WEIGHT_TOLERANCE, before));
+    TEST_ASSERT_EQUAL_FLOAT(5.0f, before);
+
+    ScheduleEntry entry = { SCHEDULE_INTERVAL, true, 1, 50, 8, 9 };
+    TEST_ASSERT_TRUE(scheduleSet(1, entry));
+    std::string output = runFeedFrom(NULL);
+    TEST_ASSERT_TRUE(scheduleClear(1));
+
+    TEST_ASSERT_TRUE(output.find("[EVENT] - schedule:feed:1") != std::string::npos);
+    float after = 0.0f;
+    TEST_ASSERT_TRUE(configGetFloat(CONFIG_KEY_WEIGHT_TOLERANCE, after));
+    TEST_ASSERT_EQUAL_FLOAT(5.0f, after);
+}
+
+// Learned values are written one record per feeder tick, not all at once
+void test_learned_values_are_saved_one_record_per_tick() {
+    uint32_t writesBefore = getConfigStoreStats().writes;
+    runFeed(50);
+    TEST_ASSERT_TRUE(getConfigStoreStats().writes > writesBefore);
+    TEST_ASSERT_EQUAL_UINT32(1, worstPassWrites);
+    // One 12-byte record, plus a DHT conversion in the same pass
+    TEST_ASSERT_TRUE(worstPassUs < CONFIG_RECORD_SIZE * HAL_EEPROM_WRITE_US + HAL_DHT_CONVERSION_US + 1000UL);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_open_time_is_planned_from_the_stored_model);
+    RUN_TEST(test_lead_time_learns_the_in_flight_feed_and_is_stored);
+    RUN_TEST(test_schedule_index_out_of_range_is_rejected);
+    RUN_TEST(test_scheduled_feed_keeps_the_stored_tolerance);
+    RUN_TEST(test_learned_values_are_saved_one_record_per_tick);
+    return UNITY_END();
+}
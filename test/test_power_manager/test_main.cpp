@@ -0,0 +1,174 @@
+// Battery level thresholds and their hysteresis, ADC engine gating
+#include <unity.h>
+#include "hal.h"
+#include "power_manager.h"
+#include "config_store.h"
+#include "adc_engine.h"
+#include "task_scheduler.h"
+
+// Reader task for the gating tests, and how long the engine had been
+// running at each of its runs
+static unsigned long engineStartedMs = 0;
+static unsigned long adcReads = 0;
+static unsigned long shortWindowReads = 0;
+
+static void adcReaderTask() {
+    adcReads++;
+    if (!isAdcEngineRunning() || millis() - engineStartedMs < ADC_ENGINE_CYCLE_MS) shortWindowReads++;
+}
+
+// Scheduler passes followed by an idle call, 1 ms apart; returns the time
+// the engine spent running
+static unsigned long runLoop(unsigned long ms) {
+    unsigned long runningMs = 0;
+    for (unsigned long i = 0; i < ms; i++) {
+        bool wasRunning = isAdcEngineRunning();
+        runScheduler();
+        powerIdle();
+        if (isAdcEngineRunning()) {
+            if (!wasRunning) engineStartedMs = millis();
+            runningMs++;
+        }
+        halAdvanceMicros(1000);
+    }
+    return runningMs;
+}
+
+// Defaults: low below 30 %, critical below 15 %, 3 % to leave a level
+void setUp() {
+    halEraseEeprom();
+    initConfigStore();
+    initPowerManager();
+}
+
+void tearDown() {}
+
+void test_levels_are_entered_below_their_thresholds() {
+    TEST_ASSERT_FALSE(updateBatteryLevel(30.0f));
+    TEST_ASSERT_EQUAL(POWER_LEVEL_NORMAL, getPowerLevel());
+    TEST_ASSERT_TRUE(updateBatteryLevel(29.9f));
+    TEST_ASSERT_EQUAL(POWER_LEVEL_LOW, getPowerLevel());
+    TEST_ASSERT_EQUAL_UINT8(POWER_LOW_PERIOD_SCALE, getPowerPeriodScale());
+    TEST_ASSERT_FALSE(updateBatteryLevel(15.0f));
+    TEST_ASSERT_TRUE(updateBatteryLevel(14.9f));
+    TEST_ASSERT_EQUAL(POWER_LEVEL_CRITICAL, getPowerLevel());
+    TEST_ASSERT_EQUAL_UINT8(POWER_CRITICAL_PERIOD_SCALE, getPowerPeriodScale());
+}
+
+void test_a_flat_battery_goes_straight_to_critical() {
+    TEST_ASSERT_TRUE(updateBatteryLevel(5.0f));
+    TEST_ASSERT_EQUAL(POWER_LEVEL_CRITICAL, getPowerLevel());
+}
+
+void test_levels_are_left_only_after_the_hysteresis() {
+    updateBatteryLevel(10.0f);
+    // Critical until 15 + 3 %
+    TEST_ASSERT_FALSE(updateBatteryLevel(15.0f));
+    TEST_ASSERT_FALSE(updateBatteryLevel(17.9f));
+    TEST_ASSERT_EQUAL(POWER_LEVEL_CRITICAL, getPowerLevel());
+    TEST_ASSERT_TRUE(updateBatteryLevel(18.0f));
+    TEST_ASSERT_EQUAL(POWER_LEVEL_LOW, getPowerLevel());
+    // Low until 30 + 3 %
+    TEST_ASSERT_FALSE(updateBatteryLevel(32.9f));
+    TEST_ASSERT_EQUAL(POWER_LEVEL_LOW, getPowerLevel());
+    TEST_ASSERT_TRUE(updateBatteryLevel(33.0f));
+    TEST_ASSERT_EQUAL(POWER_LEVEL_NORMAL, getPowerLevel());
+    TEST_ASSERT_EQUAL_UINT8(1, getPowerPeriodScale());
+}
+
+void test_recovery_from_critical_past_both_edges_is_normal() {
+    updateBatteryLevel(10.0f);
+    TEST_ASSERT_TRUE(updateBatteryLevel(40.0f));
+    TEST_ASSERT_EQUAL(POWER_LEVEL_NORMAL, getPowerLevel());
+}
+
+// A reading wobbling around a threshold changes the level once
+void test_noise_at_a_threshold_does_not_flap() {
+    static const float readings[] = {29.5f, 30.5f, 29.0f, 31.0f, 29.8f, 32.5f, 30.0f};
+    unsigned changes = 0;
+    for (unsigned i = 0; i < sizeof(readings) / sizeof(readings[0]); i++) {
+        if (updateBatteryLevel(readings[i])) changes++;
+    }
+    TEST_ASSERT_EQUAL(1, changes);
+    TEST_ASSERT_EQUAL(POWER_LEVEL_LOW, getPowerLevel());
+}
+
+void test_zero_threshold_disables_a_level() {
+    TEST_ASSERT_TRUE(setBatteryThresholds(30, 0));
+    TEST_ASSERT_TRUE(updateBatteryLevel(1.0f));
+    TEST_ASSERT_EQUAL(POWER_LEVEL_LOW, getPowerLevel());
+
+    TEST_ASSERT_TRUE(setBatteryThresholds(0, 0));
+    TEST_ASSERT_TRUE(updateBatteryLevel(1.0f));
+    TEST_ASSERT_EQUAL(POWER_LEVEL_NORMAL, getPowerLevel());
+}
+
+void test_thresholds_are_checked_and_stored() {
+    TEST_ASSERT_FALSE(setBatteryThresholds(20, 25));
+    TEST_ASSERT_FALSE(setBatteryThresholds(101, 10));
+    TEST_ASSERT_TRUE(setBatteryThresholds(40, 20));
+
+    initPowerManager();
+    TEST_ASSERT_EQUAL_UINT8(40, getBatteryLowPct());
+    TEST_ASSERT_EQUAL_UINT8(20, getBatteryCriticalPct());
+    TEST_ASSERT_TRUE(updateBatteryLevel(39.0f));
+    TEST_ASSERT_EQUAL(POWER_LEVEL_LOW, getPowerLevel());
+}
+
+void test_gating_stops_the_adc_engine_between_reads() {
+    static int8_t readerId = TASK_INVALID;
+    if (readerId == TASK_INVALID) {
+        readerId = registerTask(F("adc_reader"), adcReaderTask, 1000, 100, TASK_PRIORITY_LOW, 1000);
+    }
+    initAdcEngine();
+    addPowerAdcReader(readerId);
+    delayTask(readerId, 1000);
+    adcReads = 0;
+    shortWindowReads = 0;
+
+    // Gating off: the engine never stops
+    TEST_ASSERT_EQUAL_UINT32(3000, runLoop(3000));
+    TEST_ASSERT_EQUAL_UINT32(2, adcReads);
+
+    setPowerGatingEnabled(true);
+    delayTask(readerId, 1000);
+    adcReads = 0;
+    unsigned long runningMs = runLoop(10000);
+    TEST_ASSERT_EQUAL_UINT32(9, adcReads);
+    // Every read had a full cycle of fresh conversions behind it
+    TEST_ASSERT_EQUAL_UINT32(0, shortWindowReads);
+    // And the engine ran only for about that cycle per read
+    TEST_ASSERT_UINT32_WITHIN(9 * 3, 9 * (ADC_ENGINE_CYCLE_MS + 1), runningMs);
+    // Already on for the read due next, off again once it is done
+    TEST_ASSERT_TRUE(isAdcEngineRunning());
+    runLoop(500);
+    TEST_ASSERT_FALSE(isAdcEngineRunning());
+
+    setPowerGatingEnabled(false);
+    runLoop(1);
+    TEST_ASSERT_TRUE(isAdcEngineRunning());
+}
+
+void test_stopped_engine_keeps_the_last_sums() {
+    initAdcEngine();
+    halSetAnalogInput(A2, 500);
+    stopAdcEngine();
+    halSetAnalogInput(A2, 700);
+    TEST_ASSERT_EQUAL_UINT16(500 * ADC_OVERSAMPLE, adcReadSum(A2));
+    startAdcEngine();
+    TEST_ASSERT_EQUAL_UINT16(700 * ADC_OVERSAMPLE, adcReadSum(A2));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_levels_are_entered_below_their_thresholds);
+    RUN_TEST(test_a_flat_battery_goes_straight_to_critical);
+    RUN_TEST(test_levels_are_left_only_after_the_hysteresis);
+    RUN_TEST(test_recovery_from_critical_past_both_edges_is_normal);
+    RUN_TEST(test_noise_at_a_threshold_does_not_flap);
+    RUN_TEST(test_zero_threshold_disables_a_level);
+    RUN_TEST(test_thresholds_are_checked_and_stored);
+    RUN_TEST(test_gating_stops_the_adc_engine_between_reads);
+    RUN_TEST(test_stopped_engine_keeps_the_last_sums);
+    return UNITY_END();
+}
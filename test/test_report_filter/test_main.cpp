@@ -0,0 +1,135 @@
+// Report-by-exception filter: deadbands, heartbeat and counters
+#include <unity.h>
+#include "hal.h"
+#include "report_filter.h"
+
+#define HEARTBEAT_MS 60000UL
+
+static const Deadband ABSOLUTE_HALF = { false, 0.5f };
+static const Deadband RELATIVE_TENTH = { true, 0.1f };
+static const Deadband ANY_CHANGE = { false, 0.0f };
+
+static ReportState state;
+
+void setUp() {
+    reportReset(state);
+}
+
+void tearDown() {}
+
+void test_absolute_band() {
+    TEST_ASSERT_FALSE(reportOutsideDeadband(ABSOLUTE_HALF, 20.0f, 20.0f));
+    TEST_ASSERT_FALSE(reportOutsideDeadband(ABSOLUTE_HALF, 20.0f, 20.5f));
+    TEST_ASSERT_FALSE(reportOutsideDeadband(ABSOLUTE_HALF, 20.0f, 19.5f));
+    TEST_ASSERT_TRUE(reportOutsideDeadband(ABSOLUTE_HALF, 20.0f, 20.6f));
+    TEST_ASSERT_TRUE(reportOutsideDeadband(ABSOLUTE_HALF, 20.0f, 19.4f));
+    // The band does not scale with the value
+    TEST_ASSERT_TRUE(reportOutsideDeadband(ABSOLUTE_HALF, 1000.0f, 1000.6f));
+}
+
+void test_relative_band() {
+    TEST_ASSERT_FALSE(reportOutsideDeadband(RELATIVE_TENTH, 200.0f, 219.0f));
+    TEST_ASSERT_TRUE(reportOutsideDeadband(RELATIVE_TENTH, 200.0f, 221.0f));
+    TEST_ASSERT_TRUE(reportOutsideDeadband(RELATIVE_TENTH, 200.0f, 179.0f));
+    // Negative readings use the magnitude of the last value
+    TEST_ASSERT_FALSE(reportOutsideDeadband(RELATIVE_TENTH, -200.0f, -181.0f));
+    TEST_ASSERT_TRUE(reportOutsideDeadband(RELATIVE_TENTH, -200.0f, -179.0f));
+}
+
+void test_relative_band_around_zero_reports_any_change() {
+    TEST_ASSERT_FALSE(reportOutsideDeadband(RELATIVE_TENTH, 0.0f, 0.0f));
+    TEST_ASSERT_TRUE(reportOutsideDeadband(RELATIVE_TENTH, 0.0f, 0.01f));
+    TEST_ASSERT_TRUE(reportOutsideDeadband(RELATIVE_TENTH, 0.0f, -0.01f));
+}
+
+void test_zero_band_reports_any_change() {
+    TEST_ASSERT_FALSE(reportOutsideDeadband(ANY_CHANGE, 3.0f, 3.0f));
+    TEST_ASSERT_TRUE(reportOutsideDeadband(ANY_CHANGE, 3.0f, 3.001f));
+    TEST_ASSERT_TRUE(reportOutsideDeadband(ANY_CHANGE, 3.0f, 2.999f));
+}
+
+void test_first_record_is_always_sent() {
+    float values[1] = { 20.0f };
+    TEST_ASSERT_TRUE(reportShouldSend(state, values, &ABSOLUTE_HALF, 1, 1000, HEARTBEAT_MS));
+    TEST_ASSERT_TRUE(state.primed);
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, state.lastSent[0]);
+}
+
+void test_any_field_outside_its_band_sends_the_record() {
+    const Deadband deadbands[2] = { ABSOLUTE_HALF, RELATIVE_TENTH };
+    float values[2] = { 20.0f, 200.0f };
+    TEST_ASSERT_TRUE(reportShouldSend(state, values, deadbands, 2, 0, HEARTBEAT_MS));
+
+    values[0] = 20.4f;
+    values[1] = 215.0f;
+    TEST_ASSERT_FALSE(reportShouldSend(state, values, deadbands, 2, 1000, HEARTBEAT_MS));
+
+    values[1] = 225.0f;
+    TEST_ASSERT_TRUE(reportShouldSend(state, values, deadbands, 2, 2000, HEARTBEAT_MS));
+    // Both fields are compared against what was sent, not what was seen
+    TEST_ASSERT_EQUAL_FLOAT(20.4f, state.lastSent[0]);
+    TEST_ASSERT_EQUAL_FLOAT(225.0f, state.lastSent[1]);
+}
+
+void test_slow_drift_is_measured_from_the_last_sent_value() {
+    float values[1] = { 20.0f };
+    reportShouldSend(state, values, &ABSOLUTE_HALF, 1, 0, HEARTBEAT_MS);
+
+    values[0] = 20.3f;
+    TEST_ASSERT_FALSE(reportShouldSend(state, values, &ABSOLUTE_HALF, 1, 1000, HEARTBEAT_MS));
+    values[0] = 20.6f;
+    TEST_ASSERT_TRUE(reportShouldSend(state, values, &ABSOLUTE_HALF, 1, 2000, HEARTBEAT_MS));
+}
+
+void test_heartbeat_after_max_silence() {
+    float values[1] = { 20.0f };
+    reportShouldSend(state, values, &ABSOLUTE_HALF, 1, 5000, HEARTBEAT_MS);
+
+    TEST_ASSERT_FALSE(reportShouldSend(state, values, &ABSOLUTE_HALF, 1, 5000 + HEARTBEAT_MS - 1, HEARTBEAT_MS));
+    TEST_ASSERT_TRUE(reportShouldSend(state, values, &ABSOLUTE_HALF, 1, 5000 + HEARTBEAT_MS, HEARTBEAT_MS));
+    // The silence is counted again from the heartbeat
+    TEST_ASSERT_FALSE(reportShouldSend(state, values, &ABSOLUTE_HALF, 1, 5000 + 2 * HEARTBEAT_MS - 1, HEARTBEAT_MS));
+}
+
+void test_heartbeat_across_millis_wrap() {
+    float values[1] = { 20.0f };
+    unsigned long start = 0xFFFFFFFFUL - 1000;
+    reportShouldSend(state, values, &ABSOLUTE_HALF, 1, start, HEARTBEAT_MS);
+
+    TEST_ASSERT_FALSE(reportShouldSend(state, values, &ABSOLUTE_HALF, 1, start + 2000, HEARTBEAT_MS));
+    TEST_ASSERT_TRUE(reportShouldSend(state, values, &ABSOLUTE_HALF, 1, start + HEARTBEAT_MS, HEARTBEAT_MS));
+}
+
+void test_sent_and_suppressed_counters() {
+    float values[1] = { 20.0f };
+    reportShouldSend(state, values, &ABSOLUTE_HALF, 1, 0, HEARTBEAT_MS);
+    for (unsigned long ms = 1000; ms <= 5000; ms += 1000) {
+        reportShouldSend(state, values, &ABSOLUTE_HALF, 1, ms, HEARTBEAT_MS);
+    }
+    values[0] = 25.0f;
+    reportShouldSend(state, values, &ABSOLUTE_HALF, 1, 6000, HEARTBEAT_MS);
+    reportShouldSend(state, values, &ABSOLUTE_HALF, 1, 6000 + HEARTBEAT_MS, HEARTBEAT_MS);
+
+    TEST_ASSERT_EQUAL_UINT32(3, state.sent);
+    TEST_ASSERT_EQUAL_UINT32(5, state.suppressed);
+
+    reportReset(state);
+    TEST_ASSERT_EQUAL_UINT32(0, state.sent);
+    TEST_ASSERT_EQUAL_UINT32(0, state.suppressed);
+    TEST_ASSERT_FALSE(state.primed);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_absolute_band);
+    RUN_TEST(test_relative_band);
+    RUN_TEST(test_relative_band_around_zero_reports_any_change);
+    RUN_TEST(test_zero_band_reports_any_change);
+    RUN_TEST(test_first_record_is_always_sent);
+    RUN_TEST(test_any_field_outside_its_band_sends_the_record);
+    RUN_TEST(test_slow_drift_is_measured_from_the_last_sent_value);
+    RUN_TEST(test_heartbeat_after_max_silence);
+    RUN_TEST(test_heartbeat_across_millis_wrap);
+    RUN_TEST(test_sent_and_suppressed_counters);
+    return UNITY_END();
+}
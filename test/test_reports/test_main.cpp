@@ -0,0 +1,131 @@
+// Long replies are streamed through the control ring without losing a line
+#include <unity.h>
+#include <string>
+#include "hal.h"
+#include "sensor_service.h"
+#include "task_scheduler.h"
+#include "config_store.h"
+#include "power_manager.h"
+#include "serial_link.h"
+#include "serial_tx.h"
+#include "tx_queue.h"
+#include "sensor_registry.h"
+#include "perf_stats.h"
+#include "power_monitor.h"
+#include "soil_sensor.h"
+
+static void boot() {
+    static bool booted = false;
+    if (booted) return;
+    booted = true;
+
+    // Normal power level, see test_bench_loop
+    halSetAnalogInput(LOAD_VOLTAGE_PIN, 582);
+    halSetAnalogInput(LOAD_CURRENT_PIN, 512);
+    halSetAnalogInput(SOLAR_VOLTAGE_PIN, 818);
+    halSetAnalogInput(SOLAR_CURRENT_PIN, 512);
+    halSetAnalogInput(SOIL_PIN, 500);
+
+    initSerialLink();
+    initConfigStore();
+    initPowerManager();
+    initAllSensors();
+    initSensorService();
+    serialTxSetDirect(false);
+    // Telemetry off, so the output is only the replies
+    stopSensorService();
+}
+
+static void runFor(unsigned long ms) {
+    unsigned long startMs = millis();
+    while (millis() - startMs < ms) {
+        controlSensor();
+        runScheduler();
+        halAdvanceMicros(1000UL);
+    }
+    Serial.flush();
+}
+
+static unsigned countOf(const std::string& text, const char* needle) {
+    unsigned count = 0;
+    for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) {
+        count++;
+    }
+    return count;
+}
+
+void setUp() {
+    boot();
+    runFor(100);
+    halSerialClearOutput();
+}
+
+void tearDown() {}
+
+// All four long replies sent back to back: every line arrives, in command
+// order, without a lost record or a wait for the UART
+void test_long_replies_arrive_complete_and_in_order() {
+    uint16_t lostBefore = getTxQueueStats().lost;
+    unsigned long blockedBefore = halSerialBlockedMicros();
+    halSerialInject("[control]:sensors:status\n[control]:stats:dump\n");
+    runFor(10);
+    halSerialInject("[control]:schedule:list\n[control]:link:status\n");
+    runFor(2000);
+
+    std::string out(halSerialOutput(), halSerialOutputLength());
+    TEST_ASSERT_EQUAL(SENSOR_COUNT, countOf(out, " suppressed="));
+    TEST_ASSERT_EQUAL(getTaskCount(), countOf(out, "[INFO] - Task "));
+    TEST_ASSERT_EQUAL(PERF_SLOT_COUNT + getTaskCount(), countOf(out, "[STATS] - "));
+    TEST_ASSERT_EQUAL(1, countOf(out, "[INFO] - Schedule: clock"));
+    TEST_ASSERT_EQUAL(1, countOf(out, "link:caps:"));
+
+    size_t lastTask = out.rfind("[INFO] - Task ");
+    size_t firstStats = out.find("[STATS] - ");
+    size_t lastStats = out.rfind("[STATS] - ");
+    TEST_ASSERT_TRUE(lastTask < firstStats);
+    TEST_ASSERT_TRUE(lastStats < out.find("[INFO] - Schedule: clock"));
+    TEST_ASSERT_TRUE(out.find("[INFO] - Schedule: clock") < out.find("[INFO] - Link: "));
+
+    TEST_ASSERT_EQUAL_UINT16(lostBefore, getTxQueueStats().lost);
+    TEST_ASSERT_EQUAL_UINT32(blockedBefore, halSerialBlockedMicros());
+    TEST_ASSERT_TRUE(getTxQueueStats().maxControl <= TX_CONTROL_SIZE);
+}
+
+// A stop command does not wait for the report to finish
+void test_stop_command_runs_during_a_report() {
+    halSerialInject("[control]:stats:dump\n");
+    runFor(2);
+    halSerialInject("[control]:feeder:stop\n");
+    runFor(2000);
+
+    std::string out(halSerialOutput(), halSerialOutputLength());
+    size_t stop = out.find("[FEEDER] No active sequence");
+    TEST_ASSERT_TRUE(stop != std::string::npos);
+    TEST_ASSERT_TRUE(stop < out.rfind("[STATS] - "));
+}
+
+// Replies are printed piece by piece, without String temporaries on the heap
+void test_replies_do_not_allocate() {
+    halResetHeapStats();
+    halSerialInject("[control]:sensors:status\n[control]:stats:dump\n");
+    runFor(10);
+    halSerialInject("[control]:schedule:list\n[control]:link:status\n");
+    runFor(2000);
+    halSerialInject("[control]:power:status\n[control]:config:status\n");
+    runFor(100);
+    halSerialInject("[control]:log:status\n[control]:sensors:interval:5000\n");
+    runFor(100);
+
+    std::string out(halSerialOutput(), halSerialOutputLength());
+    TEST_ASSERT_TRUE(out.find("[INFO] - Config store: records=") != std::string::npos);
+    TEST_ASSERT_TRUE(out.find("[INFO] - Sensor print interval set to: 5000ms") != std::string::npos);
+    TEST_ASSERT_EQUAL_UINT32(0, halHeapStats().allocations);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_long_replies_arrive_complete_and_in_order);
+    RUN_TEST(test_stop_command_runs_during_a_report);
+    RUN_TEST(test_replies_do_not_allocate);
+    return UNITY_END();
+}
@@ -0,0 +1,116 @@
+// Offline sample log: ordering, oldest-drop and wrap-around of the byte ring
+#include <unity.h>
+#include "hal.h"
+#include "sample_log.h"
+
+static SampleLog sampleLog;
+
+// Payload derived from the timestamp, so every record can be checked
+static uint8_t payloadLength(uint32_t timestampMs) {
+    static const uint8_t kLengths[] = {
+        TELEMETRY_DHT_PAYLOAD_SIZE, TELEMETRY_SOIL_PAYLOAD_SIZE,
+        TELEMETRY_WEIGHT_PAYLOAD_SIZE, TELEMETRY_POWER_PAYLOAD_SIZE
+    };
+    return kLengths[timestampMs % 4];
+}
+
+static void append(uint32_t timestampMs) {
+    uint8_t payload[SAMPLE_LOG_MAX_PAYLOAD];
+    uint8_t length = payloadLength(timestampMs);
+    for (uint8_t i = 0; i < length; i++) {
+        payload[i] = (uint8_t)(timestampMs * 7 + i);
+    }
+    TEST_ASSERT_TRUE(sampleLogAppend(sampleLog, (uint8_t)(timestampMs % 4 + 1), timestampMs, payload, length));
+}
+
+static void checkRecord(const SampleLogRecord& record, uint32_t timestampMs) {
+    TEST_ASSERT_EQUAL_UINT32(timestampMs, record.timestampMs);
+    TEST_ASSERT_EQUAL_UINT8(timestampMs % 4 + 1, record.sensorId);
+    TEST_ASSERT_EQUAL_UINT8(payloadLength(timestampMs), record.length);
+    for (uint8_t i = 0; i < record.length; i++) {
+        TEST_ASSERT_EQUAL_UINT8((uint8_t)(timestampMs * 7 + i), record.payload[i]);
+    }
+}
+
+// Drain the log and check it holds exactly first..last in order
+static void checkContents(uint32_t first, uint32_t last) {
+    SampleLogRecord record;
+    for (uint32_t t = first; t <= last; t++) {
+        TEST_ASSERT_TRUE(sampleLogPeek(sampleLog, record));
+        checkRecord(record, t);
+        sampleLogDrop(sampleLog);
+    }
+    TEST_ASSERT_FALSE(sampleLogPeek(sampleLog, record));
+    TEST_ASSERT_EQUAL_UINT16(0, sampleLog.used);
+}
+
+// Storage too small for a whole cycle of records, so headers and payloads
+// are split at the end of the ring
+static uint8_t smallBytes[53];
+
+static void smallRead(uint16_t addr, uint8_t* data, uint16_t len) {
+    TEST_ASSERT_TRUE(addr + len <= sizeof(smallBytes));
+    memcpy(data, &smallBytes[addr], len);
+}
+
+static void smallWrite(uint16_t addr, const uint8_t* data, uint16_t len) {
+    TEST_ASSERT_TRUE(addr + len <= sizeof(smallBytes));
+    memcpy(&smallBytes[addr], data, len);
+}
+
+static const LogStorage kSmallStorage = { sizeof(smallBytes), smallRead, smallWrite };
+
+void setUp() {
+    sampleLogReset(sampleLog, sampleLogRamStorage());
+}
+
+void tearDown() {}
+
+void test_records_come_out_in_order() {
+    for (uint32_t t = 1; t <= 20; t++) append(t);
+    TEST_ASSERT_EQUAL_UINT16(20, sampleLog.records);
+    TEST_ASSERT_EQUAL_UINT32(0, sampleLog.dropped);
+    checkContents(1, 20);
+}
+
+void test_overfill_drops_the_oldest() {
+    const uint32_t total = 1000;
+    for (uint32_t t = 1; t <= total; t++) {
+        append(t);
+        TEST_ASSERT_TRUE(sampleLog.used <= SAMPLE_LOG_RAM_SIZE);
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(total, sampleLog.logged);
+    TEST_ASSERT_EQUAL_UINT32(total - sampleLog.records, sampleLog.dropped);
+    // Full except for less than one record
+    TEST_ASSERT_GREATER_THAN(SAMPLE_LOG_RAM_SIZE - SAMPLE_LOG_HEADER_SIZE - SAMPLE_LOG_MAX_PAYLOAD, sampleLog.used);
+    // The newest records survive, oldest first
+    checkContents(total - sampleLog.records + 1, total);
+}
+
+void test_split_records_at_the_ring_end() {
+    sampleLogReset(sampleLog, &kSmallStorage);
+    for (uint32_t t = 1; t <= 200; t++) {
+        append(t);
+        // Read back the oldest and newest after every append
+        SampleLogRecord record;
+        TEST_ASSERT_TRUE(sampleLogPeek(sampleLog, record));
+        checkRecord(record, t - sampleLog.records + 1);
+    }
+    checkContents(200 - sampleLog.records + 1, 200);
+}
+
+void test_oversized_record_is_rejected() {
+    uint8_t payload[SAMPLE_LOG_MAX_PAYLOAD + 1] = {0};
+    TEST_ASSERT_FALSE(sampleLogAppend(sampleLog, 1, 1, payload, sizeof(payload)));
+    TEST_ASSERT_EQUAL_UINT16(0, sampleLog.records);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_records_come_out_in_order);
+    RUN_TEST(test_overfill_drops_the_oldest);
+    RUN_TEST(test_split_records_at_the_ring_end);
+    RUN_TEST(test_oversized_record_is_rejected);
+    return UNITY_END();
+}
@@ -0,0 +1,116 @@
+// Baud switch handshake and the optional idle fallback
+#include <unity.h>
+#include <string>
+#include "hal.h"
+#include "sensor_service.h"
+#include "task_scheduler.h"
+#include "config_store.h"
+#include "power_manager.h"
+#include "serial_link.h"
+#include "serial_tx.h"
+#include "power_monitor.h"
+#include "soil_sensor.h"
+
+static void boot() {
+    static bool booted = false;
+    if (booted) return;
+    booted = true;
+
+    // Normal power level, see test_bench_loop
+    halSetAnalogInput(LOAD_VOLTAGE_PIN, 582);
+    halSetAnalogInput(LOAD_CURRENT_PIN, 512);
+    halSetAnalogInput(SOLAR_VOLTAGE_PIN, 818);
+    halSetAnalogInput(SOLAR_CURRENT_PIN, 512);
+    halSetAnalogInput(SOIL_PIN, 500);
+
+    initSerialLink();
+    initConfigStore();
+    initPowerManager();
+    initAllSensors();
+    initSensorService();
+    serialTxSetDirect(false);
+}
+
+// Run the loop for ms of virtual time, sending an empty line every keepaliveMs (0 = none)
+static void runFor(unsigned long ms, unsigned long keepaliveMs = 0) {
+    unsigned long startMs = millis();
+    unsigned long lastKeepalive = startMs;
+    while (millis() - startMs < ms) {
+        if (keepaliveMs > 0 && millis() - lastKeepalive >= keepaliveMs) {
+            halSerialInject("\n");
+            lastKeepalive = millis();
+        }
+        controlSensor();
+        runScheduler();
+        halAdvanceMicros(1000UL);
+    }
+}
+
+static std::string output() {
+    return std::string(halSerialOutput(), halSerialOutputLength());
+}
+
+static void switchTo(unsigned long baud) {
+    TEST_ASSERT_TRUE(linkRequestBaud(baud));
+    runFor(200);
+    TEST_ASSERT_EQUAL_UINT32(baud, halSerialBaud());
+    halSerialInject("\n[control]:link:ack\n");
+    runFor(50);
+    TEST_ASSERT_FALSE(isLinkSwitchPending());
+    TEST_ASSERT_EQUAL_UINT32(baud, getLinkBaud());
+}
+
+void setUp() {
+    boot();
+    setLinkIdleFallback(LINK_IDLE_FALLBACK_MS);
+    if (getLinkBaud() != LINK_DEFAULT_BAUD) {
+        TEST_ASSERT_TRUE(linkRequestBaud(LINK_DEFAULT_BAUD));
+        runFor(200);
+        halSerialInject("\n[control]:link:ack\n");
+        runFor(50);
+    }
+    halSerialClearOutput();
+}
+
+void tearDown() {}
+
+void test_switch_without_ack_falls_back() {
+    TEST_ASSERT_TRUE(linkRequestBaud(500000UL));
+    TEST_ASSERT_FALSE(linkRequestBaud(250000UL));
+    runFor(LINK_ACK_TIMEOUT_MS + 500);
+    TEST_ASSERT_EQUAL_UINT32(LINK_DEFAULT_BAUD, getLinkBaud());
+    TEST_ASSERT_TRUE(output().find("link:baud:fallback:115200") != std::string::npos);
+}
+
+// A host that only sends the odd command keeps the raised rate
+void test_idle_host_keeps_the_rate_by_default() {
+    switchTo(500000UL);
+    runFor(180000UL);
+    TEST_ASSERT_EQUAL_UINT32(500000UL, getLinkBaud());
+}
+
+void test_idle_fallback_when_enabled() {
+    switchTo(250000UL);
+    halSerialInject("[control]:link:idle:60000\n");
+    runFor(59000UL);
+    TEST_ASSERT_EQUAL_UINT32(250000UL, getLinkBaud());
+    runFor(2000UL);
+    TEST_ASSERT_EQUAL_UINT32(LINK_DEFAULT_BAUD, getLinkBaud());
+    TEST_ASSERT_EQUAL_UINT32(LINK_DEFAULT_BAUD, halSerialBaud());
+}
+
+void test_empty_lines_keep_the_link_up() {
+    switchTo(1000000UL);
+    setLinkIdleFallback(60000UL);
+    runFor(180000UL, 30000UL);
+    TEST_ASSERT_EQUAL_UINT32(1000000UL, getLinkBaud());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_switch_without_ack_falls_back);
+    RUN_TEST(test_idle_host_keeps_the_rate_by_default);
+    RUN_TEST(test_idle_fallback_when_enabled);
+    RUN_TEST(test_empty_lines_keep_the_link_up);
+    return UNITY_END();
+}
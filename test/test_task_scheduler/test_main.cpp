@@ -0,0 +1,108 @@
+// Scheduler tests on the virtual clock. The task table cannot be cleared, so
+// every test registers its own tasks and disables them when it is done.
+#include <unity.h>
+#include "hal.h"
+#include "task_scheduler.h"
+
+static char runLog[16];
+static uint8_t runCount;
+
+static void logRun(char id) {
+    if (runCount < sizeof(runLog) - 1) runLog[runCount++] = id;
+    runLog[runCount] = '\0';
+}
+
+static void taskLow() { logRun('L'); }
+static void taskHigh() { logRun('H'); }
+static void taskCritical() { logRun('C'); }
+static void taskPeriodic() { logRun('P'); }
+static void taskSlow() { halAdvanceMicros(3000); }
+
+static uint8_t positionOf(const __FlashStringHelper* name) {
+    TaskInfo info;
+    for (uint8_t i = 0; getTaskInfo(i, info); i++) {
+        if (info.name == name) return i;
+    }
+    return 0xFF;
+}
+
+void setUp() {
+    runCount = 0;
+    runLog[0] = '\0';
+}
+
+void tearDown() {}
+
+void test_pass_runs_tasks_in_priority_order() {
+    int8_t low = registerTask(F("low"), taskLow, 0, 0, TASK_PRIORITY_LOW, 100);
+    int8_t high = registerTask(F("high"), taskHigh, 0, 0, TASK_PRIORITY_HIGH, 100);
+    int8_t critical = registerTask(F("critical"), taskCritical, 0, 0, TASK_PRIORITY_CRITICAL, 100);
+
+    runScheduler();
+    TEST_ASSERT_EQUAL_STRING("CHL", runLog);
+
+    setTaskEnabled(low, false);
+    setTaskEnabled(high, false);
+    setTaskEnabled(critical, false);
+}
+
+void test_periodic_task_keeps_its_cadence() {
+    int8_t id = registerTask(F("periodic"), taskPeriodic, 100, 10, TASK_PRIORITY_NORMAL, 100);
+
+    for (int i = 0; i < 1000; i++) {
+        runScheduler();
+        halAdvanceMicros(1000);
+    }
+    // Due at 0, 100, ... 900 ms of the 1000 ms window
+    TEST_ASSERT_EQUAL_UINT(10, runCount);
+
+    TaskInfo info;
+    TEST_ASSERT_TRUE(getTaskInfo(positionOf(F("periodic")), info));
+    TEST_ASSERT_EQUAL_UINT16(0, info.deadlineMisses);
+    setTaskEnabled(id, false);
+}
+
+void test_late_run_counts_a_deadline_miss() {
+    int8_t id = registerTask(F("late"), taskPeriodic, 50, 5, TASK_PRIORITY_NORMAL, 100);
+    runScheduler();
+    halAdvanceMicros(80000UL);   // 30 ms past the next due time
+    runScheduler();
+
+    TaskInfo info;
+    TEST_ASSERT_TRUE(getTaskInfo(positionOf(F("late")), info));
+    TEST_ASSERT_EQUAL_UINT16(1, info.deadlineMisses);
+    setTaskEnabled(id, false);
+}
+
+void test_long_run_counts_a_budget_overrun() {
+    int8_t id = registerTask(F("slow"), taskSlow, 10, 5, TASK_PRIORITY_NORMAL, 2000);
+    runScheduler();
+
+    TaskInfo info;
+    TEST_ASSERT_TRUE(getTaskInfo(positionOf(F("slow")), info));
+    TEST_ASSERT_EQUAL_UINT16(1, info.budgetOverruns);
+    TEST_ASSERT_EQUAL_UINT32(3000, info.timing->maxUs);
+    setTaskEnabled(id, false);
+}
+
+void test_delayed_task_waits() {
+    int8_t id = registerTask(F("delayed"), taskPeriodic, 0, 0, TASK_PRIORITY_NORMAL, 100);
+    delayTask(id, 20);
+    runScheduler();
+    TEST_ASSERT_EQUAL_UINT(0, runCount);
+
+    halAdvanceMicros(20000UL);
+    runScheduler();
+    TEST_ASSERT_EQUAL_UINT(1, runCount);
+    setTaskEnabled(id, false);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_pass_runs_tasks_in_priority_order);
+    RUN_TEST(test_periodic_task_keeps_its_cadence);
+    RUN_TEST(test_late_run_counts_a_deadline_miss);
+    RUN_TEST(test_long_run_counts_a_budget_overrun);
+    RUN_TEST(test_delayed_task_waits);
+    return UNITY_END();
+}
@@ -0,0 +1,197 @@
+// Binary telemetry framing: record -> CRC -> COBS -> frame and back
+#include <unity.h>
+#include <string.h>
+#include "telemetry_codec.h"
+
+static uint8_t frame[TELEMETRY_MAX_FRAME];
+static uint8_t payload[TELEMETRY_MAX_PAYLOAD];
+
+static TelemetryRecordHeader makeHeader(uint8_t sensorId) {
+    TelemetryRecordHeader header;
+    header.sensorId = sensorId;
+    header.seq = 0x1200;                 // Low byte is zero on purpose
+    header.timestampMs = 0x00A0B000UL;
+    return header;
+}
+
+// Encode and return the body between the two delimiters
+static size_t encodeBody(const TelemetryRecordHeader& header, const uint8_t* data, size_t len,
+                         const uint8_t*& body) {
+    size_t frameLen = telemetryEncodeFrame(header, data, len, frame, sizeof(frame));
+    TEST_ASSERT_GREATER_THAN(2, frameLen);
+    TEST_ASSERT_EQUAL_HEX8(0x00, frame[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, frame[frameLen - 1]);
+    for (size_t i = 1; i < frameLen - 1; i++) {
+        TEST_ASSERT_TRUE(frame[i] != 0x00);
+    }
+    body = &frame[1];
+    return frameLen - 2;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_crc_matches_ccitt_false_check_value() {
+    const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    TEST_ASSERT_EQUAL_HEX16(0x29B1, telemetryCrc16(check, sizeof(check)));
+}
+
+void test_frame_round_trip() {
+    // DHT payload with zeros in it: 25.6 C, 0.0 %
+    uint8_t dht[TELEMETRY_DHT_PAYLOAD_SIZE];
+    telemetryPutU16(&dht[0], 256);
+    telemetryPutU16(&dht[2], 0);
+    TelemetryRecordHeader header = makeHeader(TELEMETRY_ID_DHT_FEEDER);
+
+    const uint8_t* body;
+    size_t bodyLen = encodeBody(header, dht, sizeof(dht), body);
+
+    TelemetryRecordHeader decoded;
+    size_t payloadLen = 0;
+    TEST_ASSERT_TRUE(telemetryDecodeFrame(body, bodyLen, decoded, payload, sizeof(payload), payloadLen));
+    TEST_ASSERT_EQUAL_UINT8(TELEMETRY_ID_DHT_FEEDER, decoded.sensorId);
+    TEST_ASSERT_EQUAL_UINT16(header.seq, decoded.seq);
+    TEST_ASSERT_EQUAL_UINT32(header.timestampMs, decoded.timestampMs);
+    TEST_ASSERT_EQUAL_size_t(sizeof(dht), payloadLen);
+    TEST_ASSERT_EQUAL_MEMORY(dht, payload, sizeof(dht));
+}
+
+void test_largest_record_round_trips() {
+    uint8_t data[TELEMETRY_MAX_PAYLOAD];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i % 3 == 0 ? 0 : i);
+    }
+    TelemetryRecordHeader header = makeHeader(TELEMETRY_ID_SNAPSHOT);
+
+    const uint8_t* body;
+    size_t bodyLen = encodeBody(header, data, sizeof(data), body);
+
+    TelemetryRecordHeader decoded;
+    size_t payloadLen = 0;
+    TEST_ASSERT_TRUE(telemetryDecodeFrame(body, bodyLen, decoded, payload, sizeof(payload), payloadLen));
+    TEST_ASSERT_EQUAL_size_t(sizeof(data), payloadLen);
+    TEST_ASSERT_EQUAL_MEMORY(data, payload, sizeof(data));
+}
+
+void test_oversized_payload_is_not_encoded() {
+    uint8_t data[TELEMETRY_MAX_PAYLOAD + 1] = {0};
+    TelemetryRecordHeader header = makeHeader(TELEMETRY_ID_SNAPSHOT);
+    TEST_ASSERT_EQUAL_size_t(0, telemetryEncodeFrame(header, data, sizeof(data), frame, sizeof(frame)));
+}
+
+void test_corrupt_crc_is_rejected() {
+    // Build the record by hand so only the CRC is wrong and the COBS layer is valid
+    uint8_t raw[TELEMETRY_HEADER_SIZE + TELEMETRY_WEIGHT_PAYLOAD_SIZE + TELEMETRY_CRC_SIZE];
+    raw[0] = TELEMETRY_ID_WEIGHT;
+    telemetryPutU16(&raw[1], 7);
+    telemetryPutU32(&raw[3], 123456);
+    telemetryPutU32(&raw[TELEMETRY_HEADER_SIZE], 1500);
+    size_t bodyLen = TELEMETRY_HEADER_SIZE + TELEMETRY_WEIGHT_PAYLOAD_SIZE;
+    uint16_t crc = telemetryCrc16(raw, bodyLen);
+
+    TelemetryRecordHeader decoded;
+    size_t payloadLen = 0;
+    uint8_t encoded[TELEMETRY_MAX_FRAME];
+
+    telemetryPutU16(&raw[bodyLen], crc);
+    size_t encodedLen = cobsEncode(raw, sizeof(raw), encoded, sizeof(encoded));
+    TEST_ASSERT_TRUE(telemetryDecodeFrame(encoded, encodedLen, decoded, payload, sizeof(payload), payloadLen));
+
+    telemetryPutU16(&raw[bodyLen], (uint16_t)(crc ^ 0x0100));
+    encodedLen = cobsEncode(raw, sizeof(raw), encoded, sizeof(encoded));
+    TEST_ASSERT_FALSE(telemetryDecodeFrame(encoded, encodedLen, decoded, payload, sizeof(payload), payloadLen));
+
+    // A flipped payload bit with the original CRC
+    telemetryPutU16(&raw[bodyLen], crc);
+    raw[TELEMETRY_HEADER_SIZE] ^= 0x01;
+    encodedLen = cobsEncode(raw, sizeof(raw), encoded, sizeof(encoded));
+    TEST_ASSERT_FALSE(telemetryDecodeFrame(encoded, encodedLen, decoded, payload, sizeof(payload), payloadLen));
+}
+
+void test_truncated_frame_is_rejected() {
+    uint8_t soil[TELEMETRY_SOIL_PAYLOAD_SIZE] = {42};
+    TelemetryRecordHeader header = makeHeader(TELEMETRY_ID_SOIL);
+
+    const uint8_t* body;
+    size_t bodyLen = encodeBody(header, soil, sizeof(soil), body);
+
+    TelemetryRecordHeader decoded;
+    size_t payloadLen = 0;
+    for (size_t len = 0; len < bodyLen; len++) {
+        TEST_ASSERT_FALSE(telemetryDecodeFrame(body, len, decoded, payload, sizeof(payload), payloadLen));
+    }
+}
+
+void test_payload_larger_than_buffer_is_rejected() {
+    uint8_t data[TELEMETRY_POWER_PAYLOAD_SIZE] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+    TelemetryRecordHeader header = makeHeader(TELEMETRY_ID_POWER_MONITOR);
+
+    const uint8_t* body;
+    size_t bodyLen = encodeBody(header, data, sizeof(data), body);
+
+    TelemetryRecordHeader decoded;
+    size_t payloadLen = 0;
+    TEST_ASSERT_FALSE(telemetryDecodeFrame(body, bodyLen, decoded, payload, sizeof(data) - 1, payloadLen));
+}
+
+void test_cobs_long_run_without_zeros() {
+    uint8_t in[300];
+    uint8_t encoded[310];
+    uint8_t decoded[300];
+    for (size_t i = 0; i < sizeof(in); i++) {
+        in[i] = (uint8_t)(i % 255 + 1);
+    }
+    size_t encodedLen = cobsEncode(in, sizeof(in), encoded, sizeof(encoded));
+    TEST_ASSERT_GREATER_THAN(sizeof(in), encodedLen);
+    TEST_ASSERT_EQUAL_size_t(sizeof(in), cobsDecode(encoded, encodedLen, decoded, sizeof(decoded)));
+    TEST_ASSERT_EQUAL_MEMORY(in, decoded, sizeof(in));
+}
+
+// Snapshot with the feeder DHT lacking a reading: its block is still in
+// place, but it is reported as absent instead of as a 0 C reading
+void test_snapshot_sensor_without_reading_is_absent() {
+    uint8_t snapshot[TELEMETRY_SNAPSHOT_PAYLOAD_SIZE];
+    memset(snapshot, 0, sizeof(snapshot));
+    size_t offset = 0;
+    telemetryPutU16(&snapshot[offset], 120);                        // DHT system
+    telemetryPutU16(&snapshot[offset + 2], 256);
+    offset += TELEMETRY_SNAPSHOT_AGE_SIZE + TELEMETRY_DHT_PAYLOAD_SIZE;
+    telemetryPutU16(&snapshot[offset], TELEMETRY_SNAPSHOT_NO_READING); // DHT feeder
+    offset += TELEMETRY_SNAPSHOT_AGE_SIZE + TELEMETRY_DHT_PAYLOAD_SIZE;
+    telemetryPutU16(&snapshot[offset], 30);                         // Soil
+    snapshot[offset + 2] = 42;
+    offset += TELEMETRY_SNAPSHOT_AGE_SIZE + TELEMETRY_SOIL_PAYLOAD_SIZE;
+    telemetryPutU16(&snapshot[offset], TELEMETRY_SNAPSHOT_MAX_AGE); // Weight, oldest valid age
+    offset += TELEMETRY_SNAPSHOT_AGE_SIZE + TELEMETRY_WEIGHT_PAYLOAD_SIZE;
+    telemetryPutU16(&snapshot[offset], 0);                          // Power monitor
+    snapshot[offset + TELEMETRY_SNAPSHOT_AGE_SIZE + 10] = 1;
+
+    uint16_t age = 0;
+    const uint8_t* block = NULL;
+    TEST_ASSERT_TRUE(telemetrySnapshotBlock(snapshot, TELEMETRY_ID_DHT_SYSTEM, age, block));
+    TEST_ASSERT_EQUAL_UINT16(120, age);
+    TEST_ASSERT_EQUAL_UINT16(256, telemetryGetU16(block));
+    TEST_ASSERT_FALSE(telemetrySnapshotBlock(snapshot, TELEMETRY_ID_DHT_FEEDER, age, block));
+    TEST_ASSERT_TRUE(telemetrySnapshotBlock(snapshot, TELEMETRY_ID_SOIL, age, block));
+    TEST_ASSERT_EQUAL_UINT8(42, block[0]);
+    TEST_ASSERT_TRUE(telemetrySnapshotBlock(snapshot, TELEMETRY_ID_WEIGHT, age, block));
+    TEST_ASSERT_EQUAL_UINT16(TELEMETRY_SNAPSHOT_MAX_AGE, age);
+    TEST_ASSERT_TRUE(telemetrySnapshotBlock(snapshot, TELEMETRY_ID_POWER_MONITOR, age, block));
+    TEST_ASSERT_EQUAL_UINT8(1, block[10]);
+    TEST_ASSERT_EQUAL_PTR(&snapshot[TELEMETRY_SNAPSHOT_PAYLOAD_SIZE - TELEMETRY_POWER_PAYLOAD_SIZE], block);
+    TEST_ASSERT_FALSE(telemetrySnapshotBlock(snapshot, TELEMETRY_ID_SNAPSHOT, age, block));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_crc_matches_ccitt_false_check_value);
+    RUN_TEST(test_frame_round_trip);
+    RUN_TEST(test_largest_record_round_trips);
+    RUN_TEST(test_oversized_payload_is_not_encoded);
+    RUN_TEST(test_corrupt_crc_is_rejected);
+    RUN_TEST(test_truncated_frame_is_rejected);
+    RUN_TEST(test_payload_larger_than_buffer_is_rejected);
+    RUN_TEST(test_cobs_long_run_without_zeros);
+    RUN_TEST(test_snapshot_sensor_without_reading_is_absent);
+    return UNITY_END();
+}
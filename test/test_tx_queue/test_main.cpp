@@ -0,0 +1,128 @@
+// Transmit queue rings: priorities, dropping and the record being sent
+#include <unity.h>
+#include <string>
+#include "hal.h"
+#include "tx_queue.h"
+
+// Record of length bytes, all equal to fill
+static void queueRecord(TxClass cls, uint8_t key, uint8_t fill, size_t length) {
+    uint8_t bytes[TX_TELEMETRY_SIZE];
+    memset(bytes, fill, length);
+    txQueueBegin(cls, key);
+    txQueueWrite(bytes, length);
+    txQueueEnd();
+}
+
+static std::string readAll(bool controlOnly = false) {
+    std::string out;
+    uint8_t chunk[16];
+    size_t count;
+    while ((count = txQueueRead(chunk, sizeof(chunk), controlOnly)) > 0) {
+        out.append((const char*)chunk, count);
+    }
+    return out;
+}
+
+void setUp() {
+    txQueueReset();
+}
+
+void tearDown() {}
+
+void test_control_goes_first_and_records_stay_whole() {
+    queueRecord(TX_TELEMETRY, 1, 't', 40);
+    queueRecord(TX_CONTROL, TX_KEY_NONE, 'c', 10);
+    std::string out = readAll();
+    TEST_ASSERT_EQUAL(50, out.size());
+    TEST_ASSERT_TRUE(out == std::string(10, 'c') + std::string(40, 't'));
+}
+
+void test_oldest_telemetry_is_dropped_when_full() {
+    queueRecord(TX_TELEMETRY, 1, 'a', 300);
+    queueRecord(TX_TELEMETRY, 2, 'b', 300);
+    queueRecord(TX_TELEMETRY, 3, 'c', 300);
+    TEST_ASSERT_EQUAL_UINT16(1, getTxQueueStats().dropped);
+    TEST_ASSERT_EQUAL_UINT16(0, getTxQueueStats().lost);
+    TEST_ASSERT_TRUE(readAll() == std::string(300, 'b') + std::string(300, 'c'));
+}
+
+void test_newer_record_replaces_a_waiting_one() {
+    queueRecord(TX_TELEMETRY, 1, 'a', 20);
+    queueRecord(TX_TELEMETRY, 2, 'b', 20);
+    queueRecord(TX_TELEMETRY, 1, 'A', 20);
+    TEST_ASSERT_EQUAL_UINT16(1, getTxQueueStats().coalesced);
+    TEST_ASSERT_TRUE(readAll() == std::string(20, 'b') + std::string(20, 'A'));
+}
+
+// The head is partly sent: the record behind it is dropped and the rest of
+// the head moved up, without changing a byte of what the UART sees
+void test_record_behind_a_sending_head_is_dropped() {
+    queueRecord(TX_TELEMETRY, 1, 'a', 300);
+    queueRecord(TX_TELEMETRY, 2, 'b', 300);
+    uint8_t first[100];
+    TEST_ASSERT_EQUAL(100, txQueueRead(first, sizeof(first), false));
+    TEST_ASSERT_TRUE(txQueueSending());
+
+    queueRecord(TX_TELEMETRY, 3, 'c', 250);
+    TEST_ASSERT_EQUAL_UINT16(1, getTxQueueStats().dropped);
+    TEST_ASSERT_EQUAL_UINT16(0, getTxQueueStats().lost);
+    TEST_ASSERT_TRUE(readAll() == std::string(200, 'a') + std::string(250, 'c'));
+    TEST_ASSERT_EQUAL_UINT16(TX_TELEMETRY_SIZE, txQueueFree(TX_TELEMETRY));
+}
+
+// Same with the ring wrapped and a short record behind the head, so the
+// moved rest overlaps itself and crosses the end of the ring
+void test_sending_head_rest_is_moved_across_the_wrap() {
+    queueRecord(TX_TELEMETRY, 1, 'x', 500);
+    readAll();
+    uint8_t bytes[300];
+    for (unsigned i = 0; i < sizeof(bytes); i++) bytes[i] = (uint8_t)i;
+    txQueueBegin(TX_TELEMETRY, 1);
+    txQueueWrite(bytes, sizeof(bytes));
+    txQueueEnd();
+    queueRecord(TX_TELEMETRY, 2, 'b', 10);
+    uint8_t first[50];
+    TEST_ASSERT_EQUAL(50, txQueueRead(first, sizeof(first), false));
+
+    queueRecord(TX_TELEMETRY, 3, 'c', 350);
+    std::string expected((const char*)bytes + 50, sizeof(bytes) - 50);
+    TEST_ASSERT_TRUE(readAll() == expected + std::string(350, 'c'));
+}
+
+void test_no_room_behind_a_lone_sending_head() {
+    queueRecord(TX_TELEMETRY, 1, 'a', 600);
+    uint8_t first[10];
+    txQueueRead(first, sizeof(first), false);
+    queueRecord(TX_TELEMETRY, 2, 'b', 100);
+    TEST_ASSERT_EQUAL_UINT16(1, getTxQueueStats().lost);
+    TEST_ASSERT_TRUE(readAll() == std::string(590, 'a'));
+}
+
+// The queue itself never drops control records; one that does not fit is
+// lost and counted (SerialTx waits for room before writing one)
+void test_control_is_not_dropped_for_space() {
+    queueRecord(TX_CONTROL, TX_KEY_NONE, 'a', 150);
+    queueRecord(TX_CONTROL, TX_KEY_NONE, 'b', 150);
+    TEST_ASSERT_EQUAL_UINT16(0, getTxQueueStats().dropped);
+    TEST_ASSERT_EQUAL_UINT16(1, getTxQueueStats().lost);
+    TEST_ASSERT_TRUE(readAll() == std::string(150, 'a'));
+}
+
+void test_bulk_leaves_the_reserve_free() {
+    TEST_ASSERT_EQUAL_UINT16(TX_TELEMETRY_SIZE - TX_BULK_RESERVE, txQueueFree(TX_BULK));
+    queueRecord(TX_BULK, TX_KEY_NONE, 'd', 100);
+    TEST_ASSERT_EQUAL_UINT16(TX_TELEMETRY_SIZE - TX_BULK_RESERVE - 100 - TX_RECORD_HEADER, txQueueFree(TX_BULK));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_control_goes_first_and_records_stay_whole);
+    RUN_TEST(test_oldest_telemetry_is_dropped_when_full);
+    RUN_TEST(test_newer_record_replaces_a_waiting_one);
+    RUN_TEST(test_record_behind_a_sending_head_is_dropped);
+    RUN_TEST(test_sending_head_rest_is_moved_across_the_wrap);
+    RUN_TEST(test_no_room_behind_a_lone_sending_head);
+    RUN_TEST(test_control_is_not_dropped_for_space);
+    RUN_TEST(test_bulk_leaves_the_reserve_free);
+    return UNITY_END();
+}
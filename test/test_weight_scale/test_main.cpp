@@ -0,0 +1,72 @@
+// Weight conversion through the Q16.16 scale factor, and its accepted range
+#include <unity.h>
+#include "hal.h"
+#include "weight_sensor.h"
+#include "config_store.h"
+
+// Fill the sample ring with one raw reading
+static void sampleRaw(long raw) {
+    halSetLoadCellRaw(raw);
+    for (uint8_t i = 0; i < WEIGHT_RING_SIZE + WEIGHT_SETTLE_SAMPLES; i++) {
+        halAdvanceMicros(100000UL);
+        updateWeightSampler();
+    }
+}
+
+void setUp() {
+    halEraseEeprom();
+    initConfigStore();
+    initWeight();
+    scale.set_offset(0);
+}
+
+void tearDown() {}
+
+void test_default_factor_converts_to_milligrams() {
+    sampleRaw(35445);   // One kg at the default factor
+    TEST_ASSERT_INT32_WITHIN(2, 1000000L, readWeightMg(WEIGHT_AVERAGE_SAMPLES));
+}
+
+void test_range_limits_are_accepted() {
+    TEST_ASSERT_TRUE(setWeightScaleFactor(WEIGHT_SCALE_FACTOR_MIN));
+    sampleRaw(31);
+    TEST_ASSERT_INT32_WITHIN(2, 1000000L, readWeightMg(WEIGHT_AVERAGE_SAMPLES));
+
+    TEST_ASSERT_TRUE(setWeightScaleFactor(-WEIGHT_SCALE_FACTOR_MIN));
+    TEST_ASSERT_INT32_WITHIN(2, -1000000L, readWeightMg(WEIGHT_AVERAGE_SAMPLES));
+
+    TEST_ASSERT_TRUE(setWeightScaleFactor(WEIGHT_SCALE_FACTOR_MAX));
+    sampleRaw(5000000L);
+    // 0.1 mg per count is truncated to 6553/65536 in Q16.16
+    TEST_ASSERT_INT32_WITHIN(50, 500000L, readWeightMg(WEIGHT_AVERAGE_SAMPLES));
+}
+
+void test_out_of_range_factor_is_rejected() {
+    TEST_ASSERT_TRUE(setWeightScaleFactor(20000.0f));
+    TEST_ASSERT_FALSE(setWeightScaleFactor(0.0f));
+    TEST_ASSERT_FALSE(setWeightScaleFactor(30.0f));
+    TEST_ASSERT_FALSE(setWeightScaleFactor(-30.0f));
+    TEST_ASSERT_FALSE(setWeightScaleFactor(2.0e7f));
+    TEST_ASSERT_EQUAL_FLOAT(20000.0f, getWeightScaleFactor());
+
+    float stored = 0;
+    TEST_ASSERT_TRUE(configGetFloat(CONFIG_KEY_SCALE_FACTOR, stored));
+    TEST_ASSERT_EQUAL_FLOAT(20000.0f, stored);
+}
+
+void test_stored_factor_out_of_range_is_ignored() {
+    TEST_ASSERT_TRUE(setWeightScaleFactor(FIXED_SCALE_FACTOR));
+    // As if written by older firmware, which did not check the range
+    configSetFloat(CONFIG_KEY_SCALE_FACTOR, 12.0f);
+    initWeight();
+    TEST_ASSERT_EQUAL_FLOAT(FIXED_SCALE_FACTOR, getWeightScaleFactor());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_default_factor_converts_to_milligrams);
+    RUN_TEST(test_range_limits_are_accepted);
+    RUN_TEST(test_out_of_range_factor_is_rejected);
+    RUN_TEST(test_stored_factor_out_of_range_is_ignored);
+    return UNITY_END();
+}
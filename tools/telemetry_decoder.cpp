@@ -0,0 +1,172 @@
+// Host-side decoder for the binary telemetry mode ([control]:sensors:format:binary).
+//
+// Reads the raw serial stream from stdin (or a capture file), passes plain-text
+// lines through unchanged and prints each binary frame as a "[SEND] - " JSON
+// line, so existing host parsers can consume binary captures.
+//
+// Build:
+//   g++ -std=c++11 -Iinclude tools/telemetry_decoder.cpp src/services/telemetry_codec.cpp -o telemetry_decoder
+// Usage:
+//   ./telemetry_decoder < capture.bin
+//   ./telemetry_decoder /dev/ttyACM0
+
+#include <stdio.h>
+#include <string.h>
+#include "telemetry_codec.h"
+
+static int16_t asI16(uint16_t v) { return (int16_t)v; }
+
+static double powerLoadVoltage(const uint8_t* p) { return telemetryGetU16(&p[4]) / 1000.0; }
+
+static void printRecord(const TelemetryRecordHeader& header, const uint8_t* payload, size_t len) {
+    printf("[SEND] - {\"seq\":%u,\"t\":%lu,", (unsigned)header.seq, (unsigned long)header.timestampMs);
+
+    switch (header.sensorId) {
+        case TELEMETRY_ID_DHT_SYSTEM:
+        case TELEMETRY_ID_DHT_FEEDER:
+            if (len != TELEMETRY_DHT_PAYLOAD_SIZE) break;
+            printf("\"name\":\"%s\",\"value\":["
+                   "{\"type\":\"temperature\",\"unit\":\"C\",\"value\":%.1f},"
+                   "{\"type\":\"humidity\",\"unit\":\"%%\",\"value\":%.1f}]}\n",
+                   header.sensorId == TELEMETRY_ID_DHT_SYSTEM ? "DHT22_SYSTEM" : "DHT22_FEEDER",
+                   asI16(telemetryGetU16(&payload[0])) / 10.0,
+                   telemetryGetU16(&payload[2]) / 10.0);
+            return;
+        case TELEMETRY_ID_SOIL:
+            if (len != TELEMETRY_SOIL_PAYLOAD_SIZE) break;
+            printf("\"name\":\"SOIL_MOISTURE\",\"value\":["
+                   "{\"type\":\"soil_moisture\",\"unit\":\"%%\",\"value\":%u}]}\n",
+                   (unsigned)payload[0]);
+            return;
+        case TELEMETRY_ID_WEIGHT:
+            if (len != TELEMETRY_WEIGHT_PAYLOAD_SIZE) break;
+            printf("\"name\":\"HX711_FEEDER\",\"value\":["
+                   "{\"type\":\"weight\",\"unit\":\"kg\",\"value\":%.3f}]}\n",
+                   (int32_t)telemetryGetU32(&payload[0]) / 1000.0);
+            return;
+        case TELEMETRY_ID_POWER_MONITOR: {
+            if (len != TELEMETRY_POWER_PAYLOAD_SIZE) break;
+            double loadV = powerLoadVoltage(payload);
+            printf("\"name\":\"POWER_MONITOR\",\"value\":["
+                   "{\"type\":\"solarVoltage\",\"unit\":\"V\",\"value\":%.3f},"
+                   "{\"type\":\"solarCurrent\",\"unit\":\"A\",\"value\":%.3f},"
+                   "{\"type\":\"loadVoltage\",\"unit\":\"V\",\"value\":%.3f},"
+                   "{\"type\":\"loadCurrent\",\"unit\":\"A\",\"value\":%.3f},"
+                   "{\"type\":\"batteryVoltage\",\"unit\":\"V\",\"value\":%.3f},"
+                   "{\"type\":\"batteryPercentage\",\"unit\":\"%%\",\"value\":%.1f},"
+                   "{\"type\":\"batteryStatus\",\"unit\":\"string\",\"value\":\"%s\"}]}\n",
+                   telemetryGetU16(&payload[0]) / 1000.0,
+                   asI16(telemetryGetU16(&payload[2])) / 1000.0,
+                   loadV,
+                   asI16(telemetryGetU16(&payload[6])) / 1000.0,
+                   loadV,
+                   telemetryGetU16(&payload[8]) / 10.0,
+                   payload[10] ? "charging" : "discharging");
+            return;
+        }
+        case TELEMETRY_ID_SNAPSHOT: {
+            if (len != TELEMETRY_SNAPSHOT_PAYLOAD_SIZE) break;
+            // Same compact layout as the firmware's JSON snapshot, which also
+            // leaves out sensors without a current reading
+            unsigned long t = (unsigned long)header.timestampMs;
+            printf("\"name\":\"SNAPSHOT\",\"sensors\":{");
+            const char* sep = "";
+            uint16_t age;
+            const uint8_t* p;
+            for (uint8_t id = TELEMETRY_ID_DHT_SYSTEM; id <= TELEMETRY_ID_DHT_FEEDER; id++) {
+                if (!telemetrySnapshotBlock(payload, id, age, p)) continue;
+                printf("%s\"%s\":{\"t\":%lu,\"temperature\":%.1f,\"humidity\":%.1f}", sep,
+                       id == TELEMETRY_ID_DHT_SYSTEM ? "DHT22_SYSTEM" : "DHT22_FEEDER",
+                       t - age,
+                       asI16(telemetryGetU16(&p[0])) / 10.0,
+                       telemetryGetU16(&p[2]) / 10.0);
+                sep = ",";
+            }
+            if (telemetrySnapshotBlock(payload, TELEMETRY_ID_SOIL, age, p)) {
+                printf("%s\"SOIL_MOISTURE\":{\"t\":%lu,\"soil_moisture\":%u}", sep, t - age, (unsigned)p[0]);
+                sep = ",";
+            }
+            if (telemetrySnapshotBlock(payload, TELEMETRY_ID_WEIGHT, age, p)) {
+                printf("%s\"HX711_FEEDER\":{\"t\":%lu,\"weight\":%.3f}", sep,
+                       t - age, (int32_t)telemetryGetU32(&p[0]) / 1000.0);
+                sep = ",";
+            }
+            if (telemetrySnapshotBlock(payload, TELEMETRY_ID_POWER_MONITOR, age, p)) {
+                printf("%s\"POWER_MONITOR\":{\"t\":%lu,\"solarVoltage\":%.3f,\"solarCurrent\":%.3f,"
+                       "\"loadVoltage\":%.3f,\"loadCurrent\":%.3f,\"batteryVoltage\":%.3f,"
+                       "\"batteryPercentage\":%.1f,\"batteryStatus\":\"%s\"}", sep,
+                       t - age,
+                       telemetryGetU16(&p[0]) / 1000.0,
+                       asI16(telemetryGetU16(&p[2])) / 1000.0,
+                       powerLoadVoltage(p),
+                       asI16(telemetryGetU16(&p[6])) / 1000.0,
+                       powerLoadVoltage(p),
+                       telemetryGetU16(&p[8]) / 10.0,
+                       p[10] ? "charging" : "discharging");
+            }
+            printf("}}\n");
+            return;
+        }
+        default:
+            break;
+    }
+    printf("\"name\":\"UNKNOWN_%u\",\"length\":%u}\n", (unsigned)header.sensorId, (unsigned)len);
+}
+
+int main(int argc, char** argv) {
+    FILE* in = stdin;
+    if (argc > 1) {
+        in = fopen(argv[1], "rb");
+        if (!in) {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+
+    uint8_t frame[256];
+    size_t frameLen = 0;
+    bool inFrame = false;
+    unsigned long good = 0, bad = 0;
+
+    int c;
+    while ((c = fgetc(in)) != EOF) {
+        if (c == 0x00) {
+            // Delimiter: either opens a frame or closes the current one.
+            // A frame that fails to decode is treated as lost sync, so this
+            // delimiter is taken as the opener of the next frame.
+            inFrame = true;
+            if (frameLen > 0) {
+                TelemetryRecordHeader header;
+                uint8_t payload[TELEMETRY_MAX_PAYLOAD];
+                size_t payloadLen = 0;
+                if (telemetryDecodeFrame(frame, frameLen, header, payload, sizeof(payload), payloadLen)) {
+                    printRecord(header, payload, payloadLen);
+                    good++;
+                    inFrame = false;
+                } else {
+                    bad++;
+                }
+            }
+            frameLen = 0;
+            fflush(stdout);
+            continue;
+        }
+
+        if (inFrame) {
+            if (frameLen < sizeof(frame)) {
+                frame[frameLen++] = (uint8_t)c;
+            } else {
+                // Oversized: drop and wait for the next delimiter
+                inFrame = false;
+                frameLen = 0;
+                bad++;
+            }
+        } else {
+            putchar(c);
+        }
+    }
+
+    fprintf(stderr, "frames decoded: %lu, rejected: %lu\n", good, bad);
+    if (in != stdin) fclose(in);
+    return 0;
+}